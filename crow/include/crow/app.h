@@ -59,6 +59,11 @@ template <typename... Middlewares> class Crow
         router.handle(req, res);
     }
 
+    bool isStreamingRoute(const Request& req)
+    {
+        return router.isStreamingRoute(req);
+    }
+
     DynamicRule& routeDynamic(std::string&& rule)
     {
         return router.newRuleDynamic(rule);
@@ -0,0 +1,169 @@
+#pragma once
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "crow/logging.h"
+
+namespace crow
+{
+
+/**
+ * @brief Sends a single HTTP request and reports whether it was accepted
+ *
+ * Each request uses its own connection, which is closed once the response
+ * has been read.  The whole exchange is bounded by a timeout, so an
+ * unresponsive peer can't hold the client forever.
+ */
+class HttpClient : public std::enable_shared_from_this<HttpClient>
+{
+  public:
+    using Callback = std::function<void(bool success, unsigned status)>;
+
+    static constexpr std::chrono::seconds timeout{30};
+
+    HttpClient(boost::asio::io_context& ioc, const std::string& host,
+               const std::string& port) :
+        resolver(ioc),
+        socket(ioc), timer(ioc), host(host), port(port)
+    {
+    }
+
+    /**
+     * @brief POSTs a JSON body
+     *
+     * @param[in] target    Request target, the path and query of the URL
+     * @param[in] body      JSON payload
+     * @param[in] callback  Called once with whether the peer answered with a
+     * 2xx status
+     */
+    void post(const std::string& target, std::string&& body,
+              Callback&& callback)
+    {
+        req.method(boost::beast::http::verb::post);
+        req.target(target);
+        req.version(11);
+        req.set(boost::beast::http::field::host, host);
+        req.set(boost::beast::http::field::content_type, "application/json");
+        req.keep_alive(false);
+        req.body() = std::move(body);
+        req.prepare_payload();
+        handler = std::move(callback);
+
+        timer.expires_after(timeout);
+        timer.async_wait(
+            [self(shared_from_this())](const boost::system::error_code& ec) {
+                if (ec)
+                {
+                    // Cancelled because the exchange finished
+                    return;
+                }
+                BMCWEB_LOG_ERROR << "Timed out sending to " << self->host;
+                self->finish(false, 0);
+            });
+
+        resolver.async_resolve(
+            host, port,
+            [self(shared_from_this())](
+                const boost::system::error_code& ec,
+                const boost::asio::ip::tcp::resolver::results_type& results) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to resolve " << self->host
+                                     << ": " << ec.message();
+                    self->finish(false, 0);
+                    return;
+                }
+                self->connect(results);
+            });
+    }
+
+  private:
+    void connect(const boost::asio::ip::tcp::resolver::results_type& results)
+    {
+        boost::asio::async_connect(
+            socket, results,
+            [self(shared_from_this())](const boost::system::error_code& ec,
+                                       const boost::asio::ip::tcp::endpoint&) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to connect to " << self->host
+                                     << ": " << ec.message();
+                    self->finish(false, 0);
+                    return;
+                }
+                self->write();
+            });
+    }
+
+    void write()
+    {
+        boost::beast::http::async_write(
+            socket, req,
+            [self(shared_from_this())](const boost::system::error_code& ec,
+                                       std::size_t) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to send to " << self->host
+                                     << ": " << ec.message();
+                    self->finish(false, 0);
+                    return;
+                }
+                self->read();
+            });
+    }
+
+    void read()
+    {
+        boost::beast::http::async_read(
+            socket, buffer, res,
+            [self(shared_from_this())](const boost::system::error_code& ec,
+                                       std::size_t) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to read response from "
+                                     << self->host << ": " << ec.message();
+                    self->finish(false, 0);
+                    return;
+                }
+                unsigned status = self->res.result_int();
+                self->finish(status >= 200 && status < 300, status);
+            });
+    }
+
+    void finish(bool success, unsigned status)
+    {
+        if (!handler)
+        {
+            return;
+        }
+        timer.cancel();
+        resolver.cancel();
+        boost::system::error_code ec;
+        socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        socket.close(ec);
+
+        Callback callback = std::move(handler);
+        handler = nullptr;
+        callback(success, status);
+    }
+
+    boost::asio::ip::tcp::resolver resolver;
+    boost::asio::ip::tcp::socket socket;
+    boost::asio::steady_timer timer;
+    boost::beast::flat_buffer buffer;
+    boost::beast::http::request<boost::beast::http::string_body> req;
+    boost::beast::http::response<boost::beast::http::string_body> res;
+    std::string host;
+    std::string port;
+    Callback handler;
+};
+
+} // namespace crow
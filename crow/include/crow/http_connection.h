@@ -6,6 +6,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
 #if BOOST_VERSION >= 107000
@@ -357,6 +358,23 @@ class Connection
                     handler->handleUpgrade(*req, res, std::move(adaptor));
                     return;
                 }
+                if (handler->isStreamingRoute(*req))
+                {
+                    // Refusals are written as normal responses
+                    res.completeRequestHandler = [this] {
+                        this->completeRequest();
+                    };
+                    handler->handleUpgrade(*req, res, std::move(adaptor));
+                    if (!res.completed)
+                    {
+                        // The stream owns the socket now
+                        BMCWEB_LOG_DEBUG << this << " handed off to stream";
+                        res.completeRequestHandler = nullptr;
+                        cancelDeadlineTimer();
+                        checkDestroy();
+                    }
+                    return;
+                }
                 res.completeRequestHandler = [this] {
                     this->completeRequest();
                 };
@@ -430,6 +448,11 @@ class Connection
             // delete this;
             return;
         }
+        if (res.streamHandlers != nullptr)
+        {
+            startStream();
+            return;
+        }
         if (res.body().empty() && !res.jsonValue.empty())
         {
             if (http_helpers::requestPrefersHtml(*req))
@@ -440,6 +463,7 @@ class Connection
             {
                 res.jsonMode();
                 res.body() = res.jsonValue.dump(2, ' ', true);
+                setETag();
             }
         }
 
@@ -456,6 +480,46 @@ class Connection
     }
 
   private:
+    // Hands the socket to the stream the handler asked for with
+    // Response::stream()
+    void startStream()
+    {
+        std::unique_ptr<streaming::Handlers> handlers =
+            std::move(res.streamHandlers);
+        std::make_shared<streaming::ConnectionImpl<Adaptor>>(
+            *req, std::move(adaptor), handlers->options,
+            std::move(handlers->openHandler),
+            std::move(handlers->closeHandler))
+            ->start();
+        BMCWEB_LOG_DEBUG << this << " handed off to stream";
+        cancelDeadlineTimer();
+        // This runs from inside Response::end(), so the response can't be
+        // deleted yet
+        boost::asio::post(*req->ioService, [this] { checkDestroy(); });
+    }
+
+    // Tags JSON responses to GET, so pollers can revalidate them with
+    // If-None-Match instead of downloading the body again.  The tag is strong,
+    // the same as cached Redfish responses and the If-Match check on PATCH
+    // use, so a client can send back whichever one it got
+    void setETag()
+    {
+        if (req->method() != boost::beast::http::verb::get ||
+            res.result() != boost::beast::http::status::ok)
+        {
+            return;
+        }
+        std::string etag = http_helpers::makeETag(res.body());
+        res.addHeader(boost::beast::http::field::etag, etag);
+        if (http_helpers::etagMatches(
+                req->getHeaderValue(boost::beast::http::field::if_none_match),
+                etag))
+        {
+            res.result(boost::beast::http::status::not_modified);
+            res.body().clear();
+        }
+    }
+
     void doReadHeaders()
     {
         // auto self = this->shared_from_this();
@@ -6,6 +6,7 @@
 
 #include "crow/http_request.h"
 #include "crow/logging.h"
+#include "crow/streaming.h"
 
 namespace crow
 {
@@ -58,6 +59,7 @@ struct Response
         r.stringResponse.emplace(response_type{});
         jsonValue = std::move(r.jsonValue);
         completed = r.completed;
+        streamHandlers = std::move(r.streamHandlers);
         return *this;
     }
 
@@ -112,6 +114,7 @@ struct Response
         stringResponse.emplace(response_type{});
         jsonValue.clear();
         completed = false;
+        streamHandlers.reset();
     }
 
     void write(std::string_view body_part)
@@ -146,8 +149,42 @@ struct Response
         return isAliveHelper && isAliveHelper();
     }
 
+    /**
+     * @brief Installs a handler to run when the response is ended
+     *
+     * @param[in] handler  New handler.  It is responsible for calling the
+     * previous one, so the response still gets written
+     *
+     * @return The previous handler
+     */
+    std::function<void()>
+        replaceCompleteRequestHandler(std::function<void()> handler)
+    {
+        std::swap(handler, completeRequestHandler);
+        return handler;
+    }
+
+    /**
+     * @brief Sends the response as a stream once it is ended
+     *
+     * Instead of writing the body, the connection hands its socket to a
+     * stream, as for a streaming rule.  This lets a handler that only knows
+     * once it has started whether it can succeed answer with an error as
+     * usual, or switch to a stream.
+     */
+    void stream(streaming::StreamOptions options,
+                std::function<void(streaming::Connection&)> openHandler,
+                std::function<void(streaming::Connection&)> closeHandler = {})
+    {
+        streamHandlers = std::make_unique<streaming::Handlers>();
+        streamHandlers->options = std::move(options);
+        streamHandlers->openHandler = std::move(openHandler);
+        streamHandlers->closeHandler = std::move(closeHandler);
+    }
+
   private:
     bool completed{};
+    std::unique_ptr<streaming::Handlers> streamHandlers;
     std::function<void()> completeRequestHandler;
     std::function<bool()> isAliveHelper;
 
@@ -3,10 +3,12 @@
 #include "privileges.hpp"
 #include "sessions.hpp"
 
+#include <bitset>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/small_vector.hpp>
 #include <boost/lexical_cast.hpp>
 #include <cerrno>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
@@ -19,6 +21,7 @@
 #include "crow/http_request.h"
 #include "crow/http_response.h"
 #include "crow/logging.h"
+#include "crow/streaming.h"
 #include "crow/utility.h"
 #include "crow/websocket.h"
 
@@ -64,34 +67,39 @@ class BaseRule
     }
 #endif
 
+    // Streaming rules take over the socket through handleUpgrade
+    virtual bool isStreaming() const
+    {
+        return false;
+    }
+
     uint32_t getMethods()
     {
         return methodsBitfield;
     }
 
-    bool checkPrivileges(const redfish::Privileges& userPrivileges)
+    bool checkPrivileges(redfish::RoleId roleId) const
     {
-        // If there are no privileges assigned, assume no privileges
-        // required
-        if (privilegesSet.empty())
-        {
-            return true;
-        }
+        return allowedRoles.test(static_cast<size_t>(roleId));
+    }
 
-        for (const redfish::Privileges& requiredPrivileges : privilegesSet)
-        {
-            if (userPrivileges.isSupersetOf(requiredPrivileges))
-            {
-                return true;
-            }
-        }
-        return false;
+    void addPrivileges(const redfish::Privileges& privileges)
+    {
+        privilegesSet.emplace_back(privileges);
+        allowedRoles = redfish::getAllowedRoles(privilegesSet);
     }
 
     uint32_t methodsBitfield{1 << (int)boost::beast::http::verb::get};
 
     std::vector<redfish::Privileges> privilegesSet;
 
+    // Roles that satisfy privilegesSet, indexed by redfish::RoleId.  Kept in
+    // sync with privilegesSet so that the per request check is a single bit
+    // test.  If there are no privileges assigned, assume no privileges
+    // required
+    std::bitset<redfish::roleIdCount> allowedRoles{
+        redfish::getAllowedRoles({})};
+
     std::string rule;
     std::string nameStr;
 
@@ -327,9 +335,12 @@ class WebSocketRule : public BaseRule
     void handleUpgrade(const Request& req, Response&,
                        boost::asio::ip::tcp::socket&& adaptor) override
     {
-        new crow::websocket::ConnectionImpl<boost::asio::ip::tcp::socket>(
+        std::make_shared<
+            crow::websocket::ConnectionImpl<boost::asio::ip::tcp::socket>>(
             req, std::move(adaptor), openHandler, messageHandler, closeHandler,
-            errorHandler);
+            errorHandler, sendQueueOptions, overflowHandler,
+            compressionOptions)
+            ->start();
     }
 #ifdef BMCWEB_ENABLE_SSL
     void handleUpgrade(const Request& req, Response&,
@@ -341,7 +352,8 @@ class WebSocketRule : public BaseRule
             myConnection = std::make_shared<crow::websocket::ConnectionImpl<
                 boost::beast::ssl_stream<boost::asio::ip::tcp::socket>>>(
                 req, std::move(adaptor), openHandler, messageHandler,
-                closeHandler, errorHandler);
+                closeHandler, errorHandler, sendQueueOptions, overflowHandler,
+                compressionOptions);
         myConnection->start();
     }
 #endif
@@ -370,13 +382,181 @@ class WebSocketRule : public BaseRule
         return *this;
     }
 
+    /**
+     * @brief Called when a send takes the queue over its high-water mark,
+     * with OverflowPolicy::callback
+     */
+    template <typename Func> self_t& onoverflow(Func f)
+    {
+        overflowHandler = f;
+        return *this;
+    }
+
+    /**
+     * @brief Bounds the data waiting to be written to each connection
+     */
+    self_t& sendQueue(size_t highWaterMark,
+                      crow::websocket::OverflowPolicy policy =
+                          crow::websocket::OverflowPolicy::close)
+    {
+        sendQueueOptions.highWaterMark = highWaterMark;
+        sendQueueOptions.overflowPolicy = policy;
+        return *this;
+    }
+
+    /**
+     * @brief Sends consecutive binary messages as one of up to limit bytes
+     */
+    self_t& coalesce(size_t limit)
+    {
+        sendQueueOptions.coalesceLimit = limit;
+        return *this;
+    }
+
+    /**
+     * @brief Negotiates permessage-deflate with clients that offer it
+     *
+     * @param[in] windowBits  LZ77 window size, 9 to 15
+     * @param[in] memLevel  zlib memory level, 1 to 9
+     * @param[in] contextTakeover  Keep the compression state between
+     * messages, at the cost of holding it for the life of each connection
+     */
+    self_t& compression(int windowBits = 12, int memLevel = 4,
+                        bool contextTakeover = false)
+    {
+        compressionOptions.enabled = true;
+        compressionOptions.windowBits = windowBits;
+        compressionOptions.memLevel = memLevel;
+        compressionOptions.contextTakeover = contextTakeover;
+        return *this;
+    }
+
   protected:
+    crow::websocket::SendQueueOptions sendQueueOptions;
+    crow::websocket::CompressionOptions compressionOptions;
     std::function<void(crow::websocket::Connection&)> openHandler;
     std::function<void(crow::websocket::Connection&, const std::string&, bool)>
         messageHandler;
     std::function<void(crow::websocket::Connection&, const std::string&)>
         closeHandler;
     std::function<void(crow::websocket::Connection&)> errorHandler;
+    std::function<void(crow::websocket::Connection&)> overflowHandler;
+};
+
+class StreamingRule : public BaseRule
+{
+    using self_t = StreamingRule;
+
+  public:
+    StreamingRule(std::string rule) : BaseRule(std::move(rule))
+    {
+    }
+
+    void validate() override
+    {
+    }
+
+    bool isStreaming() const override
+    {
+        return true;
+    }
+
+    void handle(const Request&, Response& res, const RoutingParams&) override
+    {
+        res.result(boost::beast::http::status::not_found);
+        res.end();
+    }
+
+    void handleUpgrade(const Request& req, Response& res,
+                       boost::asio::ip::tcp::socket&& adaptor) override
+    {
+        startStream(req, res, std::move(adaptor));
+    }
+#ifdef BMCWEB_ENABLE_SSL
+    void handleUpgrade(const Request& req, Response& res,
+                       boost::beast::ssl_stream<boost::asio::ip::tcp::socket>&&
+                           adaptor) override
+    {
+        startStream(req, res, std::move(adaptor));
+    }
+#endif
+
+    template <typename Func> self_t& onopen(Func f)
+    {
+        openHandler = f;
+        return *this;
+    }
+
+    template <typename Func> self_t& onclose(Func f)
+    {
+        closeHandler = f;
+        return *this;
+    }
+
+    /**
+     * @brief Sends the body with chunked encoding instead of as Server-Sent
+     * Events
+     */
+    self_t& chunked(std::string contentType)
+    {
+        options.contentType = std::move(contentType);
+        return *this;
+    }
+
+    /**
+     * @brief Bounds the data waiting to be written to each stream
+     */
+    self_t& sendQueue(size_t maxBytes,
+                      crow::streaming::OverflowPolicy policy =
+                          crow::streaming::OverflowPolicy::dropOldest)
+    {
+        options.maxQueuedBytes = maxBytes;
+        options.overflowPolicy = policy;
+        return *this;
+    }
+
+    /**
+     * @brief Sets how often a quiet stream sends a heartbeat, 0 to disable
+     *
+     * @param[in] data  Heartbeat to send.  Event streams default to a
+     * comment, other streams send none unless it is given
+     */
+    self_t& heartbeat(std::chrono::seconds interval, std::string data = {})
+    {
+        options.heartbeatInterval = interval;
+        options.heartbeatData = std::move(data);
+        return *this;
+    }
+
+    self_t& writeTimeout(std::chrono::seconds timeout)
+    {
+        options.writeTimeout = timeout;
+        return *this;
+    }
+
+  protected:
+    template <typename Adaptor>
+    void startStream(const Request& req, Response& res, Adaptor&& adaptor)
+    {
+        redfish::RoleId roleId = redfish::RoleId::none;
+        if (req.session != nullptr)
+        {
+            roleId = req.session->roleId;
+        }
+        if (!checkPrivileges(roleId))
+        {
+            res.result(boost::beast::http::status::forbidden);
+            res.end();
+            return;
+        }
+        std::make_shared<crow::streaming::ConnectionImpl<Adaptor>>(
+            req, std::move(adaptor), options, openHandler, closeHandler)
+            ->start();
+    }
+
+    crow::streaming::StreamOptions options;
+    std::function<void(crow::streaming::Connection&)> openHandler;
+    std::function<void(crow::streaming::Connection&)> closeHandler;
 };
 
 template <typename T> struct RuleParameterTraits
@@ -389,6 +569,16 @@ template <typename T> struct RuleParameterTraits
         return *p;
     }
 
+    StreamingRule& streaming()
+    {
+        StreamingRule* p = new StreamingRule(((self_t*)this)->rule);
+        // Privileges set before the switch carry over to the stream
+        p->privilegesSet = ((self_t*)this)->privilegesSet;
+        p->allowedRoles = ((self_t*)this)->allowedRoles;
+        ((self_t*)this)->ruleToUpgrade.reset(p);
+        return *p;
+    }
+
     self_t& name(std::string name) noexcept
     {
         ((self_t*)this)->nameStr = std::move(name);
@@ -412,7 +602,7 @@ template <typename T> struct RuleParameterTraits
     template <typename... MethodArgs>
     self_t& requires(std::initializer_list<const char*> l)
     {
-        ((self_t*)this)->privilegesSet.emplace_back(l);
+        ((self_t*)this)->addPrivileges(redfish::Privileges(l));
         return (self_t&)*this;
     }
 
@@ -421,7 +611,7 @@ template <typename T> struct RuleParameterTraits
     {
         for (const redfish::Privileges& privilege : p)
         {
-            ((self_t*)this)->privilegesSet.emplace_back(privilege);
+            ((self_t*)this)->addPrivileges(privilege);
         }
         return (self_t&)*this;
     }
@@ -1071,6 +1261,26 @@ class Router
         }
     }
 
+    /**
+     * @brief Checks whether a request is for a streaming rule, which needs the
+     * socket passed to handleUpgrade
+     */
+    bool isStreamingRoute(const Request& req)
+    {
+        if (req.method() != boost::beast::http::verb::get)
+        {
+            return false;
+        }
+        PerMethod& perMethod = perMethods[(int)req.method()];
+        unsigned ruleIndex = perMethod.trie.find(req.url).first;
+        if (ruleIndex == 0 || ruleIndex == ruleSpecialRedirectSlash ||
+            ruleIndex >= perMethod.rules.size())
+        {
+            return false;
+        }
+        return perMethod.rules[ruleIndex]->isStreaming();
+    }
+
     template <typename Adaptor>
     void handleUpgrade(const Request& req, Response& res, Adaptor&& adaptor)
     {
@@ -1230,19 +1440,14 @@ class Router
                          << (uint32_t)req.method() << " / "
                          << rules[ruleIndex]->getMethods();
 
-        redfish::Privileges userPrivileges;
+        redfish::RoleId roleId = redfish::RoleId::none;
         if (req.session != nullptr)
         {
-            // Get the user role from the session.
-            const std::string& userRole = req.session->userRole;
-
-            BMCWEB_LOG_DEBUG << "USER ROLE=" << userRole;
-
-            // Get the user privileges from the role
-            userPrivileges = redfish::getUserPrivileges(userRole);
+            // The role was resolved when the session was created
+            roleId = req.session->roleId;
         }
 
-        if (!rules[ruleIndex]->checkPrivileges(userPrivileges))
+        if (!rules[ruleIndex]->checkPrivileges(roleId))
         {
             res.result(boost::beast::http::status::forbidden);
             res.end();
@@ -0,0 +1,556 @@
+#pragma once
+#include <array>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "crow/http_request.h"
+#include "crow/logging.h"
+
+#ifdef BMCWEB_ENABLE_SSL
+#include <boost/beast/ssl/ssl_stream.hpp>
+#endif
+
+namespace crow
+{
+namespace streaming
+{
+
+/**
+ * @brief What a stream does when its send queue is full
+ */
+enum class OverflowPolicy
+{
+    // Drop the oldest queued data that isn't being written.  Suits event
+    // streams, where a client that falls behind can skip ahead
+    dropOldest,
+    // Close the stream.  Suits byte streams, which can't have gaps
+    close,
+};
+
+struct StreamOptions
+{
+    // text/event-stream bodies carry Server-Sent Events and run until the
+    // connection closes.  Anything else is sent with chunked encoding, one
+    // chunk per send()
+    std::string contentType = "text/event-stream";
+    boost::beast::http::status status = boost::beast::http::status::ok;
+    // Set when the size of the body is known up front, which sends it as is
+    // instead of in chunks
+    std::optional<uint64_t> contentLength;
+    // Sent with the response headers
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t maxQueuedBytes = 256 * 1024;
+    OverflowPolicy overflowPolicy = OverflowPolicy::dropOldest;
+    // Sent when nothing else was for a whole interval, so proxies keep the
+    // stream open and a client that went away is noticed.  Event streams
+    // send a comment; other streams only if heartbeatData is set.  Zero
+    // disables heartbeats
+    std::chrono::seconds heartbeatInterval{15};
+    std::string heartbeatData;
+    // A write that takes longer than this means the client stopped reading
+    std::chrono::seconds writeTimeout{30};
+
+    bool isEventStream() const
+    {
+        return contentType == "text/event-stream";
+    }
+};
+
+struct Connection;
+
+/**
+ * @brief What a handler passes to stream its response
+ */
+struct Handlers
+{
+    StreamOptions options;
+    std::function<void(Connection&)> openHandler;
+    std::function<void(Connection&)> closeHandler;
+};
+
+/**
+ * @brief A response that is kept open to push data as it becomes available
+ *
+ * Once a request is routed to a streaming rule, the stream takes over the
+ * socket from the HTTP connection, sends the response headers and then writes
+ * whatever is sent on it until either side closes.  Data waits in a send
+ * queue bounded by StreamOptions, so a slow client can't make the server
+ * buffer without limit.
+ */
+struct Connection : std::enable_shared_from_this<Connection>
+{
+  public:
+    explicit Connection(const crow::Request& reqIn) :
+        beastReq(reqIn.req), req(beastReq), userdataPtr(nullptr)
+    {
+        // The HTTP connection reuses its request for the next one, so keep a
+        // copy that lives as long as the stream
+        req.url = req.target().substr(0, reqIn.url.size());
+        req.urlParams = reqIn.urlParams;
+        req.isSecure = reqIn.isSecure;
+        req.ioService = reqIn.ioService;
+        req.session = reqIn.session;
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /**
+     * @brief Queues data to be written to the stream
+     *
+     * On event streams the data has to be framed already, see sendEvent.  On
+     * other streams it's sent as one chunk.
+     */
+    virtual void send(std::string&& data) = 0;
+    /**
+     * @brief Ends the stream once what is queued has been written
+     */
+    virtual void close() = 0;
+    virtual boost::asio::io_context& get_io_context() = 0;
+    /**
+     * @brief Number of bytes queued and not yet written
+     */
+    virtual size_t bufferedAmount() const = 0;
+    virtual ~Connection() = default;
+
+    /**
+     * @brief Sets a handler called each time the send queue empties, so a
+     * producer can send at the pace the client reads
+     */
+    void onDrain(std::function<void(Connection&)> handler)
+    {
+        drainHandler = std::move(handler);
+    }
+
+    /**
+     * @brief Sends a Server-Sent Event
+     *
+     * @param[in] id    Event ID, which the client returns in Last-Event-ID
+     * when it reconnects.  Omitted if empty
+     * @param[in] data  Event payload.  Each line becomes a data field
+     */
+    void sendEvent(std::string_view id, std::string_view data)
+    {
+        std::string event;
+        event.reserve(id.size() + data.size() + 16);
+        if (!id.empty())
+        {
+            event += "id: ";
+            event += id;
+            event += '\n';
+        }
+        while (true)
+        {
+            size_t lineEnd = data.find('\n');
+            event += "data: ";
+            event += data.substr(0, lineEnd);
+            event += '\n';
+            if (lineEnd == std::string_view::npos)
+            {
+                break;
+            }
+            data.remove_prefix(lineEnd + 1);
+        }
+        event += '\n';
+        send(std::move(event));
+    }
+
+    /**
+     * @brief Number of sends dropped because the send queue was full
+     */
+    uint64_t droppedCount() const
+    {
+        return dropped;
+    }
+
+    void userdata(void* u)
+    {
+        userdataPtr = u;
+    }
+    void* userdata()
+    {
+        return userdataPtr;
+    }
+
+  private:
+    boost::beast::http::request<boost::beast::http::string_body> beastReq;
+
+  public:
+    crow::Request req;
+
+  protected:
+    uint64_t dropped = 0;
+    std::function<void(Connection&)> drainHandler;
+
+  private:
+    void* userdataPtr;
+};
+
+template <typename Adaptor> class ConnectionImpl : public Connection
+{
+  public:
+    ConnectionImpl(const crow::Request& req, Adaptor adaptorIn,
+                   const StreamOptions& options,
+                   std::function<void(Connection&)> openHandler,
+                   std::function<void(Connection&)> closeHandler) :
+        Connection(req),
+        adaptor(std::move(adaptorIn)), options(options),
+        heartbeatTimer(static_cast<boost::asio::io_context&>(
+            adaptor.get_executor().context())),
+        writeTimer(static_cast<boost::asio::io_context&>(
+            adaptor.get_executor().context())),
+        openHandler(std::move(openHandler)),
+        closeHandler(std::move(closeHandler))
+    {
+        BMCWEB_LOG_DEBUG << "Creating new stream " << this;
+        // Chunked encoding needs HTTP/1.1, older clients get the body as is
+        // until the connection closes
+        chunked = !options.isEventStream() && !options.contentLength &&
+                  req.req.version() == 11;
+        if (options.isEventStream() && this->options.heartbeatData.empty())
+        {
+            this->options.heartbeatData = ":\n\n";
+        }
+    }
+
+    ~ConnectionImpl() override
+    {
+        BMCWEB_LOG_DEBUG << "Destroying stream " << this;
+    }
+
+    boost::asio::io_context& get_io_context() override
+    {
+        return static_cast<boost::asio::io_context&>(
+            adaptor.get_executor().context());
+    }
+
+    size_t bufferedAmount() const override
+    {
+        return queuedBytes;
+    }
+
+    void start()
+    {
+        using bf = boost::beast::http::field;
+
+        header.emplace(options.status, req.req.version());
+        header->set(bf::content_type, options.contentType);
+        header->set(bf::cache_control, "no-cache");
+        header->set(bf::strict_transport_security, "max-age=31536000; "
+                                                   "includeSubdomains; "
+                                                   "preload");
+        header->set("X-Content-Type-Options", "nosniff");
+        // The body runs until the stream ends
+        header->keep_alive(false);
+        header->chunked(chunked);
+        if (options.contentLength)
+        {
+            header->content_length(*options.contentLength);
+        }
+        for (const std::pair<std::string, std::string>& field :
+             options.headers)
+        {
+            header->set(field.first, field.second);
+        }
+        serializer.emplace(*header);
+
+        startWriteTimer();
+        boost::beast::http::async_write_header(
+            adaptor, *serializer,
+            [this, self(shared_from_this())](boost::beast::error_code ec,
+                                             std::size_t) {
+                writeTimer.cancel();
+                serializer.reset();
+                header.reset();
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Error writing stream headers " << ec;
+                    doClose();
+                    return;
+                }
+                if (openHandler)
+                {
+                    openHandler(*this);
+                }
+                doRead();
+                startHeartbeat();
+                doWrite();
+            });
+    }
+
+    void send(std::string&& data) override
+    {
+        if (closed || closing || data.empty())
+        {
+            return;
+        }
+        enqueue(frame(std::move(data)));
+    }
+
+    void close() override
+    {
+        if (closed || closing)
+        {
+            return;
+        }
+        closing = true;
+        heartbeatTimer.cancel();
+        if (chunked)
+        {
+            outBuffer.emplace_back("0\r\n\r\n");
+            queuedBytes += outBuffer.back().size();
+        }
+        if (!header && !doingWrite && outBuffer.empty())
+        {
+            doClose();
+            return;
+        }
+        doWrite();
+    }
+
+  private:
+    std::string frame(std::string&& data)
+    {
+        if (!chunked)
+        {
+            return std::move(data);
+        }
+        std::array<char, 20> size;
+        int sizeLength = std::snprintf(size.data(), size.size(), "%zx\r\n",
+                                       data.size());
+        std::string chunk;
+        chunk.reserve(static_cast<size_t>(sizeLength) + data.size() + 2);
+        chunk.append(size.data(), static_cast<size_t>(sizeLength));
+        chunk += data;
+        chunk += "\r\n";
+        return chunk;
+    }
+
+    void enqueue(std::string&& data)
+    {
+        if (queuedBytes + data.size() > options.maxQueuedBytes)
+        {
+            if (options.overflowPolicy == OverflowPolicy::close)
+            {
+                BMCWEB_LOG_ERROR << "Stream " << this
+                                 << " send queue is full, closing";
+                dropped++;
+                doClose();
+                return;
+            }
+            // The front of the queue may be in the middle of being written
+            size_t first = doingWrite ? 1 : 0;
+            while (outBuffer.size() > first &&
+                   queuedBytes + data.size() > options.maxQueuedBytes)
+            {
+                queuedBytes -= outBuffer[first].size();
+                outBuffer.erase(outBuffer.begin() +
+                                static_cast<std::ptrdiff_t>(first));
+                dropped++;
+            }
+            if (queuedBytes + data.size() > options.maxQueuedBytes)
+            {
+                dropped++;
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Stream " << this << " dropped " << dropped
+                             << " sends so far";
+        }
+        queuedBytes += data.size();
+        outBuffer.emplace_back(std::move(data));
+        sentSinceHeartbeat = true;
+        if (!header)
+        {
+            doWrite();
+        }
+    }
+
+    // Clients don't send anything on a stream, so a read only completes when
+    // they go away
+    void doRead()
+    {
+        adaptor.async_read_some(
+            boost::asio::buffer(inBuffer),
+            [this, self(shared_from_this())](boost::beast::error_code ec,
+                                             std::size_t) {
+                if (ec)
+                {
+                    BMCWEB_LOG_DEBUG << "Stream closed by client " << ec;
+                    doClose();
+                    return;
+                }
+                doRead();
+            });
+    }
+
+    void doWrite()
+    {
+        // If we're already doing a write, ignore the request, it will be picked
+        // up when the current write is complete
+        if (doingWrite || closed || header)
+        {
+            return;
+        }
+        if (outBuffer.empty())
+        {
+            if (closing)
+            {
+                doClose();
+            }
+            return;
+        }
+        doingWrite = true;
+        startWriteTimer();
+        boost::asio::async_write(
+            adaptor, boost::asio::buffer(outBuffer.front()),
+            [this, self(shared_from_this())](boost::beast::error_code ec,
+                                             std::size_t) {
+                writeTimer.cancel();
+                doingWrite = false;
+                queuedBytes -= outBuffer.front().size();
+                outBuffer.pop_front();
+                if (closed)
+                {
+                    outBuffer.clear();
+                    queuedBytes = 0;
+                    return;
+                }
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Error writing to stream " << ec;
+                    doClose();
+                    return;
+                }
+                if (outBuffer.empty() && !closing && drainHandler)
+                {
+                    // The handler may close the stream, which clears it
+                    std::function<void(Connection&)> handler = drainHandler;
+                    handler(*this);
+                }
+                doWrite();
+            });
+    }
+
+    // Closes the stream if a write doesn't finish in time
+    void startWriteTimer()
+    {
+        uint64_t seq = ++writeSeq;
+        writeTimer.expires_after(options.writeTimeout);
+        writeTimer.async_wait([this, self(shared_from_this()),
+                               seq](const boost::system::error_code& ec) {
+            // A cancel can't stop a handler that was already queued, so a
+            // timeout that raced the write completing shows up as a newer
+            // write having been started
+            if (ec || seq != writeSeq || !(doingWrite || header))
+            {
+                // Cancelled because the write finished
+                return;
+            }
+            BMCWEB_LOG_ERROR << "Stream " << this
+                             << " timed out writing, closing";
+            doClose();
+        });
+    }
+
+    void startHeartbeat()
+    {
+        if (options.heartbeatInterval.count() == 0 ||
+            options.heartbeatData.empty() || closed || closing)
+        {
+            return;
+        }
+        heartbeatTimer.expires_after(options.heartbeatInterval);
+        heartbeatTimer.async_wait([this, self(shared_from_this())](
+                                      const boost::system::error_code& ec) {
+            if (ec || closed || closing)
+            {
+                return;
+            }
+            // Only needed if the stream was quiet, and useless if data is
+            // already waiting
+            if (!sentSinceHeartbeat && outBuffer.empty())
+            {
+                enqueue(frame(std::string(options.heartbeatData)));
+            }
+            sentSinceHeartbeat = false;
+            startHeartbeat();
+        });
+    }
+
+    void doClose()
+    {
+        if (closed)
+        {
+            return;
+        }
+        closed = true;
+        heartbeatTimer.cancel();
+        writeTimer.cancel();
+        // A pending write still references the front of the queue
+        if (!doingWrite)
+        {
+            outBuffer.clear();
+            queuedBytes = 0;
+        }
+        boost::beast::error_code ec;
+        if constexpr (std::is_same_v<Adaptor, boost::asio::ip::tcp::socket>)
+        {
+            adaptor.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            adaptor.close(ec);
+        }
+        else
+        {
+            adaptor.next_layer().shutdown(
+                boost::asio::ip::tcp::socket::shutdown_both, ec);
+            adaptor.next_layer().close(ec);
+        }
+        drainHandler = nullptr;
+        if (closeHandler)
+        {
+            closeHandler(*this);
+        }
+    }
+
+    Adaptor adaptor;
+    StreamOptions options;
+    bool chunked = false;
+
+    std::optional<
+        boost::beast::http::response<boost::beast::http::empty_body>>
+        header;
+    std::optional<boost::beast::http::response_serializer<
+        boost::beast::http::empty_body>>
+        serializer;
+
+    boost::asio::steady_timer heartbeatTimer;
+    boost::asio::steady_timer writeTimer;
+
+    std::array<char, 128> inBuffer;
+    std::deque<std::string> outBuffer;
+    size_t queuedBytes = 0;
+    bool doingWrite = false;
+    // Incremented for each write, so stale write timeouts can be told apart
+    uint64_t writeSeq = 0;
+    bool sentSinceHeartbeat = false;
+    // close() was called, and the stream ends once the queue is written
+    bool closing = false;
+    bool closed = false;
+
+    std::function<void(Connection&)> openHandler;
+    std::function<void(Connection&)> closeHandler;
+};
+} // namespace streaming
+} // namespace crow
@@ -2,8 +2,14 @@
 #include <array>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/websocket.hpp>
+#include <deque>
 #include <functional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "crow/http_request.h"
 
@@ -15,6 +21,151 @@ namespace crow
 {
 namespace websocket
 {
+
+/**
+ * @brief What a connection does when a send takes its queue over the
+ * high-water mark
+ */
+enum class OverflowPolicy
+{
+    // Discard the message being sent
+    drop,
+    // Close the connection.  Suits byte streams, which can't have gaps
+    close,
+    // Queue the message anyway and call the overflow handler, which is
+    // expected to slow its producer down
+    callback,
+};
+
+struct SendQueueOptions
+{
+    size_t highWaterMark = 16 * 1024 * 1024;
+    OverflowPolicy overflowPolicy = OverflowPolicy::close;
+    // Consecutive binary messages are sent as one message of up to this many
+    // bytes, for protocols that treat binary messages as a byte stream.  Zero
+    // sends every message on its own
+    size_t coalesceLimit = 0;
+};
+
+/**
+ * @brief permessage-deflate (RFC 7692) settings, offered to clients that ask
+ * for the extension
+ */
+struct CompressionOptions
+{
+    bool enabled = false;
+    // LZ77 window, 9 to 15.  Each direction keeps a 1 << windowBits window
+    // per connection, so small windows save memory on connections with short
+    // messages
+    int windowBits = 12;
+    // zlib memLevel, 1 to 9.  Higher levels use more memory and compress
+    // faster
+    int memLevel = 4;
+    // Keep the window between messages.  This compresses runs of similar
+    // messages better, but holds the zlib state for the life of the
+    // connection
+    bool contextTakeover = false;
+};
+
+/**
+ * @brief Bytes a connection has moved, counted both as the handlers see them
+ * and as frames on the socket.  Frames are counted after compression and
+ * before TLS, and include the upgrade response.
+ */
+struct TrafficStats
+{
+    uint64_t messageBytesSent = 0;
+    uint64_t messageBytesReceived = 0;
+    uint64_t wireBytesSent = 0;
+    uint64_t wireBytesReceived = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const TrafficStats& stats)
+{
+    return os << "sent " << stats.messageBytesSent << " bytes ("
+              << stats.wireBytesSent << " on the wire), received "
+              << stats.messageBytesReceived << " bytes ("
+              << stats.wireBytesReceived << " on the wire)";
+}
+
+/**
+ * @brief Passes reads and writes through to NextLayer, counting the bytes
+ */
+template <typename NextLayer> class CountingStream
+{
+  public:
+    using executor_type = typename NextLayer::executor_type;
+    using next_layer_type = NextLayer;
+
+    explicit CountingStream(NextLayer&& nextIn) : next(std::move(nextIn))
+    {
+    }
+
+    executor_type get_executor() noexcept
+    {
+        return next.get_executor();
+    }
+
+    NextLayer& next_layer()
+    {
+        return next;
+    }
+
+    const NextLayer& next_layer() const
+    {
+        return next;
+    }
+
+    template <typename MutableBufferSequence, typename ReadHandler>
+    auto async_read_some(const MutableBufferSequence& buffers,
+                         ReadHandler&& handler)
+    {
+        return next.async_read_some(
+            buffers, [this, handler{std::forward<ReadHandler>(handler)}](
+                         boost::system::error_code ec, size_t n) mutable {
+                bytesRead += n;
+                handler(ec, n);
+            });
+    }
+
+    template <typename ConstBufferSequence, typename WriteHandler>
+    auto async_write_some(const ConstBufferSequence& buffers,
+                          WriteHandler&& handler)
+    {
+        return next.async_write_some(
+            buffers, [this, handler{std::forward<WriteHandler>(handler)}](
+                         boost::system::error_code ec, size_t n) mutable {
+                bytesWritten += n;
+                handler(ec, n);
+            });
+    }
+
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+
+  private:
+    NextLayer next;
+};
+
+// Closing the websocket tears down the layer under the counter
+template <typename NextLayer>
+void teardown(boost::beast::role_type role, CountingStream<NextLayer>& stream,
+              boost::system::error_code& ec)
+{
+    using boost::beast::websocket::teardown;
+    teardown(role, stream.next_layer(), ec);
+}
+
+template <typename NextLayer, typename TeardownHandler>
+void async_teardown(boost::beast::role_type role,
+                    CountingStream<NextLayer>& stream,
+                    TeardownHandler&& handler)
+{
+    using boost::beast::websocket::async_teardown;
+    async_teardown(role, stream.next_layer(),
+                   std::forward<TeardownHandler>(handler));
+}
+
 struct Connection : std::enable_shared_from_this<Connection>
 {
   public:
@@ -27,8 +178,30 @@ struct Connection : std::enable_shared_from_this<Connection>
     virtual void sendText(std::string&& msg) = 0;
     virtual void close(const std::string_view msg = "quit") = 0;
     virtual boost::asio::io_context& get_io_context() = 0;
+    /**
+     * @brief Number of bytes queued and not yet written, which producers can
+     * check to send at the pace the client reads
+     */
+    virtual size_t bufferedAmount() const = 0;
+    virtual TrafficStats trafficStats() const = 0;
     virtual ~Connection() = default;
 
+    /**
+     * @brief Sets a handler called each time the send queue empties
+     */
+    void onDrain(std::function<void(Connection&)> handler)
+    {
+        drainHandler = std::move(handler);
+    }
+
+    /**
+     * @brief Number of messages dropped because the send queue was full
+     */
+    uint64_t droppedCount() const
+    {
+        return dropped;
+    }
+
     void userdata(void* u)
     {
         userdataPtr = u;
@@ -40,6 +213,10 @@ struct Connection : std::enable_shared_from_this<Connection>
 
     crow::Request req;
 
+  protected:
+    uint64_t dropped = 0;
+    std::function<void(Connection&)> drainHandler;
+
   private:
     void* userdataPtr;
 };
@@ -53,15 +230,33 @@ template <typename Adaptor> class ConnectionImpl : public Connection
         std::function<void(Connection&, const std::string&, bool)>
             message_handler,
         std::function<void(Connection&, const std::string&)> close_handler,
-        std::function<void(Connection&)> error_handler) :
+        std::function<void(Connection&)> error_handler,
+        const SendQueueOptions& sendQueueOptions = SendQueueOptions(),
+        std::function<void(Connection&)> overflow_handler = nullptr,
+        const CompressionOptions& compressionOptions = CompressionOptions()) :
         Connection(req),
         ws(std::move(adaptorIn)), inString(), inBuffer(inString, 131088),
+        sendQueueOptions(sendQueueOptions),
         openHandler(std::move(open_handler)),
         messageHandler(std::move(message_handler)),
         closeHandler(std::move(close_handler)),
-        errorHandler(std::move(error_handler))
+        errorHandler(std::move(error_handler)),
+        overflowHandler(std::move(overflow_handler))
     {
         BMCWEB_LOG_DEBUG << "Creating new connection " << this;
+        if (compressionOptions.enabled)
+        {
+            boost::beast::websocket::permessage_deflate deflate;
+            deflate.server_enable = true;
+            deflate.server_max_window_bits = compressionOptions.windowBits;
+            deflate.client_max_window_bits = compressionOptions.windowBits;
+            deflate.memLevel = compressionOptions.memLevel;
+            deflate.server_no_context_takeover =
+                !compressionOptions.contextTakeover;
+            deflate.client_no_context_takeover =
+                !compressionOptions.contextTakeover;
+            ws.set_option(deflate);
+        }
     }
 
     boost::asio::io_context& get_io_context() override
@@ -69,6 +264,19 @@ template <typename Adaptor> class ConnectionImpl : public Connection
         return (boost::asio::io_context&)ws.get_executor().context();
     }
 
+    size_t bufferedAmount() const override
+    {
+        return queuedBytes;
+    }
+
+    TrafficStats trafficStats() const override
+    {
+        TrafficStats stats = traffic;
+        stats.wireBytesSent = ws.next_layer().bytesWritten;
+        stats.wireBytesReceived = ws.next_layer().bytesRead;
+        return stats;
+    }
+
     void start()
     {
         BMCWEB_LOG_DEBUG << "starting connection " << this;
@@ -110,30 +318,22 @@ template <typename Adaptor> class ConnectionImpl : public Connection
 
     void sendBinary(const std::string_view msg) override
     {
-        ws.binary(true);
-        outBuffer.emplace_back(msg);
-        doWrite();
+        enqueue(std::string(msg), true);
     }
 
     void sendBinary(std::string&& msg) override
     {
-        ws.binary(true);
-        outBuffer.emplace_back(std::move(msg));
-        doWrite();
+        enqueue(std::move(msg), true);
     }
 
     void sendText(const std::string_view msg) override
     {
-        ws.text(true);
-        outBuffer.emplace_back(msg);
-        doWrite();
+        enqueue(std::string(msg), false);
     }
 
     void sendText(std::string&& msg) override
     {
-        ws.text(true);
-        outBuffer.emplace_back(std::move(msg));
-        doWrite();
+        enqueue(std::move(msg), false);
     }
 
     void close(const std::string_view msg) override
@@ -182,6 +382,7 @@ template <typename Adaptor> class ConnectionImpl : public Connection
                               }
                               return;
                           }
+                          traffic.messageBytesReceived += bytes_read;
                           if (messageHandler)
                           {
                               messageHandler(*this, inString, ws.got_text());
@@ -201,18 +402,48 @@ template <typename Adaptor> class ConnectionImpl : public Connection
             return;
         }
 
-        if (outBuffer.empty())
+        if (outBuffer.empty() || overflowed)
         {
             // Done for now
             return;
         }
         doingWrite = true;
+
+        // Gather as many binary messages as fit in one write, without copying
+        // them together
+        const OutMessage& first = outBuffer.front();
+        writeBuffers.clear();
+        writeBuffers.emplace_back(boost::asio::buffer(first.data));
+        writingCount = 1;
+        size_t writeSize = first.data.size();
+        if (first.binary)
+        {
+            while (writingCount < outBuffer.size())
+            {
+                const OutMessage& next = outBuffer[writingCount];
+                if (!next.binary || writeSize + next.data.size() >
+                                        sendQueueOptions.coalesceLimit)
+                {
+                    break;
+                }
+                writeBuffers.emplace_back(boost::asio::buffer(next.data));
+                writeSize += next.data.size();
+                writingCount++;
+            }
+        }
+        ws.binary(first.binary);
+
         ws.async_write(
-            boost::asio::buffer(outBuffer.front()),
+            writeBuffers,
             [this, self(shared_from_this())](boost::beast::error_code ec,
                                              std::size_t bytes_written) {
                 doingWrite = false;
-                outBuffer.erase(outBuffer.begin());
+                traffic.messageBytesSent += bytes_written;
+                for (; writingCount > 0; writingCount--)
+                {
+                    queuedBytes -= outBuffer.front().data.size();
+                    outBuffer.pop_front();
+                }
                 if (ec == boost::beast::websocket::error::closed)
                 {
                     // Do nothing here.  doRead handler will call the
@@ -225,25 +456,102 @@ template <typename Adaptor> class ConnectionImpl : public Connection
                     BMCWEB_LOG_ERROR << "Error in ws.async_write " << ec;
                     return;
                 }
+                if (outBuffer.empty() && drainHandler)
+                {
+                    // The handler may replace itself
+                    std::function<void(Connection&)> handler = drainHandler;
+                    handler(*this);
+                }
                 doWrite();
             });
     }
 
   private:
-    boost::beast::websocket::stream<Adaptor> ws;
+    struct OutMessage
+    {
+        std::string data;
+        bool binary;
+    };
+
+    void enqueue(std::string&& data, bool binary)
+    {
+        if (overflowed)
+        {
+            return;
+        }
+        bool wasBelow = queuedBytes <= sendQueueOptions.highWaterMark;
+        if (queuedBytes + data.size() > sendQueueOptions.highWaterMark)
+        {
+            if (sendQueueOptions.overflowPolicy == OverflowPolicy::drop)
+            {
+                dropped++;
+                BMCWEB_LOG_DEBUG << "Websocket " << this << " dropped "
+                                 << dropped << " messages so far";
+                return;
+            }
+            if (sendQueueOptions.overflowPolicy == OverflowPolicy::close)
+            {
+                BMCWEB_LOG_ERROR << "Websocket " << this
+                                 << " send queue is full, closing";
+                dropped++;
+                abort();
+                return;
+            }
+        }
+        queuedBytes += data.size();
+        outBuffer.push_back(OutMessage{std::move(data), binary});
+        if (wasBelow && queuedBytes > sendQueueOptions.highWaterMark &&
+            overflowHandler)
+        {
+            overflowHandler(*this);
+        }
+        doWrite();
+    }
+
+    // A client that stopped reading wouldn't take a close frame either, so
+    // drop the connection.  The pending read fails and calls the
+    // closeHandler
+    void abort()
+    {
+        overflowed = true;
+        boost::beast::error_code ec;
+        if constexpr (std::is_same_v<Adaptor, boost::asio::ip::tcp::socket>)
+        {
+            ws.next_layer().next_layer().shutdown(
+                boost::asio::ip::tcp::socket::shutdown_both, ec);
+            ws.next_layer().next_layer().close(ec);
+        }
+        else
+        {
+            ws.next_layer().next_layer().next_layer().shutdown(
+                boost::asio::ip::tcp::socket::shutdown_both, ec);
+            ws.next_layer().next_layer().next_layer().close(ec);
+        }
+    }
+
+    boost::beast::websocket::stream<CountingStream<Adaptor>> ws;
+    TrafficStats traffic;
 
     std::string inString;
     boost::asio::dynamic_string_buffer<std::string::value_type,
                                        std::string::traits_type,
                                        std::string::allocator_type>
         inBuffer;
-    std::vector<std::string> outBuffer;
+    SendQueueOptions sendQueueOptions;
+    std::deque<OutMessage> outBuffer;
+    size_t queuedBytes = 0;
+    // Messages at the front of outBuffer being written, and their buffers
+    size_t writingCount = 0;
+    std::vector<boost::asio::const_buffer> writeBuffers;
     bool doingWrite = false;
+    // The send queue overflowed and the connection was dropped
+    bool overflowed = false;
 
     std::function<void(Connection&)> openHandler;
     std::function<void(Connection&, const std::string&, bool)> messageHandler;
     std::function<void(Connection&, const std::string&)> closeHandler;
     std::function<void(Connection&)> errorHandler;
+    std::function<void(Connection&)> overflowHandler;
 };
 } // namespace websocket
 } // namespace crow
@@ -0,0 +1,238 @@
+/*
+ // Copyright (c) 2019 Intel Corporation
+ //
+ // Licensed under the Apache License, Version 2.0 (the "License");
+ // you may not use this file except in compliance with the License.
+ // You may obtain a copy of the License at
+ //
+ //      http://www.apache.org/licenses/LICENSE-2.0
+ //
+ // Unless required by applicable law or agreed to in writing, software
+ // distributed under the License is distributed on an "AS IS" BASIS,
+ // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ // See the License for the specific language governing permissions and
+ // limitations under the License.
+ */
+#pragma once
+
+#include <boost/system/error_code.hpp>
+#include <chrono>
+#include <crow/logging.h>
+#include <dbus_introspection_xml.hpp>
+#include <dbus_singleton.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message/types.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dbus
+{
+
+namespace introspection
+{
+
+/**
+ * @brief Called with the introspection data of an object
+ *
+ * On a D-Bus error the error code is set.  If the XML could not be parsed the
+ * node is nullptr.
+ */
+using Callback = std::function<void(const boost::system::error_code &,
+                                    const std::shared_ptr<const Node> &)>;
+
+/**
+ * @brief Cache of parsed introspection data by service and object path
+ *
+ * An object's interfaces only change when its service restarts or objects are
+ * added or removed, so entries are dropped on NameOwnerChanged for the
+ * service, and on InterfacesAdded and InterfacesRemoved for the object and
+ * its parents, whose child nodes change.  Services that add objects or
+ * interfaces without sending those signals would otherwise be served stale
+ * data until they restart, so entries also expire after entryTtl.
+ * Concurrent lookups of the same object share a single Introspect call.
+ */
+class Cache
+{
+  public:
+    static Cache &getInstance()
+    {
+        static Cache cache;
+        return cache;
+    }
+
+    Cache(const Cache &) = delete;
+    Cache &operator=(const Cache &) = delete;
+
+    /**
+     * @brief Gets the introspection data of an object, calling the service
+     * only if it isn't cached.  A cached result is returned right away.
+     */
+    void get(const std::string &service, const std::string &path,
+             Callback &&callback)
+    {
+        Key key(path, service);
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            if (std::chrono::steady_clock::now() < it->second.expires)
+            {
+                callback(boost::system::error_code(), it->second.node);
+                return;
+            }
+            entries.erase(it);
+        }
+
+        auto pendingIt = pending.find(key);
+        if (pendingIt != pending.end())
+        {
+            pendingIt->second.emplace_back(std::move(callback));
+            return;
+        }
+        pending[key].emplace_back(std::move(callback));
+
+        crow::connections::systemBus->async_method_call(
+            [this, key, thisGeneration{generation}](
+                const boost::system::error_code ec, const std::string &xml) {
+                std::shared_ptr<const Node> node;
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Introspect call failed with error: "
+                                     << ec.message()
+                                     << " on process: " << key.second
+                                     << " path: " << key.first;
+                }
+                else
+                {
+                    node = parse(xml);
+                    if (node == nullptr)
+                    {
+                        BMCWEB_LOG_ERROR << "XML document failed to parse "
+                                         << key.second << " " << key.first;
+                    }
+                    // Don't keep a reply that may predate an invalidation
+                    else if (thisGeneration == generation)
+                    {
+                        if (entries.size() >= maxEntries)
+                        {
+                            entries.clear();
+                        }
+                        entries.emplace(
+                            key,
+                            Entry{node,
+                                  std::chrono::steady_clock::now() + entryTtl});
+                    }
+                }
+
+                auto waitersIt = pending.find(key);
+                if (waitersIt == pending.end())
+                {
+                    return;
+                }
+                std::vector<Callback> waiters = std::move(waitersIt->second);
+                pending.erase(waitersIt);
+                for (Callback &waiter : waiters)
+                {
+                    waiter(ec, node);
+                }
+            },
+            service, path, "org.freedesktop.DBus.Introspectable",
+            "Introspect");
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+  private:
+    // Sorted by path first, so an object's entries are next to each other
+    using Key = std::pair<std::string, std::string>;
+
+    Cache() :
+        nameOwnerMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::type::signal() +
+                sdbusplus::bus::match::rules::sender("org.freedesktop.DBus") +
+                sdbusplus::bus::match::rules::member("NameOwnerChanged"),
+            [this](sdbusplus::message::message &m) {
+                std::string name;
+                m.read(name);
+                removeService(name);
+            }),
+        addedMatch(*crow::connections::systemBus,
+                   sdbusplus::bus::match::rules::interfacesAdded(),
+                   [this](sdbusplus::message::message &m) {
+                       sdbusplus::message::object_path path;
+                       m.read(path);
+                       removeObject(path.str);
+                   }),
+        removedMatch(*crow::connections::systemBus,
+                     sdbusplus::bus::match::rules::interfacesRemoved(),
+                     [this](sdbusplus::message::message &m) {
+                         sdbusplus::message::object_path path;
+                         m.read(path);
+                         removeObject(path.str);
+                     })
+    {
+    }
+
+    void removeService(const std::string &service)
+    {
+        generation++;
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->first.second == service)
+            {
+                it = entries.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    void removeObject(std::string path)
+    {
+        generation++;
+        while (true)
+        {
+            entries.erase(entries.lower_bound(Key(path, "")),
+                          entries.lower_bound(Key(path + '\0', "")));
+            if (path.size() <= 1)
+            {
+                break;
+            }
+            size_t slash = path.rfind('/');
+            if (slash == std::string::npos)
+            {
+                break;
+            }
+            path.resize(slash == 0 ? 1 : slash);
+        }
+    }
+
+    struct Entry
+    {
+        std::shared_ptr<const Node> node;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static constexpr size_t maxEntries = 1024;
+    static constexpr std::chrono::minutes entryTtl{5};
+
+    std::map<Key, Entry> entries;
+    std::map<Key, std::vector<Callback>> pending;
+    // Counts invalidations
+    uint64_t generation = 0;
+    sdbusplus::bus::match::match nameOwnerMatch;
+    sdbusplus::bus::match::match addedMatch;
+    sdbusplus::bus::match::match removedMatch;
+};
+
+} // namespace introspection
+} // namespace dbus
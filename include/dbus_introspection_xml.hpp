@@ -0,0 +1,221 @@
+/*
+ // Copyright (c) 2019 Intel Corporation
+ //
+ // Licensed under the Apache License, Version 2.0 (the "License");
+ // you may not use this file except in compliance with the License.
+ // You may obtain a copy of the License at
+ //
+ //      http://www.apache.org/licenses/LICENSE-2.0
+ //
+ // Unless required by applicable law or agreed to in writing, software
+ // distributed under the License is distributed on an "AS IS" BASIS,
+ // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ // See the License for the specific language governing permissions and
+ // limitations under the License.
+ */
+#pragma once
+
+#include <tinyxml2.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dbus
+{
+
+namespace introspection
+{
+
+struct Arg
+{
+    // Each is empty if the attribute is missing
+    std::string name;
+    std::string direction;
+    std::string type;
+};
+
+struct Method
+{
+    std::string name;
+    std::vector<Arg> args;
+    // Types of the "in" arguments, in order
+    std::vector<std::string> inTypes;
+    // Type of the first "out" argument, empty if there is none
+    std::string returnType;
+};
+
+struct Signal
+{
+    std::string name;
+    // Only the arguments with both a name and a type
+    std::vector<Arg> args;
+};
+
+struct Property
+{
+    std::string name;
+    std::string type;
+};
+
+struct Interface
+{
+    std::string name;
+    std::vector<Method> methods;
+    std::vector<Signal> signals;
+    std::vector<Property> properties;
+};
+
+/**
+ * @brief Parsed introspection data of one object
+ */
+struct Node
+{
+    const Interface *findInterface(const std::string &name) const
+    {
+        for (const Interface &interface : interfaces)
+        {
+            if (interface.name == name)
+            {
+                return &interface;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Interface> interfaces;
+    // Names of the child nodes, relative to this one
+    std::vector<std::string> children;
+};
+
+inline std::string getAttribute(const tinyxml2::XMLElement *element,
+                                const char *name)
+{
+    const char *value = element->Attribute(name);
+    return value == nullptr ? std::string() : std::string(value);
+}
+
+/**
+ * @brief Parses the XML returned by Introspect
+ *
+ * Elements without a name are left out, as are properties without a type.
+ *
+ * @return The parsed node, or nullptr if the XML has no root node
+ */
+inline std::shared_ptr<Node> parse(const std::string &xml)
+{
+    tinyxml2::XMLDocument doc;
+    doc.Parse(xml.data(), xml.size());
+    const tinyxml2::XMLElement *root = doc.FirstChildElement("node");
+    if (root == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto node = std::make_shared<Node>();
+    for (const tinyxml2::XMLElement *child = root->FirstChildElement("node");
+         child != nullptr; child = child->NextSiblingElement("node"))
+    {
+        std::string name = getAttribute(child, "name");
+        if (!name.empty())
+        {
+            node->children.emplace_back(std::move(name));
+        }
+    }
+
+    for (const tinyxml2::XMLElement *ifaceElement =
+             root->FirstChildElement("interface");
+         ifaceElement != nullptr;
+         ifaceElement = ifaceElement->NextSiblingElement("interface"))
+    {
+        Interface interface;
+        interface.name = getAttribute(ifaceElement, "name");
+        if (interface.name.empty())
+        {
+            continue;
+        }
+
+        for (const tinyxml2::XMLElement *element =
+                 ifaceElement->FirstChildElement("method");
+             element != nullptr;
+             element = element->NextSiblingElement("method"))
+        {
+            Method method;
+            method.name = getAttribute(element, "name");
+            if (method.name.empty())
+            {
+                continue;
+            }
+            for (const tinyxml2::XMLElement *argElement =
+                     element->FirstChildElement("arg");
+                 argElement != nullptr;
+                 argElement = argElement->NextSiblingElement("arg"))
+            {
+                Arg arg{getAttribute(argElement, "name"),
+                        getAttribute(argElement, "direction"),
+                        getAttribute(argElement, "type")};
+                if (!arg.type.empty())
+                {
+                    if (arg.direction == "in")
+                    {
+                        method.inTypes.emplace_back(arg.type);
+                    }
+                    else if (arg.direction == "out" &&
+                             method.returnType.empty())
+                    {
+                        method.returnType = arg.type;
+                    }
+                }
+                method.args.emplace_back(std::move(arg));
+            }
+            interface.methods.emplace_back(std::move(method));
+        }
+
+        for (const tinyxml2::XMLElement *element =
+                 ifaceElement->FirstChildElement("signal");
+             element != nullptr;
+             element = element->NextSiblingElement("signal"))
+        {
+            Signal signal;
+            signal.name = getAttribute(element, "name");
+            if (signal.name.empty())
+            {
+                continue;
+            }
+            for (const tinyxml2::XMLElement *argElement =
+                     element->FirstChildElement("arg");
+                 argElement != nullptr;
+                 argElement = argElement->NextSiblingElement("arg"))
+            {
+                Arg arg;
+                arg.name = getAttribute(argElement, "name");
+                arg.type = getAttribute(argElement, "type");
+                if (!arg.name.empty() && !arg.type.empty())
+                {
+                    signal.args.emplace_back(std::move(arg));
+                }
+            }
+            interface.signals.emplace_back(std::move(signal));
+        }
+
+        for (const tinyxml2::XMLElement *element =
+                 ifaceElement->FirstChildElement("property");
+             element != nullptr;
+             element = element->NextSiblingElement("property"))
+        {
+            Property property{getAttribute(element, "name"),
+                              getAttribute(element, "type")};
+            if (!property.name.empty() && !property.type.empty())
+            {
+                interface.properties.emplace_back(std::move(property));
+            }
+        }
+
+        node->interfaces.emplace_back(std::move(interface));
+    }
+    return node;
+}
+
+} // namespace introspection
+} // namespace dbus
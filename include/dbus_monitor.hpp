@@ -4,10 +4,15 @@
 
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
+#include <dbus_monitor_batch.hpp>
+#include <dbus_names.hpp>
 #include <dbus_singleton.hpp>
+#include <map>
+#include <memory>
 #include <openbmc_dbus_rest.hpp>
 #include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <unordered_map>
 #include <variant>
 
 namespace nlohmann
@@ -26,35 +31,16 @@ namespace crow
 namespace dbus_monitor
 {
 
-struct DbusWebsocketSession
+/**
+ * @brief Decodes a PropertiesChanged or InterfacesAdded signal
+ *
+ * @return false if the signal couldn't be decoded
+ */
+inline bool decodeSignal(sdbusplus::message::message& message,
+                         DecodedSignal& decoded)
 {
-    std::vector<std::unique_ptr<sdbusplus::bus::match::match>> matches;
-    boost::container::flat_set<std::string> interfaces;
-};
-
-static boost::container::flat_map<crow::websocket::Connection*,
-                                  DbusWebsocketSession>
-    sessions;
-
-inline int onPropertyUpdate(sd_bus_message* m, void* userdata,
-                            sd_bus_error* ret_error)
-{
-    if (ret_error == nullptr || sd_bus_error_is_set(ret_error))
-    {
-        BMCWEB_LOG_ERROR << "Got sdbus error on match";
-        return 0;
-    }
-    crow::websocket::Connection* connection =
-        static_cast<crow::websocket::Connection*>(userdata);
-    auto thisSession = sessions.find(connection);
-    if (thisSession == sessions.end())
-    {
-        BMCWEB_LOG_ERROR << "Couldn't find dbus connection " << connection;
-        return 0;
-    }
-    sdbusplus::message::message message(m);
-    nlohmann::json j{{"event", message.get_member()},
-                     {"path", message.get_path()}};
+    decoded.message = {{"event", message.get_member()},
+                       {"path", message.get_path()}};
     if (strcmp(message.get_member(), "PropertiesChanged") == 0)
     {
         nlohmann::json data;
@@ -62,65 +48,282 @@ inline int onPropertyUpdate(sd_bus_message* m, void* userdata,
         if (r < 0)
         {
             BMCWEB_LOG_ERROR << "convertDBusToJSON failed with " << r;
-            return 0;
+            return false;
         }
         if (!data.is_array())
         {
             BMCWEB_LOG_ERROR << "No data in PropertiesChanged signal";
-            return 0;
+            return false;
         }
 
         // data is type sa{sv}as and is an array[3] of string, object, array
-        j["interface"] = data[0];
-        j["properties"] = data[1];
+        decoded.message["interface"] = std::move(data[0]);
+        decoded.message["properties"] = std::move(data[1]);
+        return true;
     }
-    else if (strcmp(message.get_member(), "InterfacesAdded") == 0)
+    if (strcmp(message.get_member(), "InterfacesAdded") == 0)
     {
         nlohmann::json data;
         int r = openbmc_mapper::convertDBusToJSON("oa{sa{sv}}", message, data);
         if (r < 0)
         {
             BMCWEB_LOG_ERROR << "convertDBusToJSON failed with " << r;
-            return 0;
+            return false;
         }
 
         if (!data.is_array())
         {
             BMCWEB_LOG_ERROR << "No data in InterfacesAdded signal";
-            return 0;
+            return false;
         }
 
         // data is type oa{sa{sv}} which is an array[2] of string, object
-        for (auto& entry : data[1].items())
+        decoded.interfaces = std::move(data[1]);
+        decoded.interfacesAdded = true;
+        return true;
+    }
+    BMCWEB_LOG_CRITICAL << "message " << message.get_member()
+                        << " was unexpected";
+    return false;
+}
+
+// Unbatched updates are dropped once this much is queued for a session
+constexpr size_t maxQueuedBytes = 1024 * 1024;
+
+struct DbusWebsocketSession
+{
+    // Rules this session is subscribed to in the MatchRegistry
+    boost::container::flat_set<std::string> rules;
+    boost::container::flat_set<std::string> interfaces;
+    // Set if the session asked for its updates to be batched
+    std::shared_ptr<UpdateBatch> batch;
+};
+
+static boost::container::flat_map<crow::websocket::Connection*,
+                                  DbusWebsocketSession>
+    sessions;
+
+/**
+ * @brief Returns the message to send a session, serializing it only once for
+ * every session that gets the same content
+ */
+inline const std::string& getSerialized(DecodedSignal& decoded,
+                                        const DbusWebsocketSession& session)
+{
+    if (!decoded.interfacesAdded)
+    {
+        auto it = decoded.serialized.find(std::string());
+        if (it == decoded.serialized.end())
+        {
+            it = decoded.serialized.emplace(std::string(),
+                                            decoded.message.dump())
+                     .first;
+        }
+        return it->second;
+    }
+
+    // Sessions only get the interfaces they asked for, so the key is the
+    // names of those
+    std::string key;
+    for (const auto& entry : decoded.interfaces.items())
+    {
+        if (session.interfaces.find(entry.key()) != session.interfaces.end())
+        {
+            key += entry.key();
+            key += ' ';
+        }
+    }
+    auto it = decoded.serialized.find(key);
+    if (it != decoded.serialized.end())
+    {
+        return it->second;
+    }
+    return decoded.serialized
+        .emplace(std::move(key), getMessage(decoded, session.interfaces).dump())
+        .first->second;
+}
+
+/**
+ * @brief The D-Bus matches of every /subscribe session
+ *
+ * Sessions watching the same paths and interfaces share a match, which is
+ * removed with its last subscriber.  Each signal is decoded once, even if it
+ * matches more than one rule, and each distinct message is serialized once
+ * for all the sessions it's sent to.
+ */
+class MatchRegistry
+{
+  public:
+    static MatchRegistry& getInstance()
+    {
+        static MatchRegistry registry;
+        return registry;
+    }
+
+    MatchRegistry(const MatchRegistry&) = delete;
+    MatchRegistry& operator=(const MatchRegistry&) = delete;
+
+    /**
+     * @brief Sends the signals matching a rule to a connection, adding the
+     * match if nothing is subscribed to it yet
+     */
+    void subscribe(const std::string& rule, crow::websocket::Connection* conn)
+    {
+        auto it = entries.find(rule);
+        if (it == entries.end())
+        {
+            BMCWEB_LOG_DEBUG << "Creating match " << rule;
+            it = entries.emplace(rule, Entry()).first;
+            it->second.match = std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::systemBus, rule, onSignal, &it->second);
+        }
+        it->second.connections.insert(conn);
+    }
+
+    void unsubscribe(const std::string& rule,
+                     crow::websocket::Connection* conn)
+    {
+        auto it = entries.find(rule);
+        if (it == entries.end())
+        {
+            return;
+        }
+        it->second.connections.erase(conn);
+        if (it->second.connections.empty())
+        {
+            BMCWEB_LOG_DEBUG << "Removing match " << rule;
+            entries.erase(it);
+        }
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+  private:
+    MatchRegistry() = default;
+
+    struct Entry
+    {
+        std::unique_ptr<sdbusplus::bus::match::match> match;
+        boost::container::flat_set<crow::websocket::Connection*> connections;
+    };
+
+    static int onSignal(sd_bus_message* m, void* userdata,
+                        sd_bus_error* ret_error)
+    {
+        if (ret_error == nullptr || sd_bus_error_is_set(ret_error))
+        {
+            BMCWEB_LOG_ERROR << "Got sdbus error on match";
+            return 0;
+        }
+        Entry* entry = static_cast<Entry*>(userdata);
+        sdbusplus::message::message message(m);
+        DecodedSignal* decoded = getInstance().decode(message);
+        if (decoded == nullptr)
+        {
+            return 0;
+        }
+        for (crow::websocket::Connection* connection : entry->connections)
         {
-            auto it = thisSession->second.interfaces.find(entry.key());
-            if (it != thisSession->second.interfaces.end())
+            auto session = sessions.find(connection);
+            if (session == sessions.end())
+            {
+                BMCWEB_LOG_ERROR << "Couldn't find dbus connection "
+                                 << connection;
+                continue;
+            }
+            DbusWebsocketSession& thisSession = session->second;
+            if (thisSession.batch != nullptr)
+            {
+                thisSession.batch->add(*decoded, thisSession.interfaces);
+            }
+            else
             {
-                j["interfaces"][entry.key()] = entry.value();
+                connection->sendText(getSerialized(*decoded, thisSession));
             }
         }
+        return 0;
     }
-    else
+
+    /**
+     * @brief Decodes a signal, or returns the last one if it's the same
+     *
+     * sd-bus runs every matching callback for a signal before the next, so
+     * only the last signal needs to be kept.
+     */
+    DecodedSignal* decode(sdbusplus::message::message& message)
     {
-        BMCWEB_LOG_CRITICAL << "message " << message.get_member()
-                            << " was unexpected";
-        return 0;
+        uint64_t cookie = 0;
+        const char* sender = message.get_sender();
+        bool identified =
+            sender != nullptr &&
+            sd_bus_message_get_cookie(message.get(), &cookie) >= 0;
+        if (identified && lastValid && last.cookie == cookie &&
+            last.sender == sender)
+        {
+            return &last;
+        }
+
+        last = DecodedSignal();
+        lastValid = false;
+        if (!decodeSignal(message, last))
+        {
+            return nullptr;
+        }
+        if (identified)
+        {
+            last.sender = sender;
+            last.cookie = cookie;
+            lastValid = true;
+        }
+        return &last;
     }
 
-    connection->sendText(j.dump());
-    return 0;
+    // Mapped values keep their address, which each match is given
+    std::unordered_map<std::string, Entry> entries;
+    DecodedSignal last;
+    bool lastValid = false;
 };
 
+inline void unsubscribeAll(crow::websocket::Connection* conn)
+{
+    auto session = sessions.find(conn);
+    if (session == sessions.end())
+    {
+        return;
+    }
+    for (const std::string& rule : session->second.rules)
+    {
+        MatchRegistry::getInstance().unsubscribe(rule, conn);
+    }
+    sessions.erase(session);
+}
+
 template <typename... Middlewares> void requestRoutes(Crow<Middlewares...>& app)
 {
     BMCWEB_ROUTE(app, "/subscribe")
         .websocket()
+        .compression()
+        .sendQueue(maxQueuedBytes, crow::websocket::OverflowPolicy::drop)
         .onopen([&](crow::websocket::Connection& conn) {
             BMCWEB_LOG_DEBUG << "Connection " << &conn << " opened";
             sessions[&conn] = DbusWebsocketSession();
         })
         .onclose([&](crow::websocket::Connection& conn,
-                     const std::string& reason) { sessions.erase(&conn); })
+                     const std::string& reason) {
+            uint64_t dropped = conn.droppedCount();
+            auto session = sessions.find(&conn);
+            if (session != sessions.end() && session->second.batch != nullptr)
+            {
+                dropped += session->second.batch->droppedCount();
+            }
+            BMCWEB_LOG_INFO << "Connection " << &conn << " closed, "
+                            << conn.trafficStats() << ", dropped " << dropped
+                            << " updates";
+            unsubscribeAll(&conn);
+        })
         .onmessage([&](crow::websocket::Connection& conn,
                        const std::string& data, bool is_binary) {
             DbusWebsocketSession& thisSession = sessions[&conn];
@@ -140,37 +343,35 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...>& app)
                 {
                     const std::string* str =
                         interface.get_ptr<const std::string*>();
-                    if (str != nullptr)
+                    if (str == nullptr)
+                    {
+                        continue;
+                    }
+                    if (!dbus::names::isValidInterface(*str))
                     {
-                        thisSession.interfaces.insert(*str);
+                        BMCWEB_LOG_ERROR << "Invalid interface name " << *str;
+                        conn.close();
+                        return;
                     }
+                    thisSession.interfaces.insert(*str);
                 }
             }
 
-            nlohmann::json::iterator paths = j.find("paths");
-            if (paths != j.end())
+            nlohmann::json::iterator batchMs = j.find("batch_ms");
+            if (batchMs != j.end() &&
+                !setBatchInterval(conn, thisSession.batch, *batchMs))
             {
-                int interfaceCount = thisSession.interfaces.size();
-                if (interfaceCount == 0)
-                {
-                    interfaceCount = 1;
-                }
-                // Reserve our matches upfront.  For each path there is 1 for
-                // interfacesAdded, and InterfaceCount number for
-                // PropertiesChanged
-                thisSession.matches.reserve(thisSession.matches.size() +
-                                            paths->size() *
-                                                (1 + interfaceCount));
+                BMCWEB_LOG_ERROR << "Invalid batch_ms " << *batchMs;
+                conn.close();
+                return;
             }
-            std::string object_manager_match_string;
-            std::string properties_match_string;
-            std::string object_manager_interfaces_match_string;
-            // These regexes derived on the rules here:
-            // https://dbus.freedesktop.org/doc/dbus-specification.html#message-protocol-names
-            std::regex validPath("^/([A-Za-z0-9_]+/?)*$");
-            std::regex validInterface(
-                "^[A-Za-z_][A-Za-z0-9_]*(\\.[A-Za-z_][A-Za-z0-9_]*)+$");
 
+            nlohmann::json::iterator paths = j.find("paths");
+            if (paths == j.end())
+            {
+                return;
+            }
+            // Check everything before subscribing to anything
             for (const auto& thisPath : *paths)
             {
                 const std::string* thisPathString =
@@ -181,30 +382,32 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...>& app)
                     conn.close();
                     return;
                 }
-                if (!std::regex_match(*thisPathString, validPath))
+                if (!dbus::names::isValidPath(*thisPathString))
                 {
                     BMCWEB_LOG_ERROR << "Invalid path name " << *thisPathString;
                     conn.close();
                     return;
                 }
-                properties_match_string =
+            }
+
+            MatchRegistry& registry = MatchRegistry::getInstance();
+            for (const auto& thisPath : *paths)
+            {
+                const std::string& thisPathString =
+                    thisPath.get_ref<const std::string&>();
+                std::vector<std::string> rules;
+                std::string properties_match_string =
                     ("type='signal',"
                      "interface='org.freedesktop.DBus.Properties',"
                      "path_namespace='" +
-                     *thisPathString +
+                     thisPathString +
                      "',"
                      "member='PropertiesChanged'");
                 // If interfaces weren't specified, add a single match for all
                 // interfaces
                 if (thisSession.interfaces.size() == 0)
                 {
-                    BMCWEB_LOG_DEBUG << "Creating match "
-                                     << properties_match_string;
-
-                    thisSession.matches.emplace_back(
-                        std::make_unique<sdbusplus::bus::match::match>(
-                            *crow::connections::systemBus,
-                            properties_match_string, onPropertyUpdate, &conn));
+                    rules.emplace_back(std::move(properties_match_string));
                 }
                 else
                 {
@@ -212,37 +415,22 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...>& app)
                     // interface
                     for (const std::string& interface : thisSession.interfaces)
                     {
-                        if (!std::regex_match(interface, validInterface))
-                        {
-                            BMCWEB_LOG_ERROR << "Invalid interface name "
-                                             << interface;
-                            conn.close();
-                            return;
-                        }
-                        std::string ifaceMatchString = properties_match_string +
-                                                       ",arg0='" + interface +
-                                                       "'";
-                        BMCWEB_LOG_DEBUG << "Creating match "
-                                         << ifaceMatchString;
-                        thisSession.matches.emplace_back(
-                            std::make_unique<sdbusplus::bus::match::match>(
-                                *crow::connections::systemBus, ifaceMatchString,
-                                onPropertyUpdate, &conn));
+                        rules.emplace_back(properties_match_string + ",arg0='" +
+                                           interface + "'");
                     }
                 }
-                object_manager_match_string =
-                    ("type='signal',"
-                     "interface='org.freedesktop.DBus.ObjectManager',"
-                     "path_namespace='" +
-                     *thisPathString +
-                     "',"
-                     "member='InterfacesAdded'");
-                BMCWEB_LOG_DEBUG << "Creating match "
-                                 << object_manager_match_string;
-                thisSession.matches.emplace_back(
-                    std::make_unique<sdbusplus::bus::match::match>(
-                        *crow::connections::systemBus,
-                        object_manager_match_string, onPropertyUpdate, &conn));
+                rules.emplace_back("type='signal',"
+                                   "interface='org.freedesktop.DBus."
+                                   "ObjectManager',"
+                                   "path_namespace='" +
+                                   thisPathString +
+                                   "',"
+                                   "member='InterfacesAdded'");
+                for (std::string& rule : rules)
+                {
+                    registry.subscribe(rule, &conn);
+                    thisSession.rules.insert(std::move(rule));
+                }
             }
         });
 }
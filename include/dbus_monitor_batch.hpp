@@ -0,0 +1,288 @@
+#pragma once
+#include <crow/logging.h>
+#include <crow/websocket.h>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace dbus_monitor
+{
+
+/**
+ * @brief A signal decoded into the message sent to subscribers
+ */
+struct DecodedSignal
+{
+    // Identifies the signal, as it's seen once per matching rule
+    std::string sender;
+    uint64_t cookie = 0;
+
+    // The message, without the interfaces for InterfacesAdded
+    nlohmann::json message;
+    // Interfaces of an InterfacesAdded signal, by name
+    nlohmann::json interfaces;
+    bool interfacesAdded = false;
+    // Serialized messages, by the interfaces they contain for InterfacesAdded
+    boost::container::flat_map<std::string, std::string> serialized;
+};
+
+/**
+ * @brief Builds the message for a session that watches some interfaces
+ */
+inline nlohmann::json
+    getMessage(const DecodedSignal& decoded,
+               const boost::container::flat_set<std::string>& interfaces)
+{
+    nlohmann::json j = decoded.message;
+    for (const auto& entry : decoded.interfaces.items())
+    {
+        if (interfaces.find(entry.key()) != interfaces.end())
+        {
+            j["interfaces"][entry.key()] = entry.value();
+        }
+    }
+    return j;
+}
+
+// Limits on what a session can ask for with "batch_ms"
+constexpr uint64_t maxBatchMs = 10000;
+// A batch is sent early once it holds this many messages
+constexpr size_t maxBatchEvents = 1024;
+// Batches aren't sent while the connection has more than this queued
+constexpr size_t maxBatchBacklog = 64 * 1024;
+
+/**
+ * @brief Updates waiting to be sent to a session as one JSON array
+ *
+ * The first update starts a window, and everything that arrives before it
+ * ends goes out together.  Property changes of an object and interface
+ * already in the batch are merged into it, so a sensor changing many times
+ * in a window is only sent once with its latest value.
+ *
+ * A batch isn't sent while the client is behind on reading the ones before
+ * it.  It keeps merging updates until the connection's queue drains, and
+ * once it holds maxBatchEvents messages, updates that can't be merged are
+ * dropped and counted.  So a slow client has at most one held batch and
+ * maxBatchBacklog bytes queued.
+ *
+ * Sessions opt in by sending "batch_ms" along with their subscription.
+ * Without it each update is sent as its own object.
+ */
+class UpdateBatch : public std::enable_shared_from_this<UpdateBatch>
+{
+  public:
+    UpdateBatch(crow::websocket::Connection& conn,
+                std::chrono::milliseconds interval) :
+        conn(conn),
+        interval(interval), timer(conn.get_io_context())
+    {
+    }
+
+    UpdateBatch(const UpdateBatch&) = delete;
+    UpdateBatch& operator=(const UpdateBatch&) = delete;
+
+    /**
+     * @brief Adds a signal to the batch
+     *
+     * @param[i] decoded     The signal
+     * @param[i] interfaces  Interfaces the session watches
+     */
+    void add(const DecodedSignal& decoded,
+             const boost::container::flat_set<std::string>& interfaces)
+    {
+        if (decoded.interfacesAdded)
+        {
+            if (events.size() >= maxBatchEvents)
+            {
+                dropped++;
+                return;
+            }
+            events.emplace_back(getMessage(decoded, interfaces));
+        }
+        else
+        {
+            const nlohmann::json& message = decoded.message;
+            const std::string* path =
+                message["path"].get_ptr<const std::string*>();
+            const std::string* interface =
+                message["interface"].get_ptr<const std::string*>();
+            auto key = std::make_pair(path == nullptr ? "" : *path,
+                                      interface == nullptr ? "" : *interface);
+            auto it = propertiesIndex.find(key);
+            if (it != propertiesIndex.end())
+            {
+                nlohmann::json& properties = events[it->second]["properties"];
+                for (const auto& property : message["properties"].items())
+                {
+                    properties[property.key()] = property.value();
+                }
+            }
+            else if (events.size() >= maxBatchEvents)
+            {
+                dropped++;
+                return;
+            }
+            else
+            {
+                propertiesIndex.emplace(std::move(key), events.size());
+                events.emplace_back(message);
+            }
+        }
+
+        if (events.size() >= maxBatchEvents)
+        {
+            flush();
+        }
+        else if (!waiting)
+        {
+            wait();
+        }
+    }
+
+    /**
+     * @brief Sends whatever is in the batch, unless the client is behind
+     *
+     * @param[i] force  Send even if the connection has a backlog
+     */
+    void flush(bool force = false)
+    {
+        if (events.empty())
+        {
+            return;
+        }
+        if (!force && conn.bufferedAmount() > maxBatchBacklog)
+        {
+            // Sent by onDrain, with whatever has been merged in by then
+            held = true;
+            return;
+        }
+        held = false;
+        nlohmann::json batch = nlohmann::json::array();
+        for (nlohmann::json& event : events)
+        {
+            batch.emplace_back(std::move(event));
+        }
+        events.clear();
+        propertiesIndex.clear();
+        conn.sendText(batch.dump());
+    }
+
+    /**
+     * @brief Sends a batch that was held back, once the connection's queue
+     * has emptied
+     */
+    void onDrain()
+    {
+        if (held)
+        {
+            flush();
+        }
+    }
+
+    void setInterval(std::chrono::milliseconds newInterval)
+    {
+        interval = newInterval;
+    }
+
+    /**
+     * @brief Number of updates dropped because a held batch was full
+     */
+    uint64_t droppedCount() const
+    {
+        return dropped;
+    }
+
+  private:
+    void wait()
+    {
+        waiting = true;
+        timer.expires_after(interval);
+        timer.async_wait([weak{weak_from_this()}](
+                             const boost::system::error_code& ec) {
+            if (ec)
+            {
+                return;
+            }
+            std::shared_ptr<UpdateBatch> self = weak.lock();
+            if (self == nullptr)
+            {
+                return;
+            }
+            self->waiting = false;
+            self->flush();
+        });
+    }
+
+    crow::websocket::Connection& conn;
+    std::chrono::milliseconds interval;
+    boost::asio::steady_timer timer;
+    bool waiting = false;
+    // Set while a flush waits for the connection to drain
+    bool held = false;
+    uint64_t dropped = 0;
+
+    // Messages in the order they first arrived
+    std::vector<nlohmann::json> events;
+    // Where the properties of each object and interface are in events
+    std::map<std::pair<std::string, std::string>, size_t> propertiesIndex;
+};
+
+/**
+ * @brief Applies the "batch_ms" a session sent
+ *
+ * Zero sends what's batched and turns batching off.
+ *
+ * @param[i] conn     The session's connection
+ * @param[o] batch    The session's batch, nullptr if it isn't batching
+ * @param[i] batchMs  Value of "batch_ms"
+ *
+ * @return false if the value isn't a number of milliseconds up to maxBatchMs
+ */
+inline bool setBatchInterval(crow::websocket::Connection& conn,
+                             std::shared_ptr<UpdateBatch>& batch,
+                             const nlohmann::json& batchMs)
+{
+    const uint64_t* ms = batchMs.get_ptr<const uint64_t*>();
+    if (ms == nullptr || *ms > maxBatchMs)
+    {
+        return false;
+    }
+    if (*ms == 0)
+    {
+        if (batch != nullptr)
+        {
+            batch->flush(true);
+            batch = nullptr;
+            conn.onDrain(nullptr);
+        }
+        return true;
+    }
+    if (batch != nullptr)
+    {
+        batch->setInterval(std::chrono::milliseconds(*ms));
+        return true;
+    }
+    batch = std::make_shared<UpdateBatch>(conn, std::chrono::milliseconds(*ms));
+    conn.onDrain([weak{std::weak_ptr<UpdateBatch>(batch)}](
+                     crow::websocket::Connection&) {
+        std::shared_ptr<UpdateBatch> self = weak.lock();
+        if (self != nullptr)
+        {
+            self->onDrain();
+        }
+    });
+    return true;
+}
+
+} // namespace dbus_monitor
+} // namespace crow
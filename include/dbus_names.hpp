@@ -0,0 +1,101 @@
+/*
+ // Copyright (c) 2019 Intel Corporation
+ //
+ // Licensed under the Apache License, Version 2.0 (the "License");
+ // you may not use this file except in compliance with the License.
+ // You may obtain a copy of the License at
+ //
+ //      http://www.apache.org/licenses/LICENSE-2.0
+ //
+ // Unless required by applicable law or agreed to in writing, software
+ // distributed under the License is distributed on an "AS IS" BASIS,
+ // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ // See the License for the specific language governing permissions and
+ // limitations under the License.
+ */
+#pragma once
+
+#include <string_view>
+
+namespace dbus
+{
+
+namespace names
+{
+
+// Checks follow the rules here:
+// https://dbus.freedesktop.org/doc/dbus-specification.html#message-protocol-names
+
+constexpr size_t maxNameLength = 255;
+
+/**
+ * @brief Checks for [A-Za-z0-9_], without depending on the locale
+ */
+constexpr bool isElementChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * @brief Checks an object path: "/", or elements of [A-Za-z0-9_] each
+ * preceded by "/".  A trailing "/" is accepted, as the /subscribe websocket
+ * always has.
+ */
+constexpr bool isValidPath(std::string_view path)
+{
+    if (path.empty() || path.front() != '/')
+    {
+        return false;
+    }
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        if (path[i] == '/')
+        {
+            if (path[i - 1] == '/')
+            {
+                return false;
+            }
+        }
+        else if (!isElementChar(path[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks an interface name: at least two elements of [A-Za-z0-9_]
+ * separated by ".", none starting with a digit
+ */
+constexpr bool isValidInterface(std::string_view interface)
+{
+    if (interface.empty() || interface.size() > maxNameLength)
+    {
+        return false;
+    }
+    size_t elements = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= interface.size(); i++)
+    {
+        if (i == interface.size() || interface[i] == '.')
+        {
+            if (i == start)
+            {
+                return false;
+            }
+            elements++;
+            start = i + 1;
+        }
+        else if (!isElementChar(interface[i]) ||
+                 (i == start && interface[i] >= '0' && interface[i] <= '9'))
+        {
+            return false;
+        }
+    }
+    return elements >= 2;
+}
+
+} // namespace names
+} // namespace dbus
@@ -0,0 +1,192 @@
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <dbus_rest_messages.hpp>
+#include <nlohmann/json.hpp>
+#include <privileges.hpp>
+#include <string>
+#include <vector>
+
+namespace crow
+{
+namespace openbmc_mapper
+{
+
+// Most operations a batch request can contain
+constexpr size_t batchMaxOperations = 256;
+// Most operations of a batch request in progress at once
+constexpr size_t batchMaxConcurrent = 8;
+
+/**
+ * @brief One operation of a batch request, as it was requested
+ */
+struct BatchItem
+{
+    // A set if true, a get otherwise
+    bool isSet = false;
+    std::string objectPath;
+    // Empty to get every property
+    std::string propertyName;
+    nlohmann::json propertyValue;
+};
+
+/**
+ * @brief Reads one operation of a batch request
+ *
+ * @return false if the operation isn't valid
+ */
+inline bool parseBatchItem(nlohmann::json &operation, BatchItem &item)
+{
+    if (!operation.is_object())
+    {
+        return false;
+    }
+    nlohmann::json::iterator method = operation.find("method");
+    nlohmann::json::iterator path = operation.find("path");
+    nlohmann::json::iterator property = operation.find("property");
+    nlohmann::json::iterator value = operation.find("data");
+    if (method == operation.end() || path == operation.end() ||
+        !path->is_string())
+    {
+        return false;
+    }
+    if (property != operation.end())
+    {
+        if (!property->is_string())
+        {
+            return false;
+        }
+        item.propertyName = property->get<std::string>();
+    }
+    if (*method == "PUT")
+    {
+        if (item.propertyName.empty() || value == operation.end())
+        {
+            return false;
+        }
+        item.isSet = true;
+        item.propertyValue = std::move(*value);
+    }
+    else if (*method != "GET")
+    {
+        return false;
+    }
+    item.objectPath = path->get<std::string>();
+    return true;
+}
+
+/**
+ * @brief Reads the operations of a batch request body
+ *
+ * @param[i] body   Request body
+ * @param[o] items  The operations, in order
+ *
+ * @return Description of what's wrong with the request, empty if it's valid
+ */
+inline std::string parseBatchRequest(const std::string &body,
+                                     std::vector<BatchItem> &items)
+{
+    nlohmann::json requestDbusData =
+        nlohmann::json::parse(body, nullptr, false);
+    if (requestDbusData.is_discarded())
+    {
+        return noJsonDesc;
+    }
+    nlohmann::json::iterator data = requestDbusData.find("data");
+    if (data == requestDbusData.end() || !data->is_array() ||
+        data->size() > batchMaxOperations)
+    {
+        return "Expected a list of at most " +
+               std::to_string(batchMaxOperations) + " operations in data";
+    }
+
+    items.clear();
+    items.resize(data->size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (!parseBatchItem((*data)[i], items[i]))
+        {
+            items.clear();
+            return "Invalid operation " + std::to_string(i);
+        }
+    }
+    return std::string();
+}
+
+/**
+ * @brief Checks a role may run every operation of a batch
+ *
+ * Gets need the same privileges as GET on /xyz/<path>, which the route
+ * already requires, and sets the same as PUT.
+ */
+inline bool isBatchAllowed(const std::vector<BatchItem> &items,
+                           redfish::RoleId roleId)
+{
+    static const redfish::Privileges setPrivileges{"ConfigureComponents",
+                                                   "ConfigureManager"};
+    for (const BatchItem &item : items)
+    {
+        if (item.isSet)
+        {
+            return redfish::getUserPrivileges(roleId).isSupersetOf(
+                setPrivileges);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The answer to an operation that failed
+ */
+inline nlohmann::json makeBatchError(const std::string &desc,
+                                     const std::string &msg)
+{
+    return {{"data", {{"description", desc}}},
+            {"message", msg},
+            {"status", "error"}};
+}
+
+/**
+ * @brief The answer to an operation once nothing is working on it anymore
+ *
+ * @param[i] item    The operation
+ * @param[i] result  Its error, or its answer if it was a set that succeeded.
+ * Null otherwise
+ * @param[i] found   Whether the property a get named was read
+ * @param[i] data    Properties a get read
+ */
+inline nlohmann::json makeBatchResult(const BatchItem &item,
+                                      nlohmann::json &&result, bool found,
+                                      nlohmann::json &&data)
+{
+    if (!result.is_null())
+    {
+        return std::move(result);
+    }
+    // No interface of the object had the property
+    if (item.isSet)
+    {
+        return makeBatchError(forbiddenMsg, forbiddenPropDesc);
+    }
+    if (!item.propertyName.empty() && !found)
+    {
+        return makeBatchError(propNotFoundDesc, notFoundMsg);
+    }
+    return {{"status", "ok"}, {"message", "200 OK"}, {"data", std::move(data)}};
+}
+
+} // namespace openbmc_mapper
+} // namespace crow
@@ -0,0 +1,193 @@
+/*
+ // Copyright (c) 2019 Intel Corporation
+ //
+ // Licensed under the Apache License, Version 2.0 (the "License");
+ // you may not use this file except in compliance with the License.
+ // You may obtain a copy of the License at
+ //
+ //      http://www.apache.org/licenses/LICENSE-2.0
+ //
+ // Unless required by applicable law or agreed to in writing, software
+ // distributed under the License is distributed on an "AS IS" BASIS,
+ // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ // See the License for the specific language governing permissions and
+ // limitations under the License.
+ */
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dbus
+{
+
+namespace signature
+{
+
+// Container codes as passed to sd_bus_message_open_container
+constexpr char arrayCode = 'a';
+constexpr char variantCode = 'v';
+constexpr char structCode = 'r';
+constexpr char dictEntryCode = 'e';
+
+/**
+ * @brief One complete type of a D-Bus signature
+ */
+struct Type
+{
+    bool isDict() const
+    {
+        return code == arrayCode && children.front().code == dictEntryCode;
+    }
+
+    // Basic type code, or one of the container codes above
+    char code = '\0';
+    // Signature of the contents of a container, empty otherwise
+    std::string contents;
+    // The element of an array, the members of a struct or the key and value
+    // of a dictionary entry
+    std::vector<Type> children;
+};
+
+// The complete types a signature is made of, in order
+using Plan = std::vector<Type>;
+
+constexpr const char *basicCodes = "ybnqiuxtdsogh";
+
+// D-Bus allows 32 levels of arrays plus 32 of structs
+constexpr size_t maxDepth = 64;
+
+inline bool isBasicCode(char code)
+{
+    return code != '\0' && std::strchr(basicCodes, code) != nullptr;
+}
+
+/**
+ * @brief Parses the complete type starting at pos, leaving pos after it
+ *
+ * @return false if the signature isn't valid there
+ */
+inline bool parseType(std::string_view signature, size_t &pos, Type &type,
+                      size_t depth = 0)
+{
+    if (pos >= signature.size() || depth > maxDepth)
+    {
+        return false;
+    }
+    char code = signature[pos++];
+    if (isBasicCode(code) || code == variantCode)
+    {
+        type.code = code;
+        return true;
+    }
+
+    size_t start = pos;
+    if (code == arrayCode)
+    {
+        type.code = arrayCode;
+        Type &element = type.children.emplace_back();
+        if (pos < signature.size() && signature[pos] == '{')
+        {
+            // A dictionary entry is a basic key and any value, and is only
+            // allowed in an array
+            pos++;
+            element.code = dictEntryCode;
+            if (pos >= signature.size() || !isBasicCode(signature[pos]))
+            {
+                return false;
+            }
+            for (int i = 0; i < 2; i++)
+            {
+                if (!parseType(signature, pos, element.children.emplace_back(),
+                               depth + 1))
+                {
+                    return false;
+                }
+            }
+            if (pos >= signature.size() || signature[pos] != '}')
+            {
+                return false;
+            }
+            element.contents = signature.substr(start + 1, pos - start - 1);
+            pos++;
+        }
+        else if (!parseType(signature, pos, element, depth + 1))
+        {
+            return false;
+        }
+        type.contents = signature.substr(start, pos - start);
+        return true;
+    }
+    if (code == '(')
+    {
+        type.code = structCode;
+        while (pos < signature.size() && signature[pos] != ')')
+        {
+            if (!parseType(signature, pos, type.children.emplace_back(),
+                           depth + 1))
+            {
+                return false;
+            }
+        }
+        if (pos >= signature.size() || type.children.empty())
+        {
+            return false;
+        }
+        type.contents = signature.substr(start, pos - start);
+        pos++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Turns a signature into the tree of types that drives marshalling
+ *
+ * @return The plan, or nullptr if the signature isn't valid
+ */
+inline std::shared_ptr<const Plan> compile(std::string_view signature)
+{
+    auto plan = std::make_shared<Plan>();
+    size_t pos = 0;
+    while (pos < signature.size())
+    {
+        if (!parseType(signature, pos, plan->emplace_back()))
+        {
+            return nullptr;
+        }
+    }
+    return plan;
+}
+
+/**
+ * @brief Returns the compiled plan for a signature, compiling it only the
+ * first time it's seen
+ *
+ * Signatures come from introspection data and message headers, so there are
+ * few distinct ones.  Once the cache is full new signatures are compiled on
+ * every call instead.
+ */
+inline std::shared_ptr<const Plan> getPlan(const std::string &signature)
+{
+    constexpr size_t maxPlans = 512;
+    static std::unordered_map<std::string, std::shared_ptr<const Plan>> plans;
+
+    auto it = plans.find(signature);
+    if (it != plans.end())
+    {
+        return it->second;
+    }
+    std::shared_ptr<const Plan> plan = compile(signature);
+    if (plan != nullptr && plans.size() < maxPlans)
+    {
+        plans.emplace(signature, plan);
+    }
+    return plan;
+}
+
+} // namespace signature
+} // namespace dbus
@@ -1,5 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <boost/algorithm/string.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
 
 #include "crow/http_request.h"
 
@@ -51,4 +61,204 @@ inline std::string urlEncode(const std::string_view value)
 
     return escaped.str();
 }
+
+/**
+ * @brief Builds an entity tag from a response body
+ *
+ * The tag only has to change when the body does, so a fast non-cryptographic
+ * hash is enough
+ *
+ * @param[in] body  Serialized response body
+ *
+ * @return Quoted entity tag, suitable for the ETag header
+ */
+inline std::string makeETag(std::string_view body)
+{
+    std::array<char, 19> etag;
+    std::snprintf(etag.data(), etag.size(), "\"%016zx\"",
+                  std::hash<std::string_view>{}(body));
+    return std::string(etag.data(), etag.size() - 1);
+}
+
+enum class ETagComparison
+{
+    // For If-None-Match, where W/ prefixes are ignored
+    weak,
+    // For If-Match, where weak tags never match
+    strong,
+};
+
+/**
+ * @brief Checks an If-None-Match or If-Match header against an entity tag
+ *
+ * Compares as in RFC 7232 section 2.3.2
+ *
+ * @param[in] header      Header value, a list of entity tags or "*"
+ * @param[in] etag        Entity tag of the current representation
+ * @param[in] comparison  Weak for If-None-Match, strong for If-Match
+ *
+ * @return true if any of the listed tags matches
+ */
+inline bool etagMatches(std::string_view header, std::string_view etag,
+                        ETagComparison comparison = ETagComparison::weak)
+{
+    auto isWeak = [](std::string_view tag) {
+        return tag.substr(0, 2) == "W/";
+    };
+    auto stripWeak = [&isWeak](std::string_view tag) {
+        if (isWeak(tag))
+        {
+            tag.remove_prefix(2);
+        }
+        return tag;
+    };
+    // Strong comparison only matches tags that are both strong
+    bool canMatchWeak = comparison == ETagComparison::weak;
+    bool etagIsWeak = isWeak(etag);
+    etag = stripWeak(etag);
+
+    while (!header.empty())
+    {
+        size_t start = header.find_first_not_of(" \t,");
+        if (start == std::string_view::npos)
+        {
+            break;
+        }
+        header.remove_prefix(start);
+        size_t end = header.find(',');
+        std::string_view tag = header.substr(0, end);
+        size_t last = tag.find_last_not_of(" \t");
+        tag = tag.substr(0, last + 1);
+        if (tag == "*" ||
+            ((canMatchWeak || (!etagIsWeak && !isWeak(tag))) &&
+             stripWeak(tag) == etag))
+        {
+            return true;
+        }
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        header.remove_prefix(end);
+    }
+    return false;
+}
+
+/**
+ * @brief An inclusive range of byte offsets
+ */
+struct ByteRange
+{
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    uint64_t size() const
+    {
+        return last - first + 1;
+    }
+};
+
+enum class RangeResult
+{
+    // No usable Range header, send the whole representation
+    none,
+    satisfiable,
+    // Send 416 Range Not Satisfiable
+    unsatisfiable,
+};
+
+/**
+ * @brief Reads a decimal number of bytes, failing on anything else or on
+ * overflow
+ */
+inline bool parseByteOffset(std::string_view value, uint64_t& offset)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+    offset = 0;
+    for (char c : value)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (offset > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+        {
+            return false;
+        }
+        offset = offset * 10 + digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses a Range header against a representation of a given size
+ *
+ * Only single byte ranges are supported: "bytes=first-last", "bytes=first-"
+ * and "bytes=-suffixLength".  RFC 7233 lets a server ignore any Range
+ * header, so multiple ranges and anything malformed give RangeResult::none.
+ *
+ * @param[in] header  Range header value
+ * @param[in] size    Size of the representation in bytes
+ * @param[out] range  The range to send, if satisfiable
+ */
+inline RangeResult parseRange(std::string_view header, uint64_t size,
+                              ByteRange& range)
+{
+    constexpr std::string_view unit = "bytes=";
+    if (header.substr(0, unit.size()) != unit)
+    {
+        return RangeResult::none;
+    }
+    header.remove_prefix(unit.size());
+    size_t dash = header.find('-');
+    if (dash == std::string_view::npos ||
+        header.find(',') != std::string_view::npos)
+    {
+        return RangeResult::none;
+    }
+    std::string_view firstValue = header.substr(0, dash);
+    std::string_view lastValue = header.substr(dash + 1);
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+    if (firstValue.empty())
+    {
+        // The last suffixLength bytes
+        if (!parseByteOffset(lastValue, last))
+        {
+            return RangeResult::none;
+        }
+        if (last == 0 || size == 0)
+        {
+            return RangeResult::unsatisfiable;
+        }
+        range.first = size - std::min(last, size);
+        range.last = size - 1;
+        return RangeResult::satisfiable;
+    }
+
+    if (!parseByteOffset(firstValue, first))
+    {
+        return RangeResult::none;
+    }
+    if (lastValue.empty())
+    {
+        last = std::numeric_limits<uint64_t>::max();
+    }
+    else if (!parseByteOffset(lastValue, last) || last < first)
+    {
+        return RangeResult::none;
+    }
+    if (first >= size)
+    {
+        return RangeResult::unsatisfiable;
+    }
+    range.first = first;
+    range.last = std::min(last, size - 1);
+    return RangeResult::satisfiable;
+}
 } // namespace http_helpers
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include <crow/websocket.h>
 #include <sys/socket.h>
 
-#include <boost/container/flat_map.hpp>
-#include <boost/container/flat_set.hpp>
+#include <algorithm>
+#include <boost/asio/write.hpp>
+#include <memory>
+#include <rfb.hpp>
+#include <string>
+#include <vector>
 #include <webserver_common.hpp>
 
 namespace crow
@@ -12,170 +16,772 @@ namespace crow
 namespace obmc_kvm
 {
 
-static std::unique_ptr<boost::asio::ip::tcp::socket> hostSocket;
+// A viewer's updates are skipped while this much is waiting to be sent to it.
+// Reading from the KVM server pauses while every viewer is that far behind
+constexpr size_t kvmHighWater = 256 * 1024;
+// A viewer that can't take a whole update within this is disconnected
+constexpr size_t kvmMaxQueued = 32 * 1024 * 1024;
+// Largest message the reads are coalesced into
+constexpr size_t kvmCoalesceLimit = 128 * 1024;
+// Most input waiting to be written to the KVM server, or to be framed for
+// one viewer
+constexpr size_t kvmMaxInput = 64 * 1024;
+// Most viewers connected at once, as each can have kvmMaxQueued waiting
+constexpr size_t kvmMaxViewers = 4;
 
-// TODO(ed) validate that these buffer sizes are sane
-static boost::beast::flat_static_buffer<1024U * 50U> outputBuffer;
-static boost::beast::flat_static_buffer<1024U> inputBuffer;
-
-static crow::websocket::Connection* session = nullptr;
+enum class Role
+{
+    // Keyboard, mouse and clipboard input is passed on
+    control,
+    // Input is dropped
+    readOnly,
+};
 
-static bool doingWrite = false;
+struct Viewer
+{
+    enum class Stage
+    {
+        version,
+        security,
+        clientInit,
+        // Waiting for the KVM server's ServerInit
+        waiting,
+        running,
+        // Closed by the proxy, waiting for the websocket to go
+        closed,
+    };
 
-inline void doWrite();
+    crow::websocket::Connection* conn;
+    Role role;
+    Stage stage = Stage::version;
+    // Input not yet framed into whole messages
+    std::string input;
+    // Gets the message the KVM server is sending
+    bool receiving = false;
+    // Updates are skipped until the send queue drains
+    bool skipping = false;
+    // Stopped skipping, and may have missed a change of framebuffer size
+    bool resumed = false;
+    // Has had every update that changed the Tight zlib streams
+    bool inSync = true;
+    // Framebuffer size the viewer last saw
+    uint16_t width = 0;
+    uint16_t height = 0;
+};
 
-inline void WriteDone(const boost::system::error_code& ec,
-                      std::size_t bytesWritten)
+/**
+ * @brief Relays one RFB connection to the KVM server to any number of
+ * websocket viewers.
+ *
+ * The proxy does the RFB handshake with the server once, and with each
+ * viewer itself.  Server messages are framed, so each viewer starts at a
+ * message boundary and, unless it is alone, can skip updates when it falls
+ * behind.  For that the encodings are limited to ones that don't keep state
+ * between updates, and Tight, whose fill and JPEG rectangles don't.  Once the
+ * KVM server sends a Tight rectangle that does, updates are no longer
+ * skipped, and a viewer that missed one is disconnected.  The pixel format
+ * and encodings are shared, and set by the first viewer to ask for them.
+ */
+class KvmProxy : public std::enable_shared_from_this<KvmProxy>
 {
-    BMCWEB_LOG_DEBUG << "Wrote " << bytesWritten << "bytes";
-    doingWrite = false;
-    inputBuffer.consume(bytesWritten);
+  public:
+    explicit KvmProxy(boost::asio::io_context& io) : hostSocket(io)
+    {
+    }
 
-    if (session == nullptr)
+    void connect()
     {
-        return;
+        boost::asio::ip::tcp::endpoint endpoint(
+            boost::asio::ip::make_address("127.0.0.1"), 5900);
+        hostSocket.async_connect(
+            endpoint, [this, self(shared_from_this())](
+                          const boost::system::error_code& ec) {
+                if (closed)
+                {
+                    return;
+                }
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Couldn't connect to KVM socket port: "
+                                     << ec;
+                    closeViewers("Error in connecting to KVM port");
+                    return;
+                }
+                // Key and pointer events are small, and shouldn't wait to be
+                // batched
+                boost::system::error_code optionEc;
+                hostSocket.set_option(boost::asio::ip::tcp::no_delay(true),
+                                      optionEc);
+                upstream = Upstream::version;
+                doRead();
+            });
     }
-    if (ec == boost::asio::error::eof)
+
+    void close()
     {
-        session->close("KVM socket port closed");
-        return;
+        closed = true;
+        boost::system::error_code ec;
+        hostSocket.close(ec);
     }
-    if (ec)
+
+    bool isClosed() const
     {
-        session->close("Error in reading to host port");
-        BMCWEB_LOG_ERROR << "Error in KVM socket write " << ec;
-        return;
+        return closed;
     }
 
-    doWrite();
-}
+    /**
+     * @return false if there are already kvmMaxViewers viewers
+     */
+    bool addViewer(crow::websocket::Connection& conn)
+    {
+        if (viewers.size() >= kvmMaxViewers)
+        {
+            BMCWEB_LOG_ERROR << "KVM viewer " << &conn
+                             << " refused, already " << viewers.size()
+                             << " viewers";
+            return false;
+        }
+        Viewer& viewer = viewers.emplace_back();
+        viewer.conn = &conn;
+        viewer.role = viewers.size() == 1 ? Role::control : Role::readOnly;
+        BMCWEB_LOG_DEBUG << "KVM viewer " << &conn << " joined"
+                         << (viewer.role == Role::control ? " with control"
+                                                          : " read-only");
+        conn.sendBinary(rfb::protocolVersion);
+        return true;
+    }
 
-inline void doWrite()
-{
-    if (doingWrite)
+    /**
+     * @return true if the last viewer left
+     */
+    bool removeViewer(crow::websocket::Connection& conn)
     {
-        BMCWEB_LOG_DEBUG << "Already writing.  Bailing out";
-        return;
+        auto it = std::find_if(
+            viewers.begin(), viewers.end(),
+            [&conn](const Viewer& viewer) { return viewer.conn == &conn; });
+        if (it == viewers.end())
+        {
+            return false;
+        }
+        bool hadControl = it->role == Role::control;
+        viewers.erase(it);
+        if (viewers.empty())
+        {
+            return true;
+        }
+        // The viewer reading was waiting for may have been this one
+        resume();
+        if (hadControl)
+        {
+            // Control passes to the viewer that has been waiting longest
+            viewers.front().role = Role::control;
+            BMCWEB_LOG_DEBUG << "KVM viewer " << viewers.front().conn
+                             << " has control";
+        }
+        return false;
     }
-    if (inputBuffer.size() == 0)
+
+    void onMessage(crow::websocket::Connection& conn, const std::string& data)
     {
-        BMCWEB_LOG_DEBUG << "inputBuffer empty.  Bailing out";
-        return;
+        Viewer* viewer = findViewer(conn);
+        if (viewer == nullptr)
+        {
+            return;
+        }
+        if (viewer->input.size() + data.size() > kvmMaxInput)
+        {
+            BMCWEB_LOG_ERROR << "Buffer overrun when writing " << data.size()
+                             << " bytes";
+            conn.close("Buffer overrun");
+            return;
+        }
+        viewer->input += data;
+        handleViewerInput(*viewer);
     }
 
-    doingWrite = true;
-    hostSocket->async_write_some(inputBuffer.data(), WriteDone);
-}
+    void onDrain(crow::websocket::Connection& conn)
+    {
+        Viewer* viewer = findViewer(conn);
+        if (viewer == nullptr || viewer->stage == Viewer::Stage::closed)
+        {
+            return;
+        }
+        if (viewer->skipping)
+        {
+            BMCWEB_LOG_DEBUG << "KVM viewer " << &conn << " caught up";
+            viewer->skipping = false;
+            viewer->resumed = true;
+            // Repaint whatever the skipped updates would have changed
+            writeHost(rfb::makeUpdateRequest(false, framer.width(),
+                                             framer.height()));
+        }
+        resume();
+    }
 
-inline void doRead();
+  private:
+    enum class Upstream
+    {
+        connecting,
+        version,
+        security,
+        securityResult,
+        serverInit,
+        running,
+    };
 
-inline void readDone(const boost::system::error_code& ec, std::size_t bytesRead)
-{
-    BMCWEB_LOG_DEBUG << "read done.  Read " << bytesRead << " bytes";
-    if (ec)
+    void resume()
+    {
+        if (paused && !closed)
+        {
+            paused = false;
+            doRead();
+        }
+    }
+
+    Viewer* findViewer(crow::websocket::Connection& conn)
     {
-        BMCWEB_LOG_ERROR << "Couldn't read from KVM socket port: " << ec;
-        if (session != nullptr)
+        for (Viewer& viewer : viewers)
         {
-            session->close("Error in connecting to KVM port");
+            if (viewer.conn == &conn)
+            {
+                return &viewer;
+            }
         }
-        return;
+        return nullptr;
     }
-    if (session == nullptr)
+
+    void closeViewers(const std::string_view reason)
     {
-        return;
+        close();
+        for (Viewer& viewer : viewers)
+        {
+            viewer.conn->close(reason);
+        }
     }
 
-    outputBuffer.commit(bytesRead);
-    std::string_view payload(
-        static_cast<const char*>(outputBuffer.data().data()), bytesRead);
-    BMCWEB_LOG_DEBUG << "Sending payload size " << payload.size();
-    session->sendBinary(payload);
-    outputBuffer.consume(bytesRead);
+    bool writeHost(std::string_view data)
+    {
+        if (hostPending.size() + data.size() > kvmMaxInput)
+        {
+            return false;
+        }
+        hostPending += data;
+        doWrite();
+        return true;
+    }
 
-    doRead();
-}
+    void doWrite()
+    {
+        if (!hostWriting.empty() || hostPending.empty())
+        {
+            return;
+        }
+        // New input goes to hostPending while hostWriting is in flight
+        hostWriting.swap(hostPending);
+        boost::asio::async_write(
+            hostSocket, boost::asio::buffer(hostWriting),
+            [this, self(shared_from_this())](
+                const boost::system::error_code& ec, std::size_t bytesWritten) {
+                BMCWEB_LOG_DEBUG << "Wrote " << bytesWritten << "bytes";
+                hostWriting.clear();
+                if (closed)
+                {
+                    return;
+                }
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Error in KVM socket write " << ec;
+                    closeViewers("Error in reading to host port");
+                    return;
+                }
+                doWrite();
+            });
+    }
 
-inline void doRead()
-{
-    std::size_t bytes = outputBuffer.capacity() - outputBuffer.size();
-    BMCWEB_LOG_DEBUG << "Reading " << bytes << " from kvm socket";
-    hostSocket->async_read_some(
-        outputBuffer.prepare(outputBuffer.capacity() - outputBuffer.size()),
-        readDone);
-}
+    void doRead()
+    {
+        hostSocket.async_read_some(
+            outputBuffer.prepare(outputBuffer.capacity() - outputBuffer.size()),
+            [this, self(shared_from_this())](
+                const boost::system::error_code& ec, std::size_t bytesRead) {
+                BMCWEB_LOG_DEBUG << "read done.  Read " << bytesRead
+                                 << " bytes";
+                if (closed)
+                {
+                    return;
+                }
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR
+                        << "Couldn't read from KVM socket port: " << ec;
+                    closeViewers("Error in connecting to KVM port");
+                    return;
+                }
+                outputBuffer.commit(bytesRead);
+                if (!processUpstream())
+                {
+                    closeViewers("Error in KVM data");
+                    return;
+                }
+                // Let the viewers slow the KVM server down instead of
+                // queueing video, but only as far as the fastest one
+                if (allBehind())
+                {
+                    paused = true;
+                    return;
+                }
+                doRead();
+            });
+    }
 
-inline void connectHandler(const boost::system::error_code& ec)
-{
-    if (ec)
+    bool allBehind() const
     {
-        BMCWEB_LOG_ERROR << "Couldn't connect to KVM socket port: " << ec;
-        if (session != nullptr)
+        bool any = false;
+        for (const Viewer& viewer : viewers)
         {
-            session->close("Error in connecting to KVM port");
+            if (viewer.stage == Viewer::Stage::running)
+            {
+                if (viewer.conn->bufferedAmount() < kvmHighWater)
+                {
+                    return false;
+                }
+                any = true;
+            }
         }
-        return;
+        return any;
     }
 
-    doRead();
-}
+    /**
+     * @return false if the KVM server can't be talked to
+     */
+    bool processUpstream()
+    {
+        while (true)
+        {
+            std::string_view data(
+                static_cast<const char*>(outputBuffer.data().data()),
+                outputBuffer.size());
+            switch (upstream)
+            {
+                case Upstream::connecting:
+                    return false;
+                case Upstream::version:
+                    if (data.size() < rfb::versionLength)
+                    {
+                        return true;
+                    }
+                    if (data.substr(0, 4) != "RFB " ||
+                        data.substr(0, rfb::versionLength) <
+                            rfb::protocolVersion)
+                    {
+                        BMCWEB_LOG_ERROR << "Unsupported KVM server version";
+                        return false;
+                    }
+                    writeHost(rfb::protocolVersion);
+                    outputBuffer.consume(rfb::versionLength);
+                    upstream = Upstream::security;
+                    break;
+                case Upstream::security:
+                {
+                    if (data.empty())
+                    {
+                        return true;
+                    }
+                    size_t count = static_cast<uint8_t>(data[0]);
+                    if (count == 0)
+                    {
+                        BMCWEB_LOG_ERROR << "KVM server refused connection";
+                        return false;
+                    }
+                    if (data.size() < 1 + count)
+                    {
+                        return true;
+                    }
+                    if (data.substr(1, count).find(static_cast<char>(
+                            rfb::securityNone)) == std::string_view::npos)
+                    {
+                        BMCWEB_LOG_ERROR << "KVM server requires security";
+                        return false;
+                    }
+                    writeHost(std::string(1, rfb::securityNone));
+                    outputBuffer.consume(1 + count);
+                    upstream = Upstream::securityResult;
+                    break;
+                }
+                case Upstream::securityResult:
+                    if (data.size() < 4)
+                    {
+                        return true;
+                    }
+                    if (rfb::readU32(data, 0) != 0)
+                    {
+                        BMCWEB_LOG_ERROR << "KVM server security failed";
+                        return false;
+                    }
+                    // ClientInit, asking to share the desktop
+                    writeHost(std::string(1, '\x01'));
+                    outputBuffer.consume(4);
+                    upstream = Upstream::serverInit;
+                    break;
+                case Upstream::serverInit:
+                {
+                    if (data.size() < rfb::serverInitLength)
+                    {
+                        return true;
+                    }
+                    size_t nameLength = rfb::readU32(data, 20);
+                    if (nameLength > rfb::maxNameLength)
+                    {
+                        BMCWEB_LOG_ERROR << "KVM server name is too long";
+                        return false;
+                    }
+                    if (data.size() < rfb::serverInitLength + nameLength)
+                    {
+                        return true;
+                    }
+                    framer = rfb::ServerFramer(rfb::readU16(data, 0),
+                                               rfb::readU16(data, 2));
+                    pixelFormat = data.substr(4, rfb::pixelFormatLength);
+                    name = data.substr(rfb::serverInitLength, nameLength);
+                    if (!framer.setPixelFormat(pixelFormat))
+                    {
+                        BMCWEB_LOG_ERROR << "Unsupported KVM pixel format";
+                        return false;
+                    }
+                    outputBuffer.consume(rfb::serverInitLength + nameLength);
+                    upstream = Upstream::running;
+                    for (Viewer& viewer : viewers)
+                    {
+                        if (viewer.stage == Viewer::Stage::waiting)
+                        {
+                            sendServerInit(viewer);
+                            handleViewerInput(viewer);
+                        }
+                    }
+                    break;
+                }
+                case Upstream::running:
+                    fanOut(data);
+                    outputBuffer.consume(data.size());
+                    return !framer.failed();
+            }
+        }
+    }
+
+    void fanOut(std::string_view data)
+    {
+        while (!data.empty())
+        {
+            if (framer.atBoundary())
+            {
+                startMessage(static_cast<uint8_t>(data[0]));
+            }
+            size_t length = framer.advance(data);
+            if (framer.failed())
+            {
+                BMCWEB_LOG_ERROR << "Can't relay KVM server message type "
+                                 << static_cast<int>(framer.messageType());
+                return;
+            }
+            if (framer.keepsState())
+            {
+                keptState = true;
+                closeOutOfSync();
+            }
+            std::string_view piece = data.substr(0, length);
+            for (Viewer& viewer : viewers)
+            {
+                if (viewer.receiving)
+                {
+                    viewer.conn->sendBinary(piece);
+                    viewer.width = framer.width();
+                    viewer.height = framer.height();
+                }
+            }
+            data.remove_prefix(length);
+        }
+    }
+
+    // Closes the viewers that can't decode the update being relayed, as they
+    // missed an earlier one that changed the Tight zlib streams, or are
+    // missing this one
+    void closeOutOfSync()
+    {
+        for (Viewer& viewer : viewers)
+        {
+            if (viewer.stage != Viewer::Stage::running ||
+                (viewer.receiving && viewer.inSync))
+            {
+                continue;
+            }
+            BMCWEB_LOG_ERROR << "KVM viewer " << viewer.conn
+                             << " missed a Tight update, closing";
+            viewer.stage = Viewer::Stage::closed;
+            viewer.receiving = false;
+            viewer.conn->close("Missed a KVM update");
+        }
+    }
+
+    // Picks the viewers that get the message starting now
+    void startMessage(uint8_t type)
+    {
+        for (Viewer& viewer : viewers)
+        {
+            viewer.receiving = false;
+            if (viewer.stage != Viewer::Stage::running)
+            {
+                continue;
+            }
+            if (viewer.resumed)
+            {
+                viewer.resumed = false;
+                if (viewer.width != framer.width() ||
+                    viewer.height != framer.height())
+                {
+                    viewer.width = framer.width();
+                    viewer.height = framer.height();
+                    viewer.conn->sendBinary(
+                        rfb::makeDesktopSize(viewer.width, viewer.height));
+                }
+            }
+            // A lone viewer gets everything, and slows the KVM server down
+            // instead
+            if (type == rfb::server::framebufferUpdate && !viewer.skipping &&
+                !keptState && viewers.size() > 1 &&
+                viewer.conn->bufferedAmount() >= kvmHighWater)
+            {
+                BMCWEB_LOG_DEBUG << "KVM viewer " << viewer.conn
+                                 << " is behind, skipping updates";
+                viewer.skipping = true;
+            }
+            viewer.receiving =
+                type != rfb::server::framebufferUpdate || !viewer.skipping;
+        }
+    }
+
+    void sendServerInit(Viewer& viewer)
+    {
+        viewer.width = framer.width();
+        viewer.height = framer.height();
+        viewer.conn->sendBinary(rfb::makeServerInit(
+            viewer.width, viewer.height, pixelFormat, name));
+        viewer.stage = Viewer::Stage::running;
+        // The KVM server's zlib streams have history this viewer lacks
+        viewer.inSync = !keptState;
+        resume();
+    }
+
+    void handleViewerInput(Viewer& viewer)
+    {
+        std::string_view input(viewer.input);
+        size_t used = 0;
+        while (true)
+        {
+            std::string_view rest = input.substr(used);
+            size_t length = rfb::needMore;
+            switch (viewer.stage)
+            {
+                case Viewer::Stage::version:
+                    length = rfb::versionLength;
+                    break;
+                case Viewer::Stage::security:
+                case Viewer::Stage::clientInit:
+                    length = 1;
+                    break;
+                case Viewer::Stage::waiting:
+                case Viewer::Stage::closed:
+                    break;
+                case Viewer::Stage::running:
+                    length = rfb::clientMessageLength(rest);
+                    break;
+            }
+            if (length == rfb::invalidMessage)
+            {
+                BMCWEB_LOG_ERROR << "Unsupported RFB message type "
+                                 << static_cast<int>(rest[0]);
+                viewer.conn->close("Unsupported RFB message");
+                return;
+            }
+            if (length == rfb::needMore || rest.size() < length)
+            {
+                break;
+            }
+            if (!handleViewerMessage(viewer, rest.substr(0, length)))
+            {
+                return;
+            }
+            used += length;
+        }
+        viewer.input.erase(0, used);
+    }
+
+    /**
+     * @return false if the viewer was closed
+     */
+    bool handleViewerMessage(Viewer& viewer, std::string_view message)
+    {
+        crow::websocket::Connection& conn = *viewer.conn;
+        switch (viewer.stage)
+        {
+            case Viewer::Stage::version:
+            {
+                if (message != rfb::protocolVersion)
+                {
+                    conn.close("Unsupported RFB version");
+                    return false;
+                }
+                // The number of security types, 1, then the only one, None
+                std::string securityTypes;
+                securityTypes += '\x01';
+                securityTypes += static_cast<char>(rfb::securityNone);
+                conn.sendBinary(std::move(securityTypes));
+                viewer.stage = Viewer::Stage::security;
+                return true;
+            }
+            case Viewer::Stage::security:
+                if (static_cast<uint8_t>(message[0]) != rfb::securityNone)
+                {
+                    conn.close("Unsupported RFB security type");
+                    return false;
+                }
+                conn.sendBinary(std::string(4, '\0'));
+                viewer.stage = Viewer::Stage::clientInit;
+                return true;
+            case Viewer::Stage::clientInit:
+                // The desktop is always shared, whatever the viewer asks
+                viewer.stage = Viewer::Stage::waiting;
+                if (upstream == Upstream::running)
+                {
+                    sendServerInit(viewer);
+                }
+                return true;
+            case Viewer::Stage::waiting:
+            case Viewer::Stage::closed:
+                return true;
+            case Viewer::Stage::running:
+                break;
+        }
+
+        bool written = true;
+        switch (static_cast<uint8_t>(message[0]))
+        {
+            case rfb::client::setPixelFormat:
+            {
+                std::string_view format =
+                    message.substr(4, rfb::pixelFormatLength);
+                if (updatesRequested)
+                {
+                    // Updates in flight are in the current format, so it
+                    // can't change any more
+                    if (format != pixelFormat)
+                    {
+                        conn.close("Pixel format differs from other viewers");
+                        return false;
+                    }
+                    return true;
+                }
+                if (!framer.setPixelFormat(format))
+                {
+                    conn.close("Unsupported pixel format");
+                    return false;
+                }
+                pixelFormat = format;
+                written = writeHost(message);
+                break;
+            }
+            case rfb::client::setEncodings:
+                if (!encodingsSet)
+                {
+                    encodingsSet = true;
+                    written = writeHost(rfb::filterEncodings(message));
+                }
+                break;
+            case rfb::client::framebufferUpdateRequest:
+                updatesRequested = true;
+                written = writeHost(message);
+                break;
+            default:
+                if (viewer.role == Role::control)
+                {
+                    written = writeHost(message);
+                }
+                break;
+        }
+        if (!written)
+        {
+            BMCWEB_LOG_ERROR << "KVM input buffer full";
+            conn.close("Buffer overrun");
+            return false;
+        }
+        return true;
+    }
+
+    boost::asio::ip::tcp::socket hostSocket;
+    Upstream upstream = Upstream::connecting;
+    bool closed = false;
+    // Reading from the KVM server waits for a viewer to drain
+    bool paused = false;
+
+    // TODO(ed) validate that these buffer sizes are sane
+    boost::beast::flat_static_buffer<1024U * 50U> outputBuffer;
+    std::string hostPending;
+    std::string hostWriting;
+
+    rfb::ServerFramer framer{0, 0};
+    std::string pixelFormat;
+    std::string name;
+    bool encodingsSet = false;
+    bool updatesRequested = false;
+    // The KVM server has sent a Tight rectangle that changed its zlib streams
+    bool keptState = false;
+
+    // In the order they joined
+    std::vector<Viewer> viewers;
+};
+
+static std::shared_ptr<KvmProxy> proxy;
 
 inline void requestRoutes(CrowApp& app)
 {
     BMCWEB_ROUTE(app, "/kvm/0")
         .websocket()
+        .sendQueue(kvmMaxQueued)
+        .coalesce(kvmCoalesceLimit)
         .onopen([](crow::websocket::Connection& conn) {
             BMCWEB_LOG_DEBUG << "Connection " << &conn << " opened";
 
-            if (session != nullptr)
+            // A proxy that lost the KVM server is left to its viewers
+            if (proxy == nullptr || proxy->isClosed())
             {
-                conn.close("User already connected");
-                return;
+                proxy = std::make_shared<KvmProxy>(conn.get_io_context());
+                proxy->connect();
             }
-
-            session = &conn;
-            if (hostSocket == nullptr)
+            if (!proxy->addViewer(conn))
             {
-                boost::asio::ip::tcp::endpoint endpoint(
-                    boost::asio::ip::make_address("127.0.0.1"), 5900);
-
-                hostSocket = std::make_unique<boost::asio::ip::tcp::socket>(
-                    conn.get_io_context());
-                hostSocket->async_connect(endpoint, connectHandler);
+                conn.close("Too many KVM viewers");
+                return;
             }
+            conn.onDrain([](crow::websocket::Connection& conn) {
+                if (proxy != nullptr)
+                {
+                    proxy->onDrain(conn);
+                }
+            });
         })
         .onclose(
             [](crow::websocket::Connection& conn, const std::string& reason) {
-                session = nullptr;
-                hostSocket = nullptr;
-#if BOOST_VERSION >= 107000
-                inputBuffer.clear();
-                outputBuffer.clear();
-#else
-                inputBuffer.reset();
-                outputBuffer.reset();
-#endif
+                if (proxy != nullptr && proxy->removeViewer(conn))
+                {
+                    proxy->close();
+                    proxy = nullptr;
+                }
             })
         .onmessage([](crow::websocket::Connection& conn,
                       const std::string& data, bool is_binary) {
-            if (data.length() > inputBuffer.capacity())
+            if (proxy != nullptr)
             {
-                BMCWEB_LOG_ERROR << "Buffer overrun when writing "
-                                 << data.length() << " bytes";
-                conn.close("Buffer overrun");
-                return;
+                proxy->onMessage(conn, data);
             }
-
-            BMCWEB_LOG_DEBUG << "Read " << data.size()
-                             << " bytes from websocket";
-            boost::asio::buffer_copy(inputBuffer.prepare(data.size()),
-                                     boost::asio::buffer(data));
-            BMCWEB_LOG_DEBUG << "commiting " << data.size()
-                             << " bytes from websocket";
-            inputBuffer.commit(data.size());
-
-            BMCWEB_LOG_DEBUG << "inputbuffer size " << inputBuffer.size();
-            doWrite();
         });
 }
 } // namespace obmc_kvm
@@ -21,6 +21,9 @@ static boost::container::flat_set<crow::websocket::Connection*> sessions;
 
 static bool doingWrite = false;
 
+// Largest message the console output is coalesced into
+constexpr size_t consoleCoalesceLimit = 64 * 1024;
+
 void doWrite()
 {
     if (doingWrite)
@@ -105,6 +108,8 @@ void requestRoutes(CrowApp& app)
 {
     BMCWEB_ROUTE(app, "/console0")
         .websocket()
+        .coalesce(consoleCoalesceLimit)
+        .compression()
         .onopen([](crow::websocket::Connection& conn) {
             BMCWEB_LOG_DEBUG << "Connection " << &conn << " opened";
 
@@ -122,6 +127,8 @@ void requestRoutes(CrowApp& app)
         })
         .onclose(
             [](crow::websocket::Connection& conn, const std::string& reason) {
+                BMCWEB_LOG_INFO << "Connection " << &conn << " closed, "
+                                << conn.trafficStats();
                 sessions.erase(&conn);
                 if (sessions.empty())
                 {
@@ -14,17 +14,29 @@
 
 #pragma once
 #include <crow/app.h>
-#include <tinyxml2.h>
 
 #include <async_resp.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/container/flat_set.hpp>
+#include <cctype>
+#include <chrono>
+#include <dbus_introspection.hpp>
+#include <dbus_rest_batch.hpp>
+#include <dbus_rest_messages.hpp>
+#include <dbus_signature.hpp>
 #include <dbus_singleton.hpp>
 #include <dbus_utility.hpp>
+#include <deque>
 #include <filesystem>
 #include <fstream>
-#include <regex>
+#include <functional>
+#include <http_utility.hpp>
+#include <map>
+#include <optional>
 #include <sdbusplus/message/types.hpp>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace crow
 {
@@ -35,23 +47,6 @@ using GetSubTreeType = std::vector<
     std::pair<std::string,
               std::vector<std::pair<std::string, std::vector<std::string>>>>>;
 
-const std::string notFoundMsg = "404 Not Found";
-const std::string badReqMsg = "400 Bad Request";
-const std::string methodNotAllowedMsg = "405 Method Not Allowed";
-const std::string forbiddenMsg = "403 Forbidden";
-const std::string methodFailedMsg = "500 Method Call Failed";
-const std::string methodOutputFailedMsg = "500 Method Output Error";
-
-const std::string notFoundDesc =
-    "org.freedesktop.DBus.Error.FileNotFound: path or object not found";
-const std::string propNotFoundDesc = "The specified property cannot be found";
-const std::string noJsonDesc = "No JSON object could be decoded";
-const std::string methodNotFoundDesc = "The specified method cannot be found";
-const std::string methodNotAllowedDesc = "Method not allowed";
-const std::string forbiddenPropDesc =
-    "The specified property cannot be created";
-const std::string forbiddenResDesc = "The specified resource cannot be created";
-
 void setErrorResponse(crow::Response &res, boost::beast::http::status result,
                       const std::string &desc, const std::string &msg)
 {
@@ -72,327 +67,515 @@ void introspectObjects(const std::string &processName,
                                       {"objects", nlohmann::json::array()}};
     }
 
-    crow::connections::systemBus->async_method_call(
+    dbus::introspection::Cache::getInstance().get(
+        processName, objectPath,
         [transaction, processName{std::string(processName)},
          objectPath{std::string(objectPath)}](
             const boost::system::error_code ec,
-            const std::string &introspect_xml) {
+            const std::shared_ptr<const dbus::introspection::Node> &node) {
             if (ec)
             {
-                BMCWEB_LOG_ERROR
-                    << "Introspect call failed with error: " << ec.message()
-                    << " on process: " << processName << " path: " << objectPath
-                    << "\n";
                 return;
             }
             transaction->res.jsonValue["objects"].push_back(
                 {{"path", objectPath}});
-
-            tinyxml2::XMLDocument doc;
-
-            doc.Parse(introspect_xml.c_str());
-            tinyxml2::XMLNode *pRoot = doc.FirstChildElement("node");
-            if (pRoot == nullptr)
+            if (node == nullptr)
             {
-                BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                 << processName << " " << objectPath << "\n";
+                return;
             }
-            else
+            for (const std::string &childPath : node->children)
             {
-                tinyxml2::XMLElement *node = pRoot->FirstChildElement("node");
-                while (node != nullptr)
+                std::string newpath;
+                if (objectPath != "/")
                 {
-                    const char *childPath = node->Attribute("name");
-                    if (childPath != nullptr)
-                    {
-                        std::string newpath;
-                        if (objectPath != "/")
-                        {
-                            newpath += objectPath;
-                        }
-                        newpath += std::string("/") + childPath;
-                        // introspect the subobjects as well
-                        introspectObjects(processName, newpath, transaction);
-                    }
-
-                    node = node->NextSiblingElement("node");
+                    newpath += objectPath;
                 }
+                newpath += "/" + childPath;
+                // introspect the subobjects as well
+                introspectObjects(processName, newpath, transaction);
             }
-        },
-        processName, objectPath, "org.freedesktop.DBus.Introspectable",
-        "Introspect");
+        });
 }
 
-void getPropertiesForEnumerate(const std::string &objectPath,
-                               const std::string &service,
-                               const std::string &interface,
-                               std::shared_ptr<bmcweb::AsyncResp> asyncResp)
+// Most D-Bus calls an enumerate keeps in flight at once
+constexpr size_t enumerateCallWindow = 4;
+// An enumerate holds off new calls while more than this is waiting to be sent
+constexpr size_t enumerateHighWater = 64 * 1024;
+// A client that falls this far behind is disconnected.  Replies already in
+// flight can overshoot the high water mark, so this leaves room for them
+constexpr size_t enumerateMaxQueued = 16 * 1024 * 1024;
+
+/**
+ * @brief An enumerate that streams each object to the client as its
+ * properties arrive
+ *
+ * The GetManagedObjects calls, and the GetAll calls for objects that no
+ * ObjectManager reported, go through a queue that keeps at most
+ * enumerateCallWindow of them in flight.  Nothing new is issued while the
+ * client is behind, so memory use depends on the size of a reply rather than
+ * on the number of objects.  Objects that more than one service serves are
+ * held back until each has reported, so their properties can be merged.
+ */
+struct EnumerateStream : std::enable_shared_from_this<EnumerateStream>
 {
-    BMCWEB_LOG_DEBUG << "getPropertiesForEnumerate " << objectPath << " "
-                     << service << " " << interface;
+    EnumerateStream(const std::string &objectPath, GetSubTreeType &&subtree) :
+        objectPath(objectPath), subtree(std::move(subtree))
+    {
+        for (const auto &[path, services] : this->subtree)
+        {
+            serviceCount[path] = services.size();
+        }
+    }
 
-    crow::connections::systemBus->async_method_call(
-        [asyncResp, objectPath, service,
-         interface](const boost::system::error_code ec,
-                    const std::vector<
-                        std::pair<std::string, dbus::utility::DbusVariantType>>
-                        &propertiesList) {
-            if (ec)
+    void start(crow::streaming::Connection &connection)
+    {
+        conn = &connection;
+        conn->onDrain([self(shared_from_this())](
+                          crow::streaming::Connection &) { self->pump(); });
+        conn->send("{\"data\":{");
+        queueManagedObjects();
+        pump();
+    }
+
+    // The client went away, or the stream was closed.  Calls already in
+    // flight still hold a reference, but nothing else is needed any more
+    void stop()
+    {
+        conn = nullptr;
+        calls.clear();
+        partial.clear();
+        seen.clear();
+    }
+
+  private:
+    void queueManagedObjects()
+    {
+        // Map indicating connection name, and the path where the object
+        // manager exists
+        boost::container::flat_map<std::string, std::string> connections;
+        for (const auto &[path, services] : subtree)
+        {
+            for (const auto &[service, interfaces] : services)
             {
-                BMCWEB_LOG_ERROR << "GetAll on path " << objectPath << " iface "
-                                 << interface << " service " << service
-                                 << " failed with code " << ec;
-                return;
+                std::string &objectManagerPath = connections[service];
+                if (std::find(interfaces.begin(), interfaces.end(),
+                              "org.freedesktop.DBus.ObjectManager") !=
+                    interfaces.end())
+                {
+                    objectManagerPath = path;
+                }
             }
+        }
 
-            nlohmann::json &dataJson = asyncResp->res.jsonValue["data"];
-            nlohmann::json &objectJson = dataJson[objectPath];
-            if (objectJson.is_null())
+        for (const auto &[service, objectManagerPath] : connections)
+        {
+            // If we already know where the object manager is, we don't need
+            // to search for it
+            if (!objectManagerPath.empty())
             {
-                objectJson = nlohmann::json::object();
+                queueGetManagedObjects(service, objectManagerPath);
             }
-
-            for (const auto &[name, value] : propertiesList)
+            else
             {
-                nlohmann::json &propertyJson = objectJson[name];
-                std::visit([&propertyJson](auto &&val) { propertyJson = val; },
-                           value);
+                queueFindObjectManager(service);
             }
-        },
-        service, objectPath, "org.freedesktop.DBus.Properties", "GetAll",
-        interface);
-}
+        }
+    }
 
-// Find any results that weren't picked up by ObjectManagers, to be
-// called after all ObjectManagers are searched for and called.
-void findRemainingObjectsForEnumerate(
-    const std::string &objectPath, std::shared_ptr<GetSubTreeType> subtree,
-    std::shared_ptr<bmcweb::AsyncResp> asyncResp)
-{
-    BMCWEB_LOG_DEBUG << "findRemainingObjectsForEnumerate";
-    const nlohmann::json &dataJson = asyncResp->res.jsonValue["data"];
+    void queueFindObjectManager(const std::string &service)
+    {
+        calls.emplace_back([weak(weak_from_this()), service]() {
+            std::shared_ptr<EnumerateStream> self = weak.lock();
+            if (self == nullptr)
+            {
+                return;
+            }
+            crow::connections::systemBus->async_method_call(
+                [self, service](
+                    const boost::system::error_code ec,
+                    const boost::container::flat_map<
+                        std::string,
+                        boost::container::flat_map<
+                            std::string, std::vector<std::string>>> &objects) {
+                    if (ec)
+                    {
+                        BMCWEB_LOG_ERROR << "GetAncestors on path "
+                                         << self->objectPath
+                                         << " failed with code " << ec;
+                    }
+                    else
+                    {
+                        for (const auto &[path, services] : objects)
+                        {
+                            if (services.find(service) != services.end())
+                            {
+                                // Found the object manager path for this
+                                // resource
+                                self->queueGetManagedObjects(service, path);
+                                break;
+                            }
+                        }
+                    }
+                    self->callDone();
+                },
+                "xyz.openbmc_project.ObjectMapper",
+                "/xyz/openbmc_project/object_mapper",
+                "xyz.openbmc_project.ObjectMapper", "GetAncestors",
+                self->objectPath,
+                std::array<const char *, 1>{
+                    "org.freedesktop.DBus.ObjectManager"});
+        });
+    }
 
-    for (const auto &[path, interface_map] : *subtree)
+    void queueGetManagedObjects(const std::string &service,
+                                const std::string &objectManagerPath)
     {
-        if (path == objectPath)
+        // Nested object managers can be reported more than once
+        if (!objectManagers.emplace(service, objectManagerPath).second)
         {
-            // An enumerate does not return the target path's properties
-            continue;
+            return;
         }
-        if (dataJson.find(path) == dataJson.end())
+        calls.emplace_back([weak(weak_from_this()), service,
+                            objectManagerPath]() {
+            std::shared_ptr<EnumerateStream> self = weak.lock();
+            if (self == nullptr)
+            {
+                return;
+            }
+            crow::connections::systemBus->async_method_call(
+                [self, service, objectManagerPath](
+                    const boost::system::error_code ec,
+                    const dbus::utility::ManagedObjectType &objects) {
+                    if (ec)
+                    {
+                        BMCWEB_LOG_ERROR << "GetManagedObjects on path "
+                                         << objectManagerPath
+                                         << " on connection " << service
+                                         << " failed with code " << ec;
+                    }
+                    else
+                    {
+                        self->addManagedObjects(service, objects);
+                    }
+                    self->callDone();
+                },
+                service, objectManagerPath,
+                "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        });
+    }
+
+    void addManagedObjects(const std::string &service,
+                           const dbus::utility::ManagedObjectType &objects)
+    {
+        std::string chunk;
+        for (const auto &[path, interfaces] : objects)
         {
-            for (const auto &[service, interfaces] : interface_map)
+            if (boost::starts_with(path.str, objectPath))
             {
+                BMCWEB_LOG_DEBUG << "Reading object " << path.str;
+                nlohmann::json objectJson = nlohmann::json::object();
                 for (const auto &interface : interfaces)
                 {
-                    if (!boost::starts_with(interface, "org.freedesktop.DBus"))
+                    for (const auto &[name, value] : interface.second)
                     {
-                        getPropertiesForEnumerate(path, service, interface,
-                                                  asyncResp);
+                        nlohmann::json &propertyJson = objectJson[name];
+                        std::visit(
+                            [&propertyJson](auto &&val) { propertyJson = val; },
+                            value);
                     }
                 }
+                auto countIt = serviceCount.find(path.str);
+                size_t services =
+                    countIt == serviceCount.end() ? 1 : countIt->second;
+                addObject(path.str, services, std::move(objectJson), chunk);
+            }
+            if (interfaces.find("org.freedesktop.DBus.ObjectManager") !=
+                interfaces.end())
+            {
+                queueGetManagedObjects(service, path.str);
             }
         }
+        send(std::move(chunk));
     }
-}
 
-struct InProgressEnumerateData
-{
-    InProgressEnumerateData(const std::string &objectPath,
-                            std::shared_ptr<bmcweb::AsyncResp> asyncResp) :
-        objectPath(objectPath),
-        asyncResp(asyncResp)
+    // Find any objects that weren't picked up by ObjectManagers, to be
+    // called after all ObjectManagers are searched for and called.
+    void queueRemainingObjects()
     {
+        for (const auto &[path, services] : subtree)
+        {
+            if (path == objectPath)
+            {
+                // An enumerate does not return the target path's properties
+                continue;
+            }
+            if (seen.find(path) != seen.end())
+            {
+                continue;
+            }
+            size_t parts = 0;
+            for (const auto &[service, interfaces] : services)
+            {
+                for (const std::string &interface : interfaces)
+                {
+                    if (!boost::starts_with(interface, "org.freedesktop.DBus"))
+                    {
+                        queueGetAll(path, service, interface);
+                        parts++;
+                    }
+                }
+            }
+            if (parts > 0)
+            {
+                seen.emplace(path);
+                partial[path].remaining = parts;
+            }
+        }
     }
 
-    ~InProgressEnumerateData()
+    void queueGetAll(const std::string &path, const std::string &service,
+                     const std::string &interface)
     {
-        findRemainingObjectsForEnumerate(objectPath, subtree, asyncResp);
-    }
-
-    const std::string objectPath;
-    std::shared_ptr<GetSubTreeType> subtree;
-    std::shared_ptr<bmcweb::AsyncResp> asyncResp;
-};
-
-void getManagedObjectsForEnumerate(
-    const std::string &object_name, const std::string &object_manager_path,
-    const std::string &connection_name,
-    std::shared_ptr<InProgressEnumerateData> transaction)
-{
-    BMCWEB_LOG_DEBUG << "getManagedObjectsForEnumerate " << object_name
-                     << " object_manager_path " << object_manager_path
-                     << " connection_name " << connection_name;
-    crow::connections::systemBus->async_method_call(
-        [transaction, object_name,
-         connection_name](const boost::system::error_code ec,
-                          const dbus::utility::ManagedObjectType &objects) {
-            if (ec)
+        calls.emplace_back([weak(weak_from_this()), path, service,
+                            interface]() {
+            std::shared_ptr<EnumerateStream> self = weak.lock();
+            if (self == nullptr)
             {
-                BMCWEB_LOG_ERROR << "GetManagedObjects on path " << object_name
-                                 << " on connection " << connection_name
-                                 << " failed with code " << ec;
                 return;
             }
-
-            nlohmann::json &dataJson =
-                transaction->asyncResp->res.jsonValue["data"];
-
-            for (const auto &objectPath : objects)
-            {
-                if (boost::starts_with(objectPath.first.str, object_name))
-                {
-                    BMCWEB_LOG_DEBUG << "Reading object "
-                                     << objectPath.first.str;
-                    nlohmann::json &objectJson = dataJson[objectPath.first.str];
-                    if (objectJson.is_null())
+            crow::connections::systemBus->async_method_call(
+                [self, path, service, interface](
+                    const boost::system::error_code ec,
+                    const std::vector<std::pair<
+                        std::string, dbus::utility::DbusVariantType>>
+                        &propertiesList) {
+                    std::optional<nlohmann::json> objectJson;
+                    if (ec)
                     {
-                        objectJson = nlohmann::json::object();
+                        BMCWEB_LOG_ERROR << "GetAll on path " << path
+                                         << " iface " << interface
+                                         << " service " << service
+                                         << " failed with code " << ec;
                     }
-                    for (const auto &interface : objectPath.second)
+                    else
                     {
-                        for (const auto &property : interface.second)
+                        objectJson.emplace(nlohmann::json::object());
+                        for (const auto &[name, value] : propertiesList)
                         {
-                            nlohmann::json &propertyJson =
-                                objectJson[property.first];
+                            nlohmann::json &propertyJson = (*objectJson)[name];
                             std::visit([&propertyJson](
                                            auto &&val) { propertyJson = val; },
-                                       property.second);
+                                       value);
                         }
                     }
-                }
-                for (const auto &interface : objectPath.second)
-                {
-                    if (interface.first == "org.freedesktop.DBus.ObjectManager")
-                    {
-                        getManagedObjectsForEnumerate(
-                            objectPath.first.str, objectPath.first.str,
-                            connection_name, transaction);
-                    }
-                }
+                    std::string chunk;
+                    self->addPart(path, std::move(objectJson), chunk);
+                    self->send(std::move(chunk));
+                    self->callDone();
+                },
+                service, path, "org.freedesktop.DBus.Properties", "GetAll",
+                interface);
+        });
+    }
+
+    /**
+     * @brief Adds what one service reported for an object, writing it to
+     * chunk once every service has
+     */
+    void addObject(const std::string &path, size_t services,
+                   nlohmann::json &&objectJson, std::string &chunk)
+    {
+        if (services <= 1)
+        {
+            if (seen.emplace(path).second)
+            {
+                appendObject(path, objectJson, chunk);
             }
-        },
-        connection_name, object_manager_path,
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
-}
+            return;
+        }
+        if (seen.emplace(path).second)
+        {
+            partial[path].remaining = services;
+        }
+        addPart(path, std::move(objectJson), chunk);
+    }
 
-void findObjectManagerPathForEnumerate(
-    const std::string &object_name, const std::string &connection_name,
-    std::shared_ptr<InProgressEnumerateData> transaction)
-{
-    BMCWEB_LOG_DEBUG << "Finding objectmanager for path " << object_name
-                     << " on connection:" << connection_name;
-    crow::connections::systemBus->async_method_call(
-        [transaction, object_name, connection_name](
-            const boost::system::error_code ec,
-            const boost::container::flat_map<
-                std::string, boost::container::flat_map<
-                                 std::string, std::vector<std::string>>>
-                &objects) {
-            if (ec)
+    void addPart(const std::string &path,
+                 std::optional<nlohmann::json> &&objectJson, std::string &chunk)
+    {
+        auto it = partial.find(path);
+        if (it == partial.end())
+        {
+            // Already complete
+            return;
+        }
+        Partial &part = it->second;
+        if (objectJson)
+        {
+            if (part.object)
             {
-                BMCWEB_LOG_ERROR << "GetAncestors on path " << object_name
-                                 << " failed with code " << ec;
-                return;
+                part.object->update(*objectJson);
+            }
+            else
+            {
+                part.object = std::move(objectJson);
+            }
+        }
+        if (--part.remaining == 0)
+        {
+            if (part.object)
+            {
+                appendObject(path, *part.object, chunk);
             }
+            partial.erase(it);
+        }
+    }
+
+    void appendObject(const std::string &path,
+                      const nlohmann::json &objectJson, std::string &chunk)
+    {
+        if (!first)
+        {
+            chunk += ',';
+        }
+        first = false;
+        chunk += nlohmann::json(path).dump();
+        chunk += ':';
+        chunk += objectJson.dump();
+    }
+
+    void send(std::string &&chunk)
+    {
+        if (conn != nullptr && !chunk.empty())
+        {
+            conn->send(std::move(chunk));
+        }
+    }
+
+    void callDone()
+    {
+        inFlight--;
+        pump();
+    }
+
+    // Issues queued calls while there is room, and moves on once they're
+    // all done
+    void pump()
+    {
+        if (conn == nullptr || finished)
+        {
+            return;
+        }
+        while (!calls.empty() && inFlight < enumerateCallWindow &&
+               conn->bufferedAmount() < enumerateHighWater)
+        {
+            std::function<void()> call = std::move(calls.front());
+            calls.pop_front();
+            inFlight++;
+            call();
+        }
+        if (!calls.empty() || inFlight > 0)
+        {
+            return;
+        }
+        if (!remainingQueued)
+        {
+            remainingQueued = true;
+            queueRemainingObjects();
+            pump();
+            return;
+        }
+        finish();
+    }
 
-            for (const auto &pathGroup : objects)
+    void finish()
+    {
+        finished = true;
+        // Objects some of whose services didn't answer
+        std::string chunk;
+        for (auto &[path, part] : partial)
+        {
+            if (part.object)
             {
-                for (const auto &connectionGroup : pathGroup.second)
-                {
-                    if (connectionGroup.first == connection_name)
-                    {
-                        // Found the object manager path for this resource.
-                        getManagedObjectsForEnumerate(
-                            object_name, pathGroup.first, connection_name,
-                            transaction);
-                        return;
-                    }
-                }
+                appendObject(path, *part.object, chunk);
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetAncestors", object_name,
-        std::array<const char *, 1>{"org.freedesktop.DBus.ObjectManager"});
-}
+        }
+        partial.clear();
+        chunk += "},\"message\":\"200 OK\",\"status\":\"ok\"}";
+        send(std::move(chunk));
+        conn->onDrain(nullptr);
+        conn->close();
+    }
+
+    struct Partial
+    {
+        // Reports still to come
+        size_t remaining = 0;
+        std::optional<nlohmann::json> object;
+    };
+
+    const std::string objectPath;
+    GetSubTreeType subtree;
+    // Number of services serving each object
+    std::unordered_map<std::string, size_t> serviceCount;
+    // Objects sent, or waiting for the rest of their services
+    std::unordered_set<std::string> seen;
+    std::unordered_map<std::string, Partial> partial;
+    std::set<std::pair<std::string, std::string>> objectManagers;
+
+    // Holds weak references, so an abandoned enumerate isn't kept alive by
+    // the calls it never got to make
+    std::deque<std::function<void()>> calls;
+    size_t inFlight = 0;
+    bool remainingQueued = false;
+    bool first = true;
+    bool finished = false;
+    crow::streaming::Connection *conn = nullptr;
+};
 
 // Uses GetObject to add the object info about the target /enumerate path to
 // the results of GetSubTree, as GetSubTree will not return info for the
-// target path, and then continues on enumerating the rest of the tree.
-void getObjectAndEnumerate(std::shared_ptr<InProgressEnumerateData> transaction)
+// target path, and then streams the rest of the tree.
+void getObjectAndEnumerate(const std::string &objectPath,
+                           std::shared_ptr<GetSubTreeType> subtree,
+                           std::shared_ptr<bmcweb::AsyncResp> asyncResp)
 {
     using GetObjectType =
         std::vector<std::pair<std::string, std::vector<std::string>>>;
 
     crow::connections::systemBus->async_method_call(
-        [transaction](const boost::system::error_code ec,
-                      const GetObjectType &objects) {
+        [objectPath, subtree, asyncResp](const boost::system::error_code ec,
+                                         const GetObjectType &objects) {
             if (ec)
             {
-                BMCWEB_LOG_ERROR << "GetObject for path "
-                                 << transaction->objectPath
+                BMCWEB_LOG_ERROR << "GetObject for path " << objectPath
                                  << " failed with code " << ec;
-                return;
-            }
-
-            BMCWEB_LOG_DEBUG << "GetObject for " << transaction->objectPath
-                             << " has " << objects.size() << " entries";
-            if (!objects.empty())
-            {
-                transaction->subtree->emplace_back(transaction->objectPath,
-                                                   objects);
-            }
-
-            // Map indicating connection name, and the path where the object
-            // manager exists
-            boost::container::flat_map<std::string, std::string> connections;
-
-            for (const auto &object : *(transaction->subtree))
-            {
-                for (const auto &connection : object.second)
-                {
-                    std::string &objectManagerPath =
-                        connections[connection.first];
-                    for (const auto &interface : connection.second)
-                    {
-                        BMCWEB_LOG_DEBUG << connection.first
-                                         << " has interface " << interface;
-                        if (interface == "org.freedesktop.DBus.ObjectManager")
-                        {
-                            BMCWEB_LOG_DEBUG << "found object manager path "
-                                             << object.first;
-                            objectManagerPath = object.first;
-                        }
-                    }
-                }
-            }
-            BMCWEB_LOG_DEBUG << "Got " << connections.size() << " connections";
-
-            for (const auto &connection : connections)
-            {
-                // If we already know where the object manager is, we don't
-                // need to search for it, we can call directly in to
-                // getManagedObjects
-                if (!connection.second.empty())
-                {
-                    getManagedObjectsForEnumerate(
-                        transaction->objectPath, connection.second,
-                        connection.first, transaction);
-                }
-                else
-                {
-                    // otherwise we need to find the object manager path
-                    // before we can continue
-                    findObjectManagerPathForEnumerate(
-                        transaction->objectPath, connection.first, transaction);
-                }
             }
+            else if (!objects.empty())
+            {
+                subtree->emplace_back(objectPath, objects);
+            }
+
+            auto enumerate = std::make_shared<EnumerateStream>(
+                objectPath, std::move(*subtree));
+            crow::streaming::StreamOptions options;
+            options.contentType = "application/json";
+            options.maxQueuedBytes = enumerateMaxQueued;
+            options.overflowPolicy = crow::streaming::OverflowPolicy::close;
+            options.heartbeatInterval = std::chrono::seconds(0);
+            asyncResp->res.stream(
+                std::move(options),
+                [enumerate](crow::streaming::Connection &conn) {
+                    enumerate->start(conn);
+                },
+                [enumerate](crow::streaming::Connection &) {
+                    enumerate->stop();
+                });
         },
         "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetObject",
-        transaction->objectPath, std::array<const char *, 0>());
+        "xyz.openbmc_project.ObjectMapper", "GetObject", objectPath,
+        std::array<const char *, 0>());
 }
 
 // Structure for storing data on an in progress action
@@ -459,121 +642,53 @@ struct InProgressActionData
     nlohmann::json arguments;
 };
 
-std::vector<std::string> dbusArgSplit(const std::string &string)
+/**
+ * @brief Appends a JSON value as a basic D-Bus type, doing the conversions
+ * that make sense.  uint can be converted to int, int and uint to double.
+ */
+inline int appendBasicToDbus(sd_bus_message *m, char typeCode,
+                             const nlohmann::json &j)
 {
-    std::vector<std::string> ret;
-    if (string.empty())
+    const int64_t *intValue = j.get_ptr<const int64_t *>();
+    const uint64_t *uintValue = j.get_ptr<const uint64_t *>();
+    const std::string *stringValue = j.get_ptr<const std::string *>();
+    const double *doubleValue = j.get_ptr<const double *>();
+    const bool *b = j.get_ptr<const bool *>();
+    int64_t v = 0;
+    double d = 0.0;
+
+    if (uintValue != nullptr && intValue == nullptr)
     {
-        return ret;
+        v = static_cast<int64_t>(*uintValue);
+        intValue = &v;
     }
-    ret.push_back("");
-    int containerDepth = 0;
-
-    for (std::string::const_iterator character = string.begin();
-         character != string.end(); character++)
+    if (uintValue != nullptr && doubleValue == nullptr)
     {
-        ret.back() += *character;
-        switch (*character)
-        {
-            case ('a'):
-                break;
-            case ('('):
-            case ('{'):
-                containerDepth++;
-                break;
-            case ('}'):
-            case (')'):
-                containerDepth--;
-                if (containerDepth == 0)
-                {
-                    if (character + 1 != string.end())
-                    {
-                        ret.push_back("");
-                    }
-                }
-                break;
-            default:
-                if (containerDepth == 0)
-                {
-                    if (character + 1 != string.end())
-                    {
-                        ret.push_back("");
-                    }
-                }
-                break;
-        }
+        d = static_cast<double>(*uintValue);
+        doubleValue = &d;
+    }
+    if (intValue != nullptr && doubleValue == nullptr)
+    {
+        d = static_cast<double>(*intValue);
+        doubleValue = &d;
     }
 
-    return ret;
-}
-
-int convertJsonToDbus(sd_bus_message *m, const std::string &arg_type,
-                      const nlohmann::json &input_json)
-{
-    int r = 0;
-    BMCWEB_LOG_DEBUG << "Converting " << input_json.dump()
-                     << " to type: " << arg_type;
-    const std::vector<std::string> argTypes = dbusArgSplit(arg_type);
-
-    // Assume a single object for now.
-    const nlohmann::json *j = &input_json;
-    nlohmann::json::const_iterator jIt = input_json.begin();
-
-    for (const std::string &argCode : argTypes)
+    switch (typeCode)
     {
-        // If we are decoding multiple objects, grab the pointer to the
-        // iterator, and increment it for the next loop
-        if (argTypes.size() > 1)
+        case 's':
+        case 'o':
+        case 'g':
         {
-            if (jIt == input_json.end())
+            if (stringValue == nullptr)
             {
-                return -2;
+                return -1;
             }
-            j = &*jIt;
-            jIt++;
-        }
-        const int64_t *intValue = j->get_ptr<const int64_t *>();
-        const uint64_t *uintValue = j->get_ptr<const uint64_t *>();
-        const std::string *stringValue = j->get_ptr<const std::string *>();
-        const double *doubleValue = j->get_ptr<const double *>();
-        const bool *b = j->get_ptr<const bool *>();
-        int64_t v = 0;
-        double d = 0.0;
-
-        // Do some basic type conversions that make sense.  uint can be
-        // converted to int.  int and uint can be converted to double
-        if (uintValue != nullptr && intValue == nullptr)
-        {
-            v = static_cast<int64_t>(*uintValue);
-            intValue = &v;
-        }
-        if (uintValue != nullptr && doubleValue == nullptr)
-        {
-            d = static_cast<double>(*uintValue);
-            doubleValue = &d;
-        }
-        if (intValue != nullptr && doubleValue == nullptr)
-        {
-            d = static_cast<double>(*intValue);
-            doubleValue = &d;
+            return sd_bus_message_append_basic(m, typeCode,
+                                               stringValue->c_str());
         }
-
-        if (argCode == "s")
+        case 'i':
         {
-            if (stringValue == nullptr)
-            {
-                return -1;
-            }
-            r = sd_bus_message_append_basic(m, argCode[0],
-                                            (void *)stringValue->c_str());
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (argCode == "i")
-        {
-            if (intValue == nullptr)
+            if (intValue == nullptr)
             {
                 return -1;
             }
@@ -583,13 +698,9 @@ int convertJsonToDbus(sd_bus_message *m, const std::string &arg_type,
                 return -ERANGE;
             }
             int32_t i = static_cast<int32_t>(*intValue);
-            r = sd_bus_message_append_basic(m, argCode[0], &i);
-            if (r < 0)
-            {
-                return r;
-            }
+            return sd_bus_message_append_basic(m, typeCode, &i);
         }
-        else if (argCode == "b")
+        case 'b':
         {
             // lots of ways bool could be represented here.  Try them all
             int boolInt = false;
@@ -620,13 +731,9 @@ int convertJsonToDbus(sd_bus_message *m, const std::string &arg_type,
             {
                 return -1;
             }
-            r = sd_bus_message_append_basic(m, argCode[0], &boolInt);
-            if (r < 0)
-            {
-                return r;
-            }
+            return sd_bus_message_append_basic(m, typeCode, &boolInt);
         }
-        else if (argCode == "n")
+        case 'n':
         {
             if (intValue == nullptr)
             {
@@ -638,228 +745,265 @@ int convertJsonToDbus(sd_bus_message *m, const std::string &arg_type,
                 return -ERANGE;
             }
             int16_t n = static_cast<int16_t>(*intValue);
-            r = sd_bus_message_append_basic(m, argCode[0], &n);
-            if (r < 0)
-            {
-                return r;
-            }
+            return sd_bus_message_append_basic(m, typeCode, &n);
         }
-        else if (argCode == "x")
+        case 'x':
         {
             if (intValue == nullptr)
             {
                 return -1;
             }
-            if ((*intValue < std::numeric_limits<int64_t>::lowest()) ||
-                (*intValue > std::numeric_limits<int64_t>::max()))
-            {
-                return -ERANGE;
-            }
-            r = sd_bus_message_append_basic(m, argCode[0], intValue);
-            if (r < 0)
-            {
-                return r;
-            }
+            return sd_bus_message_append_basic(m, typeCode, intValue);
         }
-        else if (argCode == "y")
+        case 'y':
         {
             if (uintValue == nullptr)
             {
                 return -1;
             }
-            if ((*uintValue < std::numeric_limits<uint8_t>::lowest()) ||
-                (*uintValue > std::numeric_limits<uint8_t>::max()))
+            if (*uintValue > std::numeric_limits<uint8_t>::max())
             {
                 return -ERANGE;
             }
             uint8_t y = static_cast<uint8_t>(*uintValue);
-            r = sd_bus_message_append_basic(m, argCode[0], &y);
+            return sd_bus_message_append_basic(m, typeCode, &y);
         }
-        else if (argCode == "q")
+        case 'q':
         {
             if (uintValue == nullptr)
             {
                 return -1;
             }
-            if ((*uintValue < std::numeric_limits<uint16_t>::lowest()) ||
-                (*uintValue > std::numeric_limits<uint16_t>::max()))
+            if (*uintValue > std::numeric_limits<uint16_t>::max())
             {
                 return -ERANGE;
             }
             uint16_t q = static_cast<uint16_t>(*uintValue);
-            r = sd_bus_message_append_basic(m, argCode[0], &q);
+            return sd_bus_message_append_basic(m, typeCode, &q);
         }
-        else if (argCode == "u")
+        case 'u':
         {
             if (uintValue == nullptr)
             {
                 return -1;
             }
-            if ((*uintValue < std::numeric_limits<uint32_t>::lowest()) ||
-                (*uintValue > std::numeric_limits<uint32_t>::max()))
+            if (*uintValue > std::numeric_limits<uint32_t>::max())
             {
                 return -ERANGE;
             }
             uint32_t u = static_cast<uint32_t>(*uintValue);
-            r = sd_bus_message_append_basic(m, argCode[0], &u);
+            return sd_bus_message_append_basic(m, typeCode, &u);
         }
-        else if (argCode == "t")
+        case 't':
         {
             if (uintValue == nullptr)
             {
                 return -1;
             }
-            if ((*uintValue < std::numeric_limits<uint64_t>::lowest()) ||
-                (*uintValue > std::numeric_limits<uint64_t>::max()))
-            {
-                return -ERANGE;
-            }
-            r = sd_bus_message_append_basic(m, argCode[0], uintValue);
+            return sd_bus_message_append_basic(m, typeCode, uintValue);
         }
-        else if (argCode == "d")
+        case 'd':
         {
             if (doubleValue == nullptr)
             {
                 return -1;
             }
-            if ((*doubleValue < std::numeric_limits<double>::lowest()) ||
-                (*doubleValue > std::numeric_limits<double>::max()))
-            {
-                return -ERANGE;
-            }
-            sd_bus_message_append_basic(m, argCode[0], doubleValue);
+            return sd_bus_message_append_basic(m, typeCode, doubleValue);
         }
-        else if (boost::starts_with(argCode, "a"))
+        default:
+            return -2;
+    }
+}
+
+/**
+ * @brief Picks the D-Bus type a JSON value is sent as inside a variant
+ */
+inline const char *getVariantSignature(const nlohmann::json &j)
+{
+    switch (j.type())
+    {
+        case nlohmann::json::value_t::boolean:
+            return "b";
+        case nlohmann::json::value_t::string:
+            return "s";
+        case nlohmann::json::value_t::number_integer:
+            return "x";
+        case nlohmann::json::value_t::number_unsigned:
+            return j.get<uint64_t>() >
+                           static_cast<uint64_t>(
+                               std::numeric_limits<int64_t>::max())
+                       ? "t"
+                       : "x";
+        case nlohmann::json::value_t::number_float:
+            return "d";
+        default:
+            return nullptr;
+    }
+}
+
+int appendJsonToDbus(sd_bus_message *m, const dbus::signature::Type &type,
+                     const nlohmann::json &j)
+{
+    int r = 0;
+    switch (type.code)
+    {
+        case dbus::signature::arrayCode:
         {
-            std::string containedType = argCode.substr(1);
-            r = sd_bus_message_open_container(m, SD_BUS_TYPE_ARRAY,
-                                              containedType.c_str());
+            const dbus::signature::Type &element = type.children.front();
+            r = sd_bus_message_open_container(m, type.code,
+                                              type.contents.c_str());
             if (r < 0)
             {
                 return r;
             }
-
-            for (nlohmann::json::const_iterator it = j->begin(); it != j->end();
-                 ++it)
+            if (type.isDict())
             {
-                r = convertJsonToDbus(m, containedType, *it);
-                if (r < 0)
+                if (!j.is_object())
                 {
-                    return r;
+                    return -1;
+                }
+                for (const auto &item : j.items())
+                {
+                    r = sd_bus_message_open_container(
+                        m, element.code, element.contents.c_str());
+                    if (r < 0)
+                    {
+                        return r;
+                    }
+                    r = appendJsonToDbus(m, element.children[0], item.key());
+                    if (r < 0)
+                    {
+                        return r;
+                    }
+                    r = appendJsonToDbus(m, element.children[1],
+                                         item.value());
+                    if (r < 0)
+                    {
+                        return r;
+                    }
+                    r = sd_bus_message_close_container(m);
+                    if (r < 0)
+                    {
+                        return r;
+                    }
                 }
             }
-            sd_bus_message_close_container(m);
-        }
-        else if (boost::starts_with(argCode, "v"))
-        {
-            std::string containedType = argCode.substr(1);
-            BMCWEB_LOG_DEBUG << "variant type: " << argCode
-                             << " appending variant of type: " << containedType;
-            r = sd_bus_message_open_container(m, SD_BUS_TYPE_VARIANT,
-                                              containedType.c_str());
-            if (r < 0)
-            {
-                return r;
-            }
-
-            r = convertJsonToDbus(m, containedType, input_json);
-            if (r < 0)
-            {
-                return r;
-            }
-
-            r = sd_bus_message_close_container(m);
-            if (r < 0)
+            else
             {
-                return r;
+                if (!j.is_array())
+                {
+                    return -1;
+                }
+                for (const nlohmann::json &value : j)
+                {
+                    r = appendJsonToDbus(m, element, value);
+                    if (r < 0)
+                    {
+                        return r;
+                    }
+                }
             }
+            return sd_bus_message_close_container(m);
         }
-        else if (boost::starts_with(argCode, "(") &&
-                 boost::ends_with(argCode, ")"))
+        case dbus::signature::structCode:
         {
-            std::string containedType = argCode.substr(1, argCode.size() - 1);
-            r = sd_bus_message_open_container(m, SD_BUS_TYPE_STRUCT,
-                                              containedType.c_str());
+            if (!j.is_array() || j.size() < type.children.size())
+            {
+                return -1;
+            }
+            r = sd_bus_message_open_container(m, type.code,
+                                              type.contents.c_str());
             if (r < 0)
             {
                 return r;
             }
-
-            nlohmann::json::const_iterator it = j->begin();
-            for (const std::string &argCode : dbusArgSplit(arg_type))
+            nlohmann::json::const_iterator it = j.begin();
+            for (const dbus::signature::Type &member : type.children)
             {
-                if (it == j->end())
-                {
-                    return -1;
-                }
-                r = convertJsonToDbus(m, argCode, *it);
+                r = appendJsonToDbus(m, member, *it);
                 if (r < 0)
                 {
                     return r;
                 }
                 it++;
             }
-            r = sd_bus_message_close_container(m);
+            return sd_bus_message_close_container(m);
         }
-        else if (boost::starts_with(argCode, "{") &&
-                 boost::ends_with(argCode, "}"))
+        case dbus::signature::variantCode:
         {
-            std::string containedType = argCode.substr(1, argCode.size() - 1);
-            r = sd_bus_message_open_container(m, SD_BUS_TYPE_DICT_ENTRY,
-                                              containedType.c_str());
-            if (r < 0)
+            const char *contents = getVariantSignature(j);
+            if (contents == nullptr)
             {
-                return r;
+                return -2;
             }
-
-            std::vector<std::string> codes = dbusArgSplit(containedType);
-            if (codes.size() != 2)
+            BMCWEB_LOG_DEBUG << "appending variant of type: " << contents;
+            r = sd_bus_message_open_container(m, type.code, contents);
+            if (r < 0)
             {
-                return -1;
+                return r;
             }
-            const std::string &key_type = codes[0];
-            const std::string &value_type = codes[1];
-            for (auto it : j->items())
+            r = appendBasicToDbus(m, contents[0], j);
+            if (r < 0)
             {
-                r = convertJsonToDbus(m, key_type, it.key());
-                if (r < 0)
-                {
-                    return r;
-                }
-
-                r = convertJsonToDbus(m, value_type, it.value());
-                if (r < 0)
-                {
-                    return r;
-                }
+                return r;
             }
-            r = sd_bus_message_close_container(m);
+            return sd_bus_message_close_container(m);
         }
-        else
+        default:
+            return appendBasicToDbus(m, type.code, j);
+    }
+}
+
+/**
+ * @brief Appends JSON to a message as the given signature
+ *
+ * A signature of more than one complete type takes a JSON array with a value
+ * for each.
+ */
+int convertJsonToDbus(sd_bus_message *m, const std::string &arg_type,
+                      const nlohmann::json &input_json)
+{
+    BMCWEB_LOG_DEBUG << "Converting " << input_json.dump()
+                     << " to type: " << arg_type;
+    std::shared_ptr<const dbus::signature::Plan> plan =
+        dbus::signature::getPlan(arg_type);
+    if (plan == nullptr)
+    {
+        return -2;
+    }
+    if (plan->size() == 1)
+    {
+        return appendJsonToDbus(m, plan->front(), input_json);
+    }
+
+    if (!input_json.is_array())
+    {
+        return -2;
+    }
+    nlohmann::json::const_iterator jIt = input_json.begin();
+    for (const dbus::signature::Type &type : *plan)
+    {
+        if (jIt == input_json.end())
         {
             return -2;
         }
+        int r = appendJsonToDbus(m, type, *jIt);
         if (r < 0)
         {
             return r;
         }
-
-        if (argTypes.size() > 1)
-        {
-            jIt++;
-        }
+        jIt++;
     }
-
-    return r;
+    return 0;
 }
 
 template <typename T>
-int readMessageItem(const std::string &typeCode, sdbusplus::message::message &m,
+int readMessageItem(char typeCode, sdbusplus::message::message &m,
                     nlohmann::json &data)
 {
     T value;
 
-    int r = sd_bus_message_read_basic(m.get(), typeCode.front(), &value);
+    int r = sd_bus_message_read_basic(m.get(), typeCode, &value);
     if (r < 0)
     {
         BMCWEB_LOG_ERROR << "sd_bus_message_read_basic on type " << typeCode
@@ -871,23 +1015,15 @@ int readMessageItem(const std::string &typeCode, sdbusplus::message::message &m,
     return 0;
 }
 
-int convertDBusToJSON(const std::string &returnType,
-                      sdbusplus::message::message &m, nlohmann::json &response);
+int readDbusToJson(const dbus::signature::Type &type,
+                   sdbusplus::message::message &m, nlohmann::json &data);
 
-int readDictEntryFromMessage(const std::string &typeCode,
+int readDictEntryFromMessage(const dbus::signature::Type &type,
                              sdbusplus::message::message &m,
                              nlohmann::json &object)
 {
-    std::vector<std::string> types = dbusArgSplit(typeCode);
-    if (types.size() != 2)
-    {
-        BMCWEB_LOG_ERROR << "wrong number contained types in dictionary: "
-                         << types.size();
-        return -1;
-    }
-
-    int r = sd_bus_message_enter_container(m.get(), SD_BUS_TYPE_DICT_ENTRY,
-                                           typeCode.c_str());
+    int r = sd_bus_message_enter_container(m.get(), type.code,
+                                           type.contents.c_str());
     if (r < 0)
     {
         BMCWEB_LOG_ERROR << "sd_bus_message_enter_container with rc " << r;
@@ -895,7 +1031,7 @@ int readDictEntryFromMessage(const std::string &typeCode,
     }
 
     nlohmann::json key;
-    r = convertDBusToJSON(types[0], m, key);
+    r = readDbusToJson(type.children[0], m, key);
     if (r < 0)
     {
         return r;
@@ -917,7 +1053,7 @@ int readDictEntryFromMessage(const std::string &typeCode,
     }
     nlohmann::json &value = object[*keyPtr];
 
-    r = convertDBusToJSON(types[1], m, value);
+    r = readDbusToJson(type.children[1], m, value);
     if (r < 0)
     {
         return r;
@@ -933,20 +1069,11 @@ int readDictEntryFromMessage(const std::string &typeCode,
     return 0;
 }
 
-int readArrayFromMessage(const std::string &typeCode,
+int readArrayFromMessage(const dbus::signature::Type &type,
                          sdbusplus::message::message &m, nlohmann::json &data)
 {
-    if (typeCode.size() < 2)
-    {
-        BMCWEB_LOG_ERROR << "Type code " << typeCode
-                         << " too small for an array";
-        return -1;
-    }
-
-    std::string containedType = typeCode.substr(1);
-
-    int r = sd_bus_message_enter_container(m.get(), SD_BUS_TYPE_ARRAY,
-                                           containedType.c_str());
+    int r = sd_bus_message_enter_container(m.get(), type.code,
+                                           type.contents.c_str());
     if (r < 0)
     {
         BMCWEB_LOG_ERROR << "sd_bus_message_enter_container failed with rc "
@@ -954,13 +1081,10 @@ int readArrayFromMessage(const std::string &typeCode,
         return r;
     }
 
-    bool dict = boost::starts_with(containedType, "{") &&
-                boost::ends_with(containedType, "}");
-
+    // Dictionaries are only ever seen in an array
+    bool dict = type.isDict();
     if (dict)
     {
-        // Remove the { }
-        containedType = containedType.substr(1, containedType.size() - 2);
         data = nlohmann::json::object();
     }
     else
@@ -968,6 +1092,7 @@ int readArrayFromMessage(const std::string &typeCode,
         data = nlohmann::json::array();
     }
 
+    const dbus::signature::Type &element = type.children.front();
     while (true)
     {
         r = sd_bus_message_at_end(m.get(), false);
@@ -982,24 +1107,18 @@ int readArrayFromMessage(const std::string &typeCode,
             break;
         }
 
-        // Dictionaries are only ever seen in an array
         if (dict)
         {
-            r = readDictEntryFromMessage(containedType, m, data);
-            if (r < 0)
-            {
-                return r;
-            }
+            r = readDictEntryFromMessage(element, m, data);
         }
         else
         {
             data.push_back(nlohmann::json());
-
-            r = convertDBusToJSON(containedType, m, data.back());
-            if (r < 0)
-            {
-                return r;
-            }
+            r = readDbusToJson(element, m, data.back());
+        }
+        if (r < 0)
+        {
+            return r;
         }
     }
 
@@ -1013,21 +1132,11 @@ int readArrayFromMessage(const std::string &typeCode,
     return 0;
 }
 
-int readStructFromMessage(const std::string &typeCode,
+int readStructFromMessage(const dbus::signature::Type &type,
                           sdbusplus::message::message &m, nlohmann::json &data)
 {
-    if (typeCode.size() < 3)
-    {
-        BMCWEB_LOG_ERROR << "Type code " << typeCode
-                         << " too small for a struct";
-        return -1;
-    }
-
-    std::string containedTypes = typeCode.substr(1, typeCode.size() - 2);
-    std::vector<std::string> types = dbusArgSplit(containedTypes);
-
-    int r = sd_bus_message_enter_container(m.get(), SD_BUS_TYPE_STRUCT,
-                                           containedTypes.c_str());
+    int r = sd_bus_message_enter_container(m.get(), type.code,
+                                           type.contents.c_str());
     if (r < 0)
     {
         BMCWEB_LOG_ERROR << "sd_bus_message_enter_container failed with rc "
@@ -1035,10 +1144,10 @@ int readStructFromMessage(const std::string &typeCode,
         return r;
     }
 
-    for (const std::string &type : types)
+    for (const dbus::signature::Type &member : type.children)
     {
         data.push_back(nlohmann::json());
-        r = convertDBusToJSON(type, m, data.back());
+        r = readDbusToJson(member, m, data.back());
         if (r < 0)
         {
             return r;
@@ -1064,6 +1173,14 @@ int readVariantFromMessage(sdbusplus::message::message &m, nlohmann::json &data)
         return r;
     }
 
+    std::shared_ptr<const dbus::signature::Plan> plan =
+        dbus::signature::getPlan(containerType);
+    if (plan == nullptr || plan->size() != 1)
+    {
+        BMCWEB_LOG_ERROR << "Invalid variant signature " << containerType;
+        return -2;
+    }
+
     r = sd_bus_message_enter_container(m.get(), SD_BUS_TYPE_VARIANT,
                                        containerType);
     if (r < 0)
@@ -1073,7 +1190,7 @@ int readVariantFromMessage(sdbusplus::message::message &m, nlohmann::json &data)
         return r;
     }
 
-    r = convertDBusToJSON(containerType, m, data);
+    r = readDbusToJson(plan->front(), m, data);
     if (r < 0)
     {
         return r;
@@ -1089,207 +1206,136 @@ int readVariantFromMessage(sdbusplus::message::message &m, nlohmann::json &data)
     return 0;
 }
 
+int readDbusToJson(const dbus::signature::Type &type,
+                   sdbusplus::message::message &m, nlohmann::json &data)
+{
+    switch (type.code)
+    {
+        case 's':
+        case 'g':
+        case 'o':
+            return readMessageItem<char *>(type.code, m, data);
+        case 'b':
+        {
+            int r = readMessageItem<int>(type.code, m, data);
+            if (r < 0)
+            {
+                return r;
+            }
+            data = static_cast<bool>(data.get<int>());
+            return 0;
+        }
+        case 'u':
+            return readMessageItem<uint32_t>(type.code, m, data);
+        case 'i':
+            return readMessageItem<int32_t>(type.code, m, data);
+        case 'x':
+            return readMessageItem<int64_t>(type.code, m, data);
+        case 't':
+            return readMessageItem<uint64_t>(type.code, m, data);
+        case 'n':
+            return readMessageItem<int16_t>(type.code, m, data);
+        case 'q':
+            return readMessageItem<uint16_t>(type.code, m, data);
+        case 'y':
+            return readMessageItem<uint8_t>(type.code, m, data);
+        case 'd':
+            return readMessageItem<double>(type.code, m, data);
+        case 'h':
+            return readMessageItem<int>(type.code, m, data);
+        case dbus::signature::arrayCode:
+            return readArrayFromMessage(type, m, data);
+        case dbus::signature::structCode:
+            return readStructFromMessage(type, m, data);
+        case dbus::signature::variantCode:
+            return readVariantFromMessage(m, data);
+        default:
+            BMCWEB_LOG_ERROR << "Invalid D-Bus type " << type.code;
+            return -2;
+    }
+}
+
+/**
+ * @brief Reads a message as the given signature
+ *
+ * A signature of more than one complete type is read into a JSON array with
+ * a value for each.
+ */
 int convertDBusToJSON(const std::string &returnType,
                       sdbusplus::message::message &m, nlohmann::json &response)
 {
-    int r = 0;
-    const std::vector<std::string> returnTypes = dbusArgSplit(returnType);
+    std::shared_ptr<const dbus::signature::Plan> plan =
+        dbus::signature::getPlan(returnType);
+    if (plan == nullptr)
+    {
+        BMCWEB_LOG_ERROR << "Invalid D-Bus signature " << returnType;
+        return -2;
+    }
 
-    for (const std::string &typeCode : returnTypes)
+    for (const dbus::signature::Type &type : *plan)
     {
         nlohmann::json *thisElement = &response;
-        if (returnTypes.size() > 1)
+        if (plan->size() > 1)
         {
             response.push_back(nlohmann::json{});
             thisElement = &response.back();
         }
 
-        if (typeCode == "s")
-        {
-            r = readMessageItem<char *>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "g")
-        {
-            r = readMessageItem<char *>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "o")
+        int r = readDbusToJson(type, m, *thisElement);
+        if (r < 0)
         {
-            r = readMessageItem<char *>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
+            return r;
         }
-        else if (typeCode == "b")
-        {
-            r = readMessageItem<int>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
+    }
 
-            *thisElement = static_cast<bool>(thisElement->get<int>());
-        }
-        else if (typeCode == "u")
+    return 0;
+}
+
+void handleMethodResponse(std::shared_ptr<InProgressActionData> transaction,
+                          sdbusplus::message::message &m,
+                          const std::string &returnType)
+{
+    nlohmann::json data;
+
+    int r = convertDBusToJSON(returnType, m, data);
+    if (r < 0)
+    {
+        transaction->outputFailed = true;
+        return;
+    }
+
+    if (data.is_null())
+    {
+        return;
+    }
+
+    if (transaction->methodResponse.is_null())
+    {
+        transaction->methodResponse = std::move(data);
+        return;
+    }
+
+    // If they're both dictionaries or arrays, merge into one.
+    // Otherwise, make the results an array with every result
+    // an entry.  Could also just fail in that case, but it
+    // seems better to get the data back somehow.
+
+    if (transaction->methodResponse.is_object() && data.is_object())
+    {
+        for (const auto &obj : data.items())
         {
-            r = readMessageItem<uint32_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
+            // Note: Will overwrite the data for a duplicate key
+            transaction->methodResponse.emplace(obj.key(),
+                                                std::move(obj.value()));
         }
-        else if (typeCode == "i")
+        return;
+    }
+
+    if (transaction->methodResponse.is_array() && data.is_array())
+    {
+        for (auto &obj : data)
         {
-            r = readMessageItem<int32_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "x")
-        {
-            r = readMessageItem<int64_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "t")
-        {
-            r = readMessageItem<uint64_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "n")
-        {
-            r = readMessageItem<int16_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "q")
-        {
-            r = readMessageItem<uint16_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "y")
-        {
-            r = readMessageItem<uint8_t>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "d")
-        {
-            r = readMessageItem<double>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (typeCode == "h")
-        {
-            r = readMessageItem<int>(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (boost::starts_with(typeCode, "a"))
-        {
-            r = readArrayFromMessage(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (boost::starts_with(typeCode, "(") &&
-                 boost::ends_with(typeCode, ")"))
-        {
-            r = readStructFromMessage(typeCode, m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else if (boost::starts_with(typeCode, "v"))
-        {
-            r = readVariantFromMessage(m, *thisElement);
-            if (r < 0)
-            {
-                return r;
-            }
-        }
-        else
-        {
-            BMCWEB_LOG_ERROR << "Invalid D-Bus signature type " << typeCode;
-            return -2;
-        }
-    }
-
-    return 0;
-}
-
-void handleMethodResponse(std::shared_ptr<InProgressActionData> transaction,
-                          sdbusplus::message::message &m,
-                          const std::string &returnType)
-{
-    nlohmann::json data;
-
-    int r = convertDBusToJSON(returnType, m, data);
-    if (r < 0)
-    {
-        transaction->outputFailed = true;
-        return;
-    }
-
-    if (data.is_null())
-    {
-        return;
-    }
-
-    if (transaction->methodResponse.is_null())
-    {
-        transaction->methodResponse = std::move(data);
-        return;
-    }
-
-    // If they're both dictionaries or arrays, merge into one.
-    // Otherwise, make the results an array with every result
-    // an entry.  Could also just fail in that case, but it
-    // seems better to get the data back somehow.
-
-    if (transaction->methodResponse.is_object() && data.is_object())
-    {
-        for (const auto &obj : data.items())
-        {
-            // Note: Will overwrite the data for a duplicate key
-            transaction->methodResponse.emplace(obj.key(),
-                                                std::move(obj.value()));
-        }
-        return;
-    }
-
-    if (transaction->methodResponse.is_array() && data.is_array())
-    {
-        for (auto &obj : data)
-        {
-            transaction->methodResponse.push_back(std::move(obj));
+            transaction->methodResponse.push_back(std::move(obj));
         }
         return;
     }
@@ -1314,169 +1360,98 @@ void findActionOnInterface(std::shared_ptr<InProgressActionData> transaction,
 {
     BMCWEB_LOG_DEBUG << "findActionOnInterface for connection "
                      << connectionName;
-    crow::connections::systemBus->async_method_call(
+    dbus::introspection::Cache::getInstance().get(
+        connectionName, transaction->path,
         [transaction, connectionName{std::string(connectionName)}](
             const boost::system::error_code ec,
-            const std::string &introspect_xml) {
-            BMCWEB_LOG_DEBUG << "got xml:\n " << introspect_xml;
-            if (ec)
-            {
-                BMCWEB_LOG_ERROR
-                    << "Introspect call failed with error: " << ec.message()
-                    << " on process: " << connectionName << "\n";
-                return;
-            }
-            tinyxml2::XMLDocument doc;
-
-            doc.Parse(introspect_xml.data(), introspect_xml.size());
-            tinyxml2::XMLNode *pRoot = doc.FirstChildElement("node");
-            if (pRoot == nullptr)
+            const std::shared_ptr<const dbus::introspection::Node> &node) {
+            if (ec || node == nullptr)
             {
-                BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                 << connectionName << "\n";
                 return;
             }
-            tinyxml2::XMLElement *interfaceNode =
-                pRoot->FirstChildElement("interface");
-            while (interfaceNode != nullptr)
+            for (const dbus::introspection::Interface &interface :
+                 node->interfaces)
             {
-                const char *thisInterfaceName =
-                    interfaceNode->Attribute("name");
-                if (thisInterfaceName != nullptr)
+                if (!transaction->interfaceName.empty() &&
+                    (transaction->interfaceName != interface.name))
                 {
-                    if (!transaction->interfaceName.empty() &&
-                        (transaction->interfaceName != thisInterfaceName))
+                    continue;
+                }
+
+                for (const dbus::introspection::Method &method :
+                     interface.methods)
+                {
+                    if (method.name != transaction->methodName)
                     {
-                        interfaceNode =
-                            interfaceNode->NextSiblingElement("interface");
                         continue;
                     }
+                    BMCWEB_LOG_DEBUG << "Found method named " << method.name
+                                     << " on interface " << interface.name;
+                    sdbusplus::message::message m =
+                        crow::connections::systemBus->new_method_call(
+                            connectionName.c_str(), transaction->path.c_str(),
+                            interface.name.c_str(),
+                            transaction->methodName.c_str());
+
+                    nlohmann::json::const_iterator argIt =
+                        transaction->arguments.begin();
 
-                    tinyxml2::XMLElement *methodNode =
-                        interfaceNode->FirstChildElement("method");
-                    while (methodNode != nullptr)
+                    for (const std::string &argType : method.inTypes)
                     {
-                        const char *thisMethodName =
-                            methodNode->Attribute("name");
-                        BMCWEB_LOG_DEBUG << "Found method: " << thisMethodName;
-                        if (thisMethodName != nullptr &&
-                            thisMethodName == transaction->methodName)
+                        if (argIt == transaction->arguments.end())
                         {
-                            BMCWEB_LOG_DEBUG
-                                << "Found method named " << thisMethodName
-                                << " on interface " << thisInterfaceName;
-                            sdbusplus::message::message m =
-                                crow::connections::systemBus->new_method_call(
-                                    connectionName.c_str(),
-                                    transaction->path.c_str(),
-                                    thisInterfaceName,
-                                    transaction->methodName.c_str());
-
-                            tinyxml2::XMLElement *argumentNode =
-                                methodNode->FirstChildElement("arg");
+                            transaction->setErrorStatus("Invalid method args");
+                            return;
+                        }
+                        if (convertJsonToDbus(m.get(), argType, *argIt) < 0)
+                        {
+                            transaction->setErrorStatus(
+                                "Invalid method arg type");
+                            return;
+                        }
 
-                            std::string returnType;
+                        argIt++;
+                    }
 
-                            // Find the output type
-                            while (argumentNode != nullptr)
+                    crow::connections::systemBus->async_send(
+                        m, [transaction, returnType{method.returnType}](
+                               boost::system::error_code ec,
+                               sdbusplus::message::message &m) {
+                            if (ec)
                             {
-                                const char *argDirection =
-                                    argumentNode->Attribute("direction");
-                                const char *argType =
-                                    argumentNode->Attribute("type");
-                                if (argDirection != nullptr &&
-                                    argType != nullptr &&
-                                    std::string(argDirection) == "out")
+                                transaction->methodFailed = true;
+                                const sd_bus_error *e = m.get_error();
+
+                                if (e)
                                 {
-                                    returnType = argType;
-                                    break;
+                                    setErrorResponse(
+                                        transaction->res,
+                                        boost::beast::http::status::
+                                            bad_request,
+                                        e->name, e->message);
                                 }
-                                argumentNode =
-                                    argumentNode->NextSiblingElement("arg");
-                            }
-
-                            nlohmann::json::const_iterator argIt =
-                                transaction->arguments.begin();
-
-                            argumentNode = methodNode->FirstChildElement("arg");
-
-                            while (argumentNode != nullptr)
-                            {
-                                const char *argDirection =
-                                    argumentNode->Attribute("direction");
-                                const char *argType =
-                                    argumentNode->Attribute("type");
-                                if (argDirection != nullptr &&
-                                    argType != nullptr &&
-                                    std::string(argDirection) == "in")
+                                else
                                 {
-                                    if (argIt == transaction->arguments.end())
-                                    {
-                                        transaction->setErrorStatus(
-                                            "Invalid method args");
-                                        return;
-                                    }
-                                    if (convertJsonToDbus(m.get(),
-                                                          std::string(argType),
-                                                          *argIt) < 0)
-                                    {
-                                        transaction->setErrorStatus(
-                                            "Invalid method arg type");
-                                        return;
-                                    }
-
-                                    argIt++;
+                                    setErrorResponse(
+                                        transaction->res,
+                                        boost::beast::http::status::
+                                            bad_request,
+                                        "Method call failed",
+                                        methodFailedMsg);
                                 }
-                                argumentNode =
-                                    argumentNode->NextSiblingElement("arg");
+                                return;
+                            }
+                            else
+                            {
+                                transaction->methodPassed = true;
                             }
 
-                            crow::connections::systemBus->async_send(
-                                m, [transaction, returnType](
-                                       boost::system::error_code ec,
-                                       sdbusplus::message::message &m) {
-                                    if (ec)
-                                    {
-                                        transaction->methodFailed = true;
-                                        const sd_bus_error *e = m.get_error();
-
-                                        if (e)
-                                        {
-                                            setErrorResponse(
-                                                transaction->res,
-                                                boost::beast::http::status::
-                                                    bad_request,
-                                                e->name, e->message);
-                                        }
-                                        else
-                                        {
-                                            setErrorResponse(
-                                                transaction->res,
-                                                boost::beast::http::status::
-                                                    bad_request,
-                                                "Method call failed",
-                                                methodFailedMsg);
-                                        }
-                                        return;
-                                    }
-                                    else
-                                    {
-                                        transaction->methodPassed = true;
-                                    }
-
-                                    handleMethodResponse(transaction, m,
-                                                         returnType);
-                                });
-                            break;
-                        }
-                        methodNode = methodNode->NextSiblingElement("method");
-                    }
+                            handleMethodResponse(transaction, m, returnType);
+                        });
+                    break;
                 }
-                interfaceNode = interfaceNode->NextSiblingElement("interface");
             }
-        },
-        connectionName, transaction->path,
-        "org.freedesktop.DBus.Introspectable", "Introspect");
+        });
 }
 
 void handleAction(const crow::Request &req, crow::Response &res,
@@ -1611,24 +1586,13 @@ void handleEnumerate(crow::Response &res, const std::string &objectPath)
     BMCWEB_LOG_DEBUG << "Doing enumerate on " << objectPath;
     auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
 
-    asyncResp->res.jsonValue = {{"message", "200 OK"},
-                                {"status", "ok"},
-                                {"data", nlohmann::json::object()}};
-
     crow::connections::systemBus->async_method_call(
         [objectPath, asyncResp](const boost::system::error_code ec,
                                 GetSubTreeType &object_names) {
-            auto transaction = std::make_shared<InProgressEnumerateData>(
-                objectPath, asyncResp);
-
-            transaction->subtree =
-                std::make_shared<GetSubTreeType>(std::move(object_names));
-
             if (ec)
             {
-                BMCWEB_LOG_ERROR << "GetSubTree failed on "
-                                 << transaction->objectPath;
-                setErrorResponse(transaction->asyncResp->res,
+                BMCWEB_LOG_ERROR << "GetSubTree failed on " << objectPath;
+                setErrorResponse(asyncResp->res,
                                  boost::beast::http::status::not_found,
                                  notFoundDesc, notFoundMsg);
                 return;
@@ -1636,7 +1600,10 @@ void handleEnumerate(crow::Response &res, const std::string &objectPath)
 
             // Add the data for the path passed in to the results
             // as if GetSubTree returned it, and continue on enumerating
-            getObjectAndEnumerate(transaction);
+            getObjectAndEnumerate(
+                objectPath,
+                std::make_shared<GetSubTreeType>(std::move(object_names)),
+                asyncResp);
         },
         "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
@@ -1702,290 +1669,688 @@ void handleGet(crow::Response &res, std::string &objectPath,
                             }
                             else
                             {
-                                nlohmann::json properties;
-                                int r =
-                                    convertDBusToJSON("a{sv}", msg, properties);
-                                if (r < 0)
-                                {
-                                    BMCWEB_LOG_ERROR
-                                        << "convertDBusToJSON failed";
-                                }
-                                else
+                                nlohmann::json properties;
+                                int r =
+                                    convertDBusToJSON("a{sv}", msg, properties);
+                                if (r < 0)
+                                {
+                                    BMCWEB_LOG_ERROR
+                                        << "convertDBusToJSON failed";
+                                }
+                                else
+                                {
+                                    for (auto &prop : properties.items())
+                                    {
+                                        // if property name is empty, or
+                                        // matches our search query, add it
+                                        // to the response json
+
+                                        if (propertyName->empty())
+                                        {
+                                            (*response)[prop.key()] =
+                                                std::move(prop.value());
+                                        }
+                                        else if (prop.key() == *propertyName)
+                                        {
+                                            *response = std::move(prop.value());
+                                        }
+                                    }
+                                }
+                            }
+                            if (response.use_count() == 1)
+                            {
+                                if (!propertyName->empty() && response->empty())
+                                {
+                                    setErrorResponse(
+                                        res,
+                                        boost::beast::http::status::not_found,
+                                        propNotFoundDesc, notFoundMsg);
+                                }
+                                else
+                                {
+                                    res.jsonValue = {{"status", "ok"},
+                                                     {"message", "200 OK"},
+                                                     {"data", *response}};
+                                }
+                                res.end();
+                            }
+                        });
+                }
+            }
+        },
+        "xyz.openbmc_project.ObjectMapper",
+        "/xyz/openbmc_project/object_mapper",
+        "xyz.openbmc_project.ObjectMapper", "GetObject", *path,
+        std::array<std::string, 0>());
+}
+
+struct AsyncPutRequest
+{
+    AsyncPutRequest(crow::Response &res) : res(res)
+    {
+    }
+    ~AsyncPutRequest()
+    {
+        if (res.jsonValue.empty())
+        {
+            setErrorResponse(res, boost::beast::http::status::forbidden,
+                             forbiddenMsg, forbiddenPropDesc);
+        }
+
+        res.end();
+    }
+
+    void setErrorStatus(const std::string &desc)
+    {
+        setErrorResponse(res, boost::beast::http::status::internal_server_error,
+                         desc, badReqMsg);
+    }
+
+    crow::Response &res;
+    std::string objectPath;
+    std::string propertyName;
+    nlohmann::json propertyValue;
+};
+
+/**
+ * @brief Appends a property value to a Properties.Set call, converting the
+ * JSON value to the property's D-Bus type
+ *
+ * @return nullptr on success, otherwise a description of the error
+ */
+inline const char *appendPropertyValue(sdbusplus::message::message &m,
+                                       const std::string &argType,
+                                       const nlohmann::json &value)
+{
+    int r = sd_bus_message_open_container(m.get(), SD_BUS_TYPE_VARIANT,
+                                          argType.c_str());
+    if (r < 0)
+    {
+        return "Unexpected Error";
+    }
+    r = convertJsonToDbus(m.get(), argType, value);
+    if (r < 0)
+    {
+        if (r == -ERANGE)
+        {
+            return "Provided property value "
+                   "is out of range for the "
+                   "property type";
+        }
+        return "Invalid arg type";
+    }
+    r = sd_bus_message_close_container(m.get());
+    if (r < 0)
+    {
+        return "Unexpected Error";
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Sets a property of the object being PUT
+ */
+inline void setProperty(const std::shared_ptr<AsyncPutRequest> &transaction,
+                        const std::string &connectionName,
+                        const std::string &interfaceName,
+                        const std::string &argType)
+{
+    sdbusplus::message::message m =
+        crow::connections::systemBus->new_method_call(
+            connectionName.c_str(), transaction->objectPath.c_str(),
+            "org.freedesktop.DBus.Properties", "Set");
+    m.append(interfaceName, transaction->propertyName);
+    const char *error =
+        appendPropertyValue(m, argType, transaction->propertyValue);
+    if (error != nullptr)
+    {
+        transaction->setErrorStatus(error);
+        return;
+    }
+    crow::connections::systemBus->async_send(
+        m, [transaction](boost::system::error_code ec,
+                         sdbusplus::message::message &m) {
+            BMCWEB_LOG_DEBUG << "sent";
+            if (ec)
+            {
+                const sd_bus_error *e = m.get_error();
+                setErrorResponse(
+                    transaction->res, boost::beast::http::status::forbidden,
+                    (e) ? e->name : ec.category().name(),
+                    (e) ? e->message : ec.message());
+            }
+            else
+            {
+                transaction->res.jsonValue = {
+                    {"status", "ok"}, {"message", "200 OK"}, {"data", nullptr}};
+            }
+        });
+}
+
+void handlePut(const crow::Request &req, crow::Response &res,
+               const std::string &objectPath, const std::string &destProperty)
+{
+    if (destProperty.empty())
+    {
+        setErrorResponse(res, boost::beast::http::status::forbidden,
+                         forbiddenResDesc, forbiddenMsg);
+        res.end();
+        return;
+    }
+
+    nlohmann::json requestDbusData =
+        nlohmann::json::parse(req.body, nullptr, false);
+
+    if (requestDbusData.is_discarded())
+    {
+        setErrorResponse(res, boost::beast::http::status::bad_request,
+                         noJsonDesc, badReqMsg);
+        res.end();
+        return;
+    }
+
+    nlohmann::json::const_iterator propertyIt = requestDbusData.find("data");
+    if (propertyIt == requestDbusData.end())
+    {
+        setErrorResponse(res, boost::beast::http::status::bad_request,
+                         noJsonDesc, badReqMsg);
+        res.end();
+        return;
+    }
+    const nlohmann::json &propertySetValue = *propertyIt;
+    auto transaction = std::make_shared<AsyncPutRequest>(res);
+    transaction->objectPath = objectPath;
+    transaction->propertyName = destProperty;
+    transaction->propertyValue = propertySetValue;
+
+    using GetObjectType =
+        std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+    crow::connections::systemBus->async_method_call(
+        [transaction](const boost::system::error_code ec,
+                      const GetObjectType &object_names) {
+            if (!ec && object_names.size() <= 0)
+            {
+                setErrorResponse(transaction->res,
+                                 boost::beast::http::status::not_found,
+                                 propNotFoundDesc, notFoundMsg);
+                return;
+            }
+
+            for (const std::pair<std::string, std::vector<std::string>>
+                     connection : object_names)
+            {
+                const std::string &connectionName = connection.first;
+
+                dbus::introspection::Cache::getInstance().get(
+                    connectionName, transaction->objectPath,
+                    [connectionName{std::string(connectionName)},
+                     transaction](const boost::system::error_code ec,
+                                  const std::shared_ptr<
+                                      const dbus::introspection::Node> &node) {
+                        if (ec || node == nullptr)
+                        {
+                            transaction->setErrorStatus("Unexpected Error");
+                            return;
+                        }
+                        for (const dbus::introspection::Interface &interface :
+                             node->interfaces)
+                        {
+                            for (const dbus::introspection::Property
+                                     &property : interface.properties)
+                            {
+                                if (property.name != transaction->propertyName)
+                                {
+                                    continue;
+                                }
+                                setProperty(transaction, connectionName,
+                                            interface.name, property.type);
+                            }
+                        }
+                    });
+            }
+        },
+        "xyz.openbmc_project.ObjectMapper",
+        "/xyz/openbmc_project/object_mapper",
+        "xyz.openbmc_project.ObjectMapper", "GetObject",
+        transaction->objectPath, std::array<std::string, 0>());
+}
+
+struct BatchRequest;
+
+/**
+ * @brief One operation of a batch request in progress, which hands its result
+ * to the batch once nothing refers to it anymore
+ */
+struct BatchOperation
+{
+    BatchOperation(const std::shared_ptr<BatchRequest> &batch, size_t index);
+    ~BatchOperation();
+
+    BatchOperation(const BatchOperation &) = delete;
+    BatchOperation &operator=(const BatchOperation &) = delete;
+
+    void setError(const std::string &desc, const std::string &msg)
+    {
+        result = makeBatchError(desc, msg);
+    }
+
+    std::shared_ptr<BatchRequest> batch;
+    size_t index;
+    const BatchItem &item;
+    // Properties read by a get
+    nlohmann::json data = nlohmann::json::object();
+    bool found = false;
+    // Set on error, or once a set succeeds
+    nlohmann::json result;
+};
+
+/**
+ * @brief A batch of property gets and sets, run a few at a time
+ *
+ * Each operation is answered the same way as the matching GET or PUT on
+ * /xyz/<path>/attr/<property>, and the response holds the answers in the
+ * order the operations were given.  Operations on the same object share a
+ * single mapper lookup, and property types come from the introspection
+ * cache.
+ */
+struct BatchRequest : std::enable_shared_from_this<BatchRequest>
+{
+    using GetObjectType =
+        std::vector<std::pair<std::string, std::vector<std::string>>>;
+    using ObjectCallback = std::function<void(const boost::system::error_code &,
+                                              const GetObjectType &)>;
+
+    BatchRequest(crow::Response &res) : res(res)
+    {
+    }
+
+    ~BatchRequest()
+    {
+        res.jsonValue = {{"status", "ok"},
+                         {"message", "200 OK"},
+                         {"data", std::move(results)}};
+        res.end();
+    }
+
+    BatchRequest(const BatchRequest &) = delete;
+    BatchRequest &operator=(const BatchRequest &) = delete;
+
+    /**
+     * @brief Starts operations until the concurrency limit is reached
+     */
+    void pump()
+    {
+        while (inFlight < batchMaxConcurrent && next < items.size())
+        {
+            inFlight++;
+            start(std::make_shared<BatchOperation>(shared_from_this(), next++));
+        }
+    }
+
+    void finish(size_t index, nlohmann::json &&result)
+    {
+        results[index] = std::move(result);
+        inFlight--;
+        pump();
+    }
+
+    /**
+     * @brief Looks an object up in the mapper, once per batch
+     */
+    void getObject(const std::string &path, ObjectCallback &&callback)
+    {
+        auto it = objects.find(path);
+        if (it != objects.end())
+        {
+            callback(it->second.first, it->second.second);
+            return;
+        }
+        auto pendingIt = pendingObjects.find(path);
+        if (pendingIt != pendingObjects.end())
+        {
+            pendingIt->second.emplace_back(std::move(callback));
+            return;
+        }
+        pendingObjects[path].emplace_back(std::move(callback));
+
+        crow::connections::systemBus->async_method_call(
+            [self(shared_from_this()), path](const boost::system::error_code ec,
+                                             const GetObjectType &objectNames) {
+                auto &object = self->objects[path];
+                object.first = ec;
+                object.second = objectNames;
+                std::vector<ObjectCallback> callbacks =
+                    std::move(self->pendingObjects[path]);
+                self->pendingObjects.erase(path);
+                for (ObjectCallback &callback : callbacks)
+                {
+                    callback(ec, objectNames);
+                }
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetObject", path,
+            std::array<std::string, 0>());
+    }
+
+    void start(const std::shared_ptr<BatchOperation> &operation);
+
+    crow::Response &res;
+    std::vector<BatchItem> items;
+    nlohmann::json results = nlohmann::json::array();
+    size_t next = 0;
+    size_t inFlight = 0;
+    std::map<std::string, std::pair<boost::system::error_code, GetObjectType>>
+        objects;
+    std::map<std::string, std::vector<ObjectCallback>> pendingObjects;
+};
+
+inline BatchOperation::BatchOperation(
+    const std::shared_ptr<BatchRequest> &batch, size_t index) :
+    batch(batch),
+    index(index), item(batch->items[index])
+{
+}
+
+inline BatchOperation::~BatchOperation()
+{
+    batch->finish(index, makeBatchResult(item, std::move(result), found,
+                                         std::move(data)));
+}
+
+/**
+ * @brief Reads one property, or all the properties of an interface if the
+ * operation doesn't name one
+ */
+inline void getBatchProperties(const std::shared_ptr<BatchOperation> &operation,
+                               const std::string &connectionName,
+                               const std::string &interfaceName)
+{
+    const BatchItem &item = operation->item;
+    sdbusplus::message::message m =
+        crow::connections::systemBus->new_method_call(
+            connectionName.c_str(), item.objectPath.c_str(),
+            "org.freedesktop.DBus.Properties",
+            item.propertyName.empty() ? "GetAll" : "Get");
+    m.append(interfaceName);
+    if (!item.propertyName.empty())
+    {
+        m.append(item.propertyName);
+    }
+    crow::connections::systemBus->async_send(
+        m, [operation](const boost::system::error_code ec,
+                       sdbusplus::message::message &msg) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "Bad dbus request error: " << ec;
+                return;
+            }
+            const BatchItem &item = operation->item;
+            nlohmann::json value;
+            int r = convertDBusToJSON(item.propertyName.empty() ? "a{sv}" : "v",
+                                      msg, value);
+            if (r < 0)
+            {
+                BMCWEB_LOG_ERROR << "convertDBusToJSON failed";
+                return;
+            }
+            if (!item.propertyName.empty())
+            {
+                operation->data = std::move(value);
+                operation->found = true;
+                return;
+            }
+            for (auto &prop : value.items())
+            {
+                operation->data[prop.key()] = std::move(prop.value());
+            }
+        });
+}
+
+/**
+ * @brief Sets the property of a batch operation
+ */
+inline void setBatchProperty(const std::shared_ptr<BatchOperation> &operation,
+                             const std::string &connectionName,
+                             const std::string &interfaceName,
+                             const std::string &argType)
+{
+    const BatchItem &item = operation->item;
+    sdbusplus::message::message m =
+        crow::connections::systemBus->new_method_call(
+            connectionName.c_str(), item.objectPath.c_str(),
+            "org.freedesktop.DBus.Properties", "Set");
+    m.append(interfaceName, item.propertyName);
+    const char *error = appendPropertyValue(m, argType, item.propertyValue);
+    if (error != nullptr)
+    {
+        operation->setError(error, badReqMsg);
+        return;
+    }
+    crow::connections::systemBus->async_send(
+        m, [operation](boost::system::error_code ec,
+                       sdbusplus::message::message &m) {
+            if (ec)
+            {
+                const sd_bus_error *e = m.get_error();
+                operation->setError((e) ? e->name : ec.category().name(),
+                                    (e) ? e->message : ec.message());
+            }
+            else if (operation->result.is_null())
+            {
+                operation->result = {
+                    {"status", "ok"}, {"message", "200 OK"}, {"data", nullptr}};
+            }
+        });
+}
+
+inline void
+    BatchRequest::start(const std::shared_ptr<BatchOperation> &operation)
+{
+    getObject(
+        operation->item.objectPath,
+        [operation](const boost::system::error_code ec,
+                    const GetObjectType &objectNames) {
+            if (ec || objectNames.empty())
+            {
+                operation->setError(notFoundDesc, notFoundMsg);
+                return;
+            }
+            for (const std::pair<std::string, std::vector<std::string>>
+                     &connection : objectNames)
+            {
+                dbus::introspection::Cache::getInstance().get(
+                    connection.first, operation->item.objectPath,
+                    [connectionName{std::string(connection.first)},
+                     operation](const boost::system::error_code ec,
+                                const std::shared_ptr<
+                                    const dbus::introspection::Node> &node) {
+                        if (ec || node == nullptr)
+                        {
+                            operation->setError("Unexpected Error", badReqMsg);
+                            return;
+                        }
+                        const BatchItem &item = operation->item;
+                        for (const dbus::introspection::Interface &interface :
+                             node->interfaces)
+                        {
+                            // Only ask interfaces that have properties
+                            if (item.propertyName.empty())
+                            {
+                                if (!interface.properties.empty())
                                 {
-                                    for (auto &prop : properties.items())
-                                    {
-                                        // if property name is empty, or
-                                        // matches our search query, add it
-                                        // to the response json
-
-                                        if (propertyName->empty())
-                                        {
-                                            (*response)[prop.key()] =
-                                                std::move(prop.value());
-                                        }
-                                        else if (prop.key() == *propertyName)
-                                        {
-                                            *response = std::move(prop.value());
-                                        }
-                                    }
+                                    getBatchProperties(operation,
+                                                       connectionName,
+                                                       interface.name);
                                 }
+                                continue;
                             }
-                            if (response.use_count() == 1)
+                            for (const dbus::introspection::Property
+                                     &property : interface.properties)
                             {
-                                if (!propertyName->empty() && response->empty())
+                                if (property.name != item.propertyName)
                                 {
-                                    setErrorResponse(
-                                        res,
-                                        boost::beast::http::status::not_found,
-                                        propNotFoundDesc, notFoundMsg);
+                                    continue;
+                                }
+                                if (item.isSet)
+                                {
+                                    setBatchProperty(operation, connectionName,
+                                                     interface.name,
+                                                     property.type);
                                 }
                                 else
                                 {
-                                    res.jsonValue = {{"status", "ok"},
-                                                     {"message", "200 OK"},
-                                                     {"data", *response}};
+                                    getBatchProperties(operation,
+                                                       connectionName,
+                                                       interface.name);
                                 }
-                                res.end();
                             }
-                        });
-                }
+                        }
+                    });
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetObject", *path,
-        std::array<std::string, 0>());
+        });
 }
 
-struct AsyncPutRequest
+/**
+ * @brief Handles a batch of property gets and sets
+ *
+ * The body is {"data": [...]} where each operation is
+ * {"method": "GET", "path": <object>, "property": <name>} or
+ * {"method": "PUT", "path": <object>, "property": <name>, "data": <value>}.
+ * A get without a property returns all of them.  Gets need the privileges
+ * of GET on /xyz/<path>, and a batch with any set needs those of PUT.
+ */
+inline void handleBatch(const crow::Request &req, crow::Response &res)
 {
-    AsyncPutRequest(crow::Response &res) : res(res)
-    {
-    }
-    ~AsyncPutRequest()
+    std::vector<BatchItem> items;
+    std::string error = parseBatchRequest(req.body, items);
+    if (!error.empty())
     {
-        if (res.jsonValue.empty())
-        {
-            setErrorResponse(res, boost::beast::http::status::forbidden,
-                             forbiddenMsg, forbiddenPropDesc);
-        }
-
+        setErrorResponse(res, boost::beast::http::status::bad_request, error,
+                         badReqMsg);
         res.end();
+        return;
     }
-
-    void setErrorStatus(const std::string &desc)
+    redfish::RoleId roleId = redfish::RoleId::none;
+    if (req.session != nullptr)
     {
-        setErrorResponse(res, boost::beast::http::status::internal_server_error,
-                         desc, badReqMsg);
+        roleId = req.session->roleId;
     }
-
-    crow::Response &res;
-    std::string objectPath;
-    std::string propertyName;
-    nlohmann::json propertyValue;
-};
-
-void handlePut(const crow::Request &req, crow::Response &res,
-               const std::string &objectPath, const std::string &destProperty)
-{
-    if (destProperty.empty())
+    if (!isBatchAllowed(items, roleId))
     {
         setErrorResponse(res, boost::beast::http::status::forbidden,
-                         forbiddenResDesc, forbiddenMsg);
+                         "Sets need the ConfigureComponents and "
+                         "ConfigureManager privileges",
+                         forbiddenMsg);
         res.end();
         return;
     }
 
-    nlohmann::json requestDbusData =
-        nlohmann::json::parse(req.body, nullptr, false);
-
-    if (requestDbusData.is_discarded())
+    auto batch = std::make_shared<BatchRequest>(res);
+    batch->items = std::move(items);
+    batch->results = nlohmann::json::array();
+    for (size_t i = 0; i < batch->items.size(); i++)
     {
-        setErrorResponse(res, boost::beast::http::status::bad_request,
-                         noJsonDesc, badReqMsg);
-        res.end();
-        return;
+        batch->results.emplace_back(nullptr);
     }
+    batch->pump();
+}
 
-    nlohmann::json::const_iterator propertyIt = requestDbusData.find("data");
-    if (propertyIt == requestDbusData.end())
+// Size of the reads of a dump file being downloaded
+constexpr size_t dumpChunkSize = 64 * 1024;
+// Reading stops while this much of a dump is waiting to be written
+constexpr size_t dumpHighWater = 128 * 1024;
+
+/**
+ * @brief Checks a dump ID: letters, digits, "_", "-" and spaces, with at most
+ * one ".", which can't come first
+ */
+inline bool isValidDumpId(std::string_view dumpId)
+{
+    if (dumpId.empty() || dumpId.front() == '.')
     {
-        setErrorResponse(res, boost::beast::http::status::bad_request,
-                         noJsonDesc, badReqMsg);
-        res.end();
-        return;
+        return false;
     }
-    const nlohmann::json &propertySetValue = *propertyIt;
-    auto transaction = std::make_shared<AsyncPutRequest>(res);
-    transaction->objectPath = objectPath;
-    transaction->propertyName = destProperty;
-    transaction->propertyValue = propertySetValue;
-
-    using GetObjectType =
-        std::vector<std::pair<std::string, std::vector<std::string>>>;
-
-    crow::connections::systemBus->async_method_call(
-        [transaction](const boost::system::error_code ec,
-                      const GetObjectType &object_names) {
-            if (!ec && object_names.size() <= 0)
+    bool dot = false;
+    for (char c : dumpId)
+    {
+        if (c == '.')
+        {
+            if (dot)
             {
-                setErrorResponse(transaction->res,
-                                 boost::beast::http::status::not_found,
-                                 propNotFoundDesc, notFoundMsg);
-                return;
+                return false;
             }
+            dot = true;
+        }
+        else if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' &&
+                 c != '-' && c != ' ')
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-            for (const std::pair<std::string, std::vector<std::string>>
-                     connection : object_names)
-            {
-                const std::string &connectionName = connection.first;
-
-                crow::connections::systemBus->async_method_call(
-                    [connectionName{std::string(connectionName)},
-                     transaction](const boost::system::error_code ec,
-                                  const std::string &introspectXml) {
-                        if (ec)
-                        {
-                            BMCWEB_LOG_ERROR
-                                << "Introspect call failed with error: "
-                                << ec.message()
-                                << " on process: " << connectionName;
-                            transaction->setErrorStatus("Unexpected Error");
-                            return;
-                        }
-                        tinyxml2::XMLDocument doc;
+/**
+ * @brief Checks a dump file name: letters, digits, "." and "_"
+ */
+inline bool isValidDumpFileName(std::string_view name)
+{
+    if (name.empty())
+    {
+        return false;
+    }
+    for (char c : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' &&
+            c != '_')
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-                        doc.Parse(introspectXml.c_str());
-                        tinyxml2::XMLNode *pRoot =
-                            doc.FirstChildElement("node");
-                        if (pRoot == nullptr)
-                        {
-                            BMCWEB_LOG_ERROR << "XML document failed to parse: "
-                                             << introspectXml;
-                            transaction->setErrorStatus("Unexpected Error");
-                            return;
-                        }
-                        tinyxml2::XMLElement *ifaceNode =
-                            pRoot->FirstChildElement("interface");
-                        while (ifaceNode != nullptr)
-                        {
-                            const char *interfaceName =
-                                ifaceNode->Attribute("name");
-                            BMCWEB_LOG_DEBUG << "found interface "
-                                             << interfaceName;
-                            tinyxml2::XMLElement *propNode =
-                                ifaceNode->FirstChildElement("property");
-                            while (propNode != nullptr)
-                            {
-                                const char *propertyName =
-                                    propNode->Attribute("name");
-                                BMCWEB_LOG_DEBUG << "Found property "
-                                                 << propertyName;
-                                if (propertyName == transaction->propertyName)
-                                {
-                                    const char *argType =
-                                        propNode->Attribute("type");
-                                    if (argType != nullptr)
-                                    {
-                                        sdbusplus::message::message m =
-                                            crow::connections::systemBus
-                                                ->new_method_call(
-                                                    connectionName.c_str(),
-                                                    transaction->objectPath
-                                                        .c_str(),
-                                                    "org.freedesktop.DBus."
-                                                    "Properties",
-                                                    "Set");
-                                        m.append(interfaceName,
-                                                 transaction->propertyName);
-                                        int r = sd_bus_message_open_container(
-                                            m.get(), SD_BUS_TYPE_VARIANT,
-                                            argType);
-                                        if (r < 0)
-                                        {
-                                            transaction->setErrorStatus(
-                                                "Unexpected Error");
-                                            return;
-                                        }
-                                        r = convertJsonToDbus(
-                                            m.get(), argType,
-                                            transaction->propertyValue);
-                                        if (r < 0)
-                                        {
-                                            if (r == -ERANGE)
-                                            {
-                                                transaction->setErrorStatus(
-                                                    "Provided property value "
-                                                    "is out of range for the "
-                                                    "property type");
-                                            }
-                                            else
-                                            {
-                                                transaction->setErrorStatus(
-                                                    "Invalid arg type");
-                                            }
-                                            return;
-                                        }
-                                        r = sd_bus_message_close_container(
-                                            m.get());
-                                        if (r < 0)
-                                        {
-                                            transaction->setErrorStatus(
-                                                "Unexpected Error");
-                                            return;
-                                        }
-                                        crow::connections::systemBus
-                                            ->async_send(
-                                                m,
-                                                [transaction](
-                                                    boost::system::error_code
-                                                        ec,
-                                                    sdbusplus::message::message
-                                                        &m) {
-                                                    BMCWEB_LOG_DEBUG << "sent";
-                                                    if (ec)
-                                                    {
-                                                        const sd_bus_error *e =
-                                                            m.get_error();
-                                                        setErrorResponse(
-                                                            transaction->res,
-                                                            boost::beast::http::
-                                                                status::
-                                                                    forbidden,
-                                                            (e) ? e->name
-                                                                : ec.category()
-                                                                      .name(),
-                                                            (e) ? e->message
-                                                                : ec.message());
-                                                    }
-                                                    else
-                                                    {
-                                                        transaction->res
-                                                            .jsonValue = {
-                                                            {"status", "ok"},
-                                                            {"message",
-                                                             "200 OK"},
-                                                            {"data", nullptr}};
-                                                    }
-                                                });
-                                    }
-                                }
-                                propNode =
-                                    propNode->NextSiblingElement("property");
-                            }
-                            ifaceNode =
-                                ifaceNode->NextSiblingElement("interface");
-                        }
-                    },
-                    connectionName, transaction->objectPath,
-                    "org.freedesktop.DBus.Introspectable", "Introspect");
+/**
+ * @brief A dump file being downloaded, read a chunk at a time as the client
+ * takes it, so the file is never held in memory
+ */
+struct DumpDownload
+{
+    /**
+     * @brief Reads and sends chunks until enough is queued, then closes the
+     * stream once everything was sent
+     */
+    void sendChunks(crow::streaming::Connection &conn)
+    {
+        while (remaining > 0 && conn.bufferedAmount() < dumpHighWater)
+        {
+            size_t chunkSize = static_cast<size_t>(
+                std::min<uint64_t>(remaining, dumpChunkSize));
+            std::string chunk(chunkSize, '\0');
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            if (static_cast<size_t>(file.gcount()) != chunk.size())
+            {
+                // The client sees a body shorter than Content-Length
+                BMCWEB_LOG_ERROR << "Dump file ended early";
+                remaining = 0;
+                break;
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetObject",
-        transaction->objectPath, std::array<std::string, 0>());
-}
+            remaining -= chunk.size();
+            conn.send(std::move(chunk));
+        }
+        if (remaining == 0)
+        {
+            conn.onDrain(nullptr);
+            conn.close();
+        }
+    }
+
+    std::ifstream file;
+    // Bytes still to be sent
+    uint64_t remaining = 0;
+};
 
 inline void handleDBusUrl(const crow::Request &req, crow::Response &res,
                           std::string &objectPath)
@@ -2143,12 +2508,20 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                 handleDBusUrl(req, res, objectPath);
             });
 
+    // Gets only need Login, as on /xyz/<path>.  handleBatch checks that a
+    // batch with sets has the privileges PUT needs
+    BMCWEB_ROUTE(app, "/batch")
+        .requires({"Login"})
+        .methods("POST"_method)(
+            [](const crow::Request &req, crow::Response &res) {
+                handleBatch(req, res);
+            });
+
     BMCWEB_ROUTE(app, "/download/dump/<str>/")
         .requires({"ConfigureManager"})
         .methods("GET"_method)([](const crow::Request &req, crow::Response &res,
                                   const std::string &dumpId) {
-            std::regex validFilename("^[\\w\\- ]+(\\.?[\\w\\- ]*)$");
-            if (!std::regex_match(dumpId, validFilename))
+            if (!isValidDumpId(dumpId))
             {
                 res.result(boost::beast::http::status::bad_request);
                 res.end();
@@ -2171,14 +2544,14 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
 
             for (auto &file : files)
             {
-                std::ifstream readFile(file.path());
-                if (!readFile.good())
+                std::ifstream readFile(file.path(), std::ios::binary);
+                std::error_code ec;
+                uint64_t size = std::filesystem::file_size(file.path(), ec);
+                if (!readFile.good() || ec)
                 {
                     continue;
                 }
 
-                res.addHeader("Content-Type", "application/octet-stream");
-
                 // Assuming only one dump file will be present in the dump id
                 // directory
                 std::string dumpFileName = file.path().filename().string();
@@ -2186,8 +2559,7 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                 // Filename should be in alphanumeric, dot and underscore
                 // Its based on phosphor-debug-collector application dumpfile
                 // format
-                std::regex dumpFileRegex("[a-zA-Z0-9\\._]+");
-                if (!std::regex_match(dumpFileName, dumpFileRegex))
+                if (!isValidDumpFileName(dumpFileName))
                 {
                     BMCWEB_LOG_ERROR << "Invalid dump filename "
                                      << dumpFileName;
@@ -2195,13 +2567,60 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                     res.end();
                     return;
                 }
-                std::string contentDispositionParam =
-                    "attachment; filename=\"" + dumpFileName + "\"";
 
-                res.addHeader("Content-Disposition", contentDispositionParam);
+                http_helpers::ByteRange range;
+                http_helpers::RangeResult rangeResult =
+                    http_helpers::RangeResult::none;
+                std::string_view rangeHeader = req.getHeaderValue("range");
+                if (!rangeHeader.empty())
+                {
+                    rangeResult =
+                        http_helpers::parseRange(rangeHeader, size, range);
+                }
+                if (rangeResult == http_helpers::RangeResult::unsatisfiable)
+                {
+                    res.result(
+                        boost::beast::http::status::range_not_satisfiable);
+                    res.addHeader("Content-Range",
+                                  "bytes */" + std::to_string(size));
+                    res.end();
+                    return;
+                }
+
+                crow::streaming::StreamOptions options;
+                options.contentType = "application/octet-stream";
+                options.heartbeatInterval = std::chrono::seconds(0);
+                options.overflowPolicy = crow::streaming::OverflowPolicy::close;
+                options.contentLength = size;
+                options.headers.emplace_back(
+                    "Content-Disposition",
+                    "attachment; filename=\"" + dumpFileName + "\"");
+                options.headers.emplace_back("Accept-Ranges", "bytes");
+                if (rangeResult == http_helpers::RangeResult::satisfiable)
+                {
+                    options.status =
+                        boost::beast::http::status::partial_content;
+                    options.contentLength = range.size();
+                    options.headers.emplace_back(
+                        "Content-Range",
+                        "bytes " + std::to_string(range.first) + "-" +
+                            std::to_string(range.last) + "/" +
+                            std::to_string(size));
+                    readFile.seekg(static_cast<std::streamoff>(range.first));
+                }
 
-                res.body() = {std::istreambuf_iterator<char>(readFile),
-                              std::istreambuf_iterator<char>()};
+                auto download = std::make_shared<DumpDownload>();
+                download->file = std::move(readFile);
+                download->remaining = *options.contentLength;
+                res.stream(std::move(options),
+                           [download](crow::streaming::Connection &conn) {
+                               conn.onDrain(
+                                   [download](
+                                       crow::streaming::Connection &conn) {
+                                       download->sendChunks(conn);
+                                   });
+                               download->sendChunks(conn);
+                           });
                 res.end();
                 return;
             }
@@ -2276,29 +2695,18 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                 std::shared_ptr<bmcweb::AsyncResp> asyncResp =
                     std::make_shared<bmcweb::AsyncResp>(res);
 
-                crow::connections::systemBus->async_method_call(
-                    [asyncResp, processName,
-                     objectPath](const boost::system::error_code ec,
-                                 const std::string &introspect_xml) {
+                dbus::introspection::Cache::getInstance().get(
+                    processName, objectPath,
+                    [asyncResp, processName, objectPath](
+                        const boost::system::error_code ec,
+                        const std::shared_ptr<const dbus::introspection::Node>
+                            &node) {
                         if (ec)
                         {
-                            BMCWEB_LOG_ERROR
-                                << "Introspect call failed with error: "
-                                << ec.message()
-                                << " on process: " << processName
-                                << " path: " << objectPath << "\n";
                             return;
                         }
-                        tinyxml2::XMLDocument doc;
-
-                        doc.Parse(introspect_xml.c_str());
-                        tinyxml2::XMLNode *pRoot =
-                            doc.FirstChildElement("node");
-                        if (pRoot == nullptr)
+                        if (node == nullptr)
                         {
-                            BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                             << processName << " " << objectPath
-                                             << "\n";
                             asyncResp->res.jsonValue = {
                                 {"status", "XML parse error"}};
                             asyncResp->res.result(boost::beast::http::status::
@@ -2306,7 +2714,6 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                             return;
                         }
 
-                        BMCWEB_LOG_DEBUG << introspect_xml;
                         asyncResp->res.jsonValue = {
                             {"status", "ok"},
                             {"bus_name", processName},
@@ -2314,58 +2721,46 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                         nlohmann::json &interfacesArray =
                             asyncResp->res.jsonValue["interfaces"];
                         interfacesArray = nlohmann::json::array();
-                        tinyxml2::XMLElement *interface =
-                            pRoot->FirstChildElement("interface");
-
-                        while (interface != nullptr)
+                        for (const dbus::introspection::Interface &interface :
+                             node->interfaces)
                         {
-                            const char *ifaceName =
-                                interface->Attribute("name");
-                            if (ifaceName != nullptr)
-                            {
-                                interfacesArray.push_back(
-                                    {{"name", ifaceName}});
-                            }
-
-                            interface =
-                                interface->NextSiblingElement("interface");
+                            interfacesArray.push_back(
+                                {{"name", interface.name}});
                         }
-                    },
-                    processName, objectPath,
-                    "org.freedesktop.DBus.Introspectable", "Introspect");
+                    });
             }
             else if (methodName.empty())
             {
                 std::shared_ptr<bmcweb::AsyncResp> asyncResp =
                     std::make_shared<bmcweb::AsyncResp>(res);
 
-                crow::connections::systemBus->async_method_call(
-                    [asyncResp, processName, objectPath,
-                     interfaceName](const boost::system::error_code ec,
-                                    const std::string &introspect_xml) {
+                dbus::introspection::Cache::getInstance().get(
+                    processName, objectPath,
+                    [asyncResp, processName, objectPath, interfaceName](
+                        const boost::system::error_code ec,
+                        const std::shared_ptr<const dbus::introspection::Node>
+                            &node) {
                         if (ec)
                         {
-                            BMCWEB_LOG_ERROR
-                                << "Introspect call failed with error: "
-                                << ec.message()
-                                << " on process: " << processName
-                                << " path: " << objectPath << "\n";
                             return;
                         }
-                        tinyxml2::XMLDocument doc;
-
-                        doc.Parse(introspect_xml.data(), introspect_xml.size());
-                        tinyxml2::XMLNode *pRoot =
-                            doc.FirstChildElement("node");
-                        if (pRoot == nullptr)
+                        if (node == nullptr)
                         {
-                            BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                             << processName << " " << objectPath
-                                             << "\n";
                             asyncResp->res.result(boost::beast::http::status::
                                                       internal_server_error);
                             return;
                         }
+                        const dbus::introspection::Interface *interface =
+                            node->findInterface(interfaceName);
+                        if (interface == nullptr)
+                        {
+                            // if we got to the end of the list and
+                            // never found a match, throw 404
+                            asyncResp->res.result(
+                                boost::beast::http::status::not_found);
+                            return;
+                        }
+
                         asyncResp->res.jsonValue = {
                             {"status", "ok"},
                             {"bus_name", processName},
@@ -2384,137 +2779,75 @@ template <typename... Middlewares> void requestRoutes(Crow<Middlewares...> &app)
                             asyncResp->res.jsonValue["properties"];
                         propertiesObj = nlohmann::json::object();
 
-                        // if we know we're the only call, build the
-                        // json directly
-                        tinyxml2::XMLElement *interface =
-                            pRoot->FirstChildElement("interface");
-                        while (interface != nullptr)
-                        {
-                            const char *ifaceName =
-                                interface->Attribute("name");
-
-                            if (ifaceName != nullptr &&
-                                ifaceName == interfaceName)
-                            {
-                                break;
-                            }
-
-                            interface =
-                                interface->NextSiblingElement("interface");
-                        }
-                        if (interface == nullptr)
-                        {
-                            // if we got to the end of the list and
-                            // never found a match, throw 404
-                            asyncResp->res.result(
-                                boost::beast::http::status::not_found);
-                            return;
-                        }
-
-                        tinyxml2::XMLElement *methods =
-                            interface->FirstChildElement("method");
-                        while (methods != nullptr)
+                        for (const dbus::introspection::Method &method :
+                             interface->methods)
                         {
                             nlohmann::json argsArray = nlohmann::json::array();
-                            tinyxml2::XMLElement *arg =
-                                methods->FirstChildElement("arg");
-                            while (arg != nullptr)
+                            for (const dbus::introspection::Arg &arg :
+                                 method.args)
                             {
                                 nlohmann::json thisArg;
-                                for (const char *fieldName :
-                                     std::array<const char *, 3>{
-                                         "name", "direction", "type"})
+                                if (!arg.name.empty())
                                 {
-                                    const char *fieldValue =
-                                        arg->Attribute(fieldName);
-                                    if (fieldValue != nullptr)
-                                    {
-                                        thisArg[fieldName] = fieldValue;
-                                    }
+                                    thisArg["name"] = arg.name;
+                                }
+                                if (!arg.direction.empty())
+                                {
+                                    thisArg["direction"] = arg.direction;
+                                }
+                                if (!arg.type.empty())
+                                {
+                                    thisArg["type"] = arg.type;
                                 }
                                 argsArray.push_back(std::move(thisArg));
-                                arg = arg->NextSiblingElement("arg");
-                            }
-
-                            const char *name = methods->Attribute("name");
-                            if (name != nullptr)
-                            {
-                                methodsArray.push_back(
-                                    {{"name", name},
-                                     {"uri", "/bus/system/" + processName +
-                                                 objectPath + "/" +
-                                                 interfaceName + "/" + name},
-                                     {"args", argsArray}});
                             }
-                            methods = methods->NextSiblingElement("method");
+                            methodsArray.push_back(
+                                {{"name", method.name},
+                                 {"uri", "/bus/system/" + processName +
+                                             objectPath + "/" + interfaceName +
+                                             "/" + method.name},
+                                 {"args", std::move(argsArray)}});
                         }
-                        tinyxml2::XMLElement *signals =
-                            interface->FirstChildElement("signal");
-                        while (signals != nullptr)
+
+                        for (const dbus::introspection::Signal &signal :
+                             interface->signals)
                         {
                             nlohmann::json argsArray = nlohmann::json::array();
-
-                            tinyxml2::XMLElement *arg =
-                                signals->FirstChildElement("arg");
-                            while (arg != nullptr)
-                            {
-                                const char *name = arg->Attribute("name");
-                                const char *type = arg->Attribute("type");
-                                if (name != nullptr && type != nullptr)
-                                {
-                                    argsArray.push_back({
-                                        {"name", name},
-                                        {"type", type},
-                                    });
-                                }
-                                arg = arg->NextSiblingElement("arg");
-                            }
-                            const char *name = signals->Attribute("name");
-                            if (name != nullptr)
+                            for (const dbus::introspection::Arg &arg :
+                                 signal.args)
                             {
-                                signalsArray.push_back(
-                                    {{"name", name}, {"args", argsArray}});
+                                argsArray.push_back({
+                                    {"name", arg.name},
+                                    {"type", arg.type},
+                                });
                             }
-
-                            signals = signals->NextSiblingElement("signal");
+                            signalsArray.push_back({{"name", signal.name},
+                                                    {"args", argsArray}});
                         }
 
-                        tinyxml2::XMLElement *property =
-                            interface->FirstChildElement("property");
-                        while (property != nullptr)
+                        for (const dbus::introspection::Property &property :
+                             interface->properties)
                         {
-                            const char *name = property->Attribute("name");
-                            const char *type = property->Attribute("type");
-                            if (type != nullptr && name != nullptr)
-                            {
-                                sdbusplus::message::message m =
-                                    crow::connections::systemBus
-                                        ->new_method_call(processName.c_str(),
-                                                          objectPath.c_str(),
-                                                          "org.freedesktop."
-                                                          "DBus."
-                                                          "Properties",
-                                                          "Get");
-                                m.append(interfaceName, name);
-                                nlohmann::json &propertyItem =
-                                    propertiesObj[name];
-                                crow::connections::systemBus->async_send(
-                                    m, [&propertyItem, asyncResp](
-                                           boost::system::error_code &ec,
-                                           sdbusplus::message::message &m) {
-                                        if (ec)
-                                        {
-                                            return;
-                                        }
+                            sdbusplus::message::message m =
+                                crow::connections::systemBus->new_method_call(
+                                    processName.c_str(), objectPath.c_str(),
+                                    "org.freedesktop.DBus.Properties", "Get");
+                            m.append(interfaceName, property.name);
+                            nlohmann::json &propertyItem =
+                                propertiesObj[property.name];
+                            crow::connections::systemBus->async_send(
+                                m, [&propertyItem, asyncResp](
+                                       boost::system::error_code &ec,
+                                       sdbusplus::message::message &m) {
+                                    if (ec)
+                                    {
+                                        return;
+                                    }
 
-                                        convertDBusToJSON("v", m, propertyItem);
-                                    });
-                            }
-                            property = property->NextSiblingElement("property");
+                                    convertDBusToJSON("v", m, propertyItem);
+                                });
                         }
-                    },
-                    processName, objectPath,
-                    "org.freedesktop.DBus.Introspectable", "Introspect");
+                    });
             }
             else
             {
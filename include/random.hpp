@@ -0,0 +1,138 @@
+#pragma once
+
+#include <sys/random.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "crow/logging.h"
+
+namespace crow
+{
+
+namespace random
+{
+
+/**
+ * @brief Generates alphanumeric tokens suitable for session identifiers
+ *
+ * Random bytes are pulled from getrandom(2) a block at a time and consumed
+ * lazily, so generating the tokens for a session costs at most one syscall
+ * instead of one per character.  Bytes are mapped onto the alphabet with
+ * rejection sampling, so every character is equally likely.
+ */
+class TokenGenerator
+{
+  public:
+    static constexpr std::array<char, 62> alphanum = {
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C',
+        'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+        'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c',
+        'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p',
+        'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'};
+
+    // Largest multiple of the alphabet size that fits in a byte.  Bytes at or
+    // above this value would bias the low characters, so they are discarded
+    static constexpr uint8_t rejectionLimit =
+        static_cast<uint8_t>((256 / alphanum.size()) * alphanum.size());
+
+    static TokenGenerator& getInstance()
+    {
+        static TokenGenerator generator;
+        return generator;
+    }
+
+    std::string generate(size_t length)
+    {
+        std::string token;
+        token.resize(length, '0');
+        for (char& c : token)
+        {
+            c = nextChar();
+        }
+        return token;
+    }
+
+    /**
+     * @brief Maps a random byte onto the token alphabet
+     *
+     * @param[in] byte  Uniformly distributed random byte
+     * @param[out] c    Alphabet character, if the byte was accepted
+     *
+     * @return          false if the byte must be rejected
+     */
+    static bool byteToChar(uint8_t byte, char& c)
+    {
+        if (byte >= rejectionLimit)
+        {
+            return false;
+        }
+        c = alphanum[byte % alphanum.size()];
+        return true;
+    }
+
+    TokenGenerator(const TokenGenerator&) = delete;
+    TokenGenerator& operator=(const TokenGenerator&) = delete;
+
+  private:
+    TokenGenerator() = default;
+
+    char nextChar()
+    {
+        char c = '0';
+        while (true)
+        {
+            if (position >= buffer.size())
+            {
+                refill();
+            }
+            if (byteToChar(buffer[position++], c))
+            {
+                return c;
+            }
+        }
+    }
+
+    void refill()
+    {
+        size_t filled = 0;
+        while (filled < buffer.size())
+        {
+            ssize_t ret =
+                getrandom(buffer.data() + filled, buffer.size() - filled, 0);
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                BMCWEB_LOG_CRITICAL << "getrandom failed, errno=" << errno
+                                    << ", falling back to random_device";
+                fillFromRandomDevice(filled);
+                break;
+            }
+            filled += static_cast<size_t>(ret);
+        }
+        position = 0;
+    }
+
+    void fillFromRandomDevice(size_t filled)
+    {
+        std::random_device rd;
+        std::uniform_int_distribution<unsigned int> dist(0, 255);
+        for (size_t i = filled; i < buffer.size(); i++)
+        {
+            buffer[i] = static_cast<uint8_t>(dist(rd));
+        }
+    }
+
+    // Enough for several sessions worth of tokens per syscall
+    std::array<uint8_t, 256> buffer{};
+    size_t position = buffer.size();
+};
+
+} // namespace random
+} // namespace crow
@@ -0,0 +1,684 @@
+/*
+ // Copyright (c) 2019 Intel Corporation
+ //
+ // Licensed under the Apache License, Version 2.0 (the "License");
+ // you may not use this file except in compliance with the License.
+ // You may obtain a copy of the License at
+ //
+ //      http://www.apache.org/licenses/LICENSE-2.0
+ //
+ // Unless required by applicable law or agreed to in writing, software
+ // distributed under the License is distributed on an "AS IS" BASIS,
+ // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ // See the License for the specific language governing permissions and
+ // limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace rfb
+{
+
+// Message framing for the parts of RFB 3.8 (RFC 6143) the KVM proxy relays
+
+constexpr std::string_view protocolVersion = "RFB 003.008\n";
+constexpr size_t versionLength = 12;
+constexpr uint8_t securityNone = 1;
+// ServerInit up to its name: width, height, pixel format and name length
+constexpr size_t serverInitLength = 24;
+constexpr size_t pixelFormatLength = 16;
+constexpr size_t maxNameLength = 2048;
+
+namespace client
+{
+constexpr uint8_t setPixelFormat = 0;
+constexpr uint8_t setEncodings = 2;
+constexpr uint8_t framebufferUpdateRequest = 3;
+constexpr uint8_t keyEvent = 4;
+constexpr uint8_t pointerEvent = 5;
+constexpr uint8_t clientCutText = 6;
+} // namespace client
+
+namespace server
+{
+constexpr uint8_t framebufferUpdate = 0;
+constexpr uint8_t setColourMapEntries = 1;
+constexpr uint8_t bell = 2;
+constexpr uint8_t serverCutText = 3;
+} // namespace server
+
+namespace encoding
+{
+constexpr int32_t raw = 0;
+constexpr int32_t copyRect = 1;
+constexpr int32_t rre = 2;
+constexpr int32_t hextile = 5;
+constexpr int32_t tight = 7;
+constexpr int32_t lastRect = -224;
+constexpr int32_t desktopSize = -223;
+} // namespace encoding
+
+// Returned by clientMessageLength while data doesn't hold enough of the
+// message to tell its length
+constexpr size_t needMore = 0;
+// Returned by clientMessageLength for a message type that can't be framed
+constexpr size_t invalidMessage = std::numeric_limits<size_t>::max();
+
+inline uint16_t readU16(std::string_view data, size_t pos)
+{
+    return static_cast<uint16_t>(static_cast<uint8_t>(data[pos]) << 8 |
+                                 static_cast<uint8_t>(data[pos + 1]));
+}
+
+inline uint32_t readU32(std::string_view data, size_t pos)
+{
+    return static_cast<uint32_t>(readU16(data, pos)) << 16 |
+           readU16(data, pos + 2);
+}
+
+inline void appendU16(std::string& out, uint16_t value)
+{
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value & 0xff);
+}
+
+inline void appendU32(std::string& out, uint32_t value)
+{
+    appendU16(out, static_cast<uint16_t>(value >> 16));
+    appendU16(out, static_cast<uint16_t>(value & 0xffff));
+}
+
+/**
+ * @brief Length of the client to server message at the start of data
+ *
+ * @return The length, needMore, or invalidMessage
+ */
+inline size_t clientMessageLength(std::string_view data)
+{
+    if (data.empty())
+    {
+        return needMore;
+    }
+    switch (static_cast<uint8_t>(data[0]))
+    {
+        case client::setPixelFormat:
+            return 4 + pixelFormatLength;
+        case client::setEncodings:
+            if (data.size() < 4)
+            {
+                return needMore;
+            }
+            return 4 + 4 * static_cast<size_t>(readU16(data, 2));
+        case client::framebufferUpdateRequest:
+            return 10;
+        case client::keyEvent:
+            return 8;
+        case client::pointerEvent:
+            return 6;
+        case client::clientCutText:
+            if (data.size() < 8)
+            {
+                return needMore;
+            }
+            return 8 + static_cast<size_t>(readU32(data, 4));
+        default:
+            return invalidMessage;
+    }
+}
+
+/**
+ * @brief Whether ServerFramer can find the end of rectangles in an encoding.
+ * Other encodings that keep compression state between updates are left out.
+ * Tight is kept, as the KVM server sends its JPEG frames that way whatever
+ * it is asked for, and ServerFramer reports the Tight rectangles that do keep
+ * state.
+ */
+inline bool isFramedEncoding(int32_t type)
+{
+    return type == encoding::raw || type == encoding::copyRect ||
+           type == encoding::rre || type == encoding::hextile ||
+           type == encoding::tight || type == encoding::lastRect ||
+           type == encoding::desktopSize;
+}
+
+/**
+ * @brief Rewrites a SetEncodings message to keep only framed encodings, in
+ * the client's order of preference
+ */
+inline std::string filterEncodings(std::string_view message)
+{
+    std::string kept;
+    uint16_t count = 0;
+    for (size_t pos = 4; pos + 4 <= message.size(); pos += 4)
+    {
+        int32_t type = static_cast<int32_t>(readU32(message, pos));
+        if (isFramedEncoding(type))
+        {
+            kept += message.substr(pos, 4);
+            count++;
+        }
+    }
+    std::string out;
+    out += static_cast<char>(client::setEncodings);
+    out += '\0';
+    appendU16(out, count);
+    return out + kept;
+}
+
+inline std::string makeServerInit(uint16_t width, uint16_t height,
+                                  std::string_view pixelFormat,
+                                  std::string_view name)
+{
+    std::string out;
+    appendU16(out, width);
+    appendU16(out, height);
+    out += pixelFormat;
+    appendU32(out, static_cast<uint32_t>(name.size()));
+    return out += name;
+}
+
+inline std::string makeUpdateRequest(bool incremental, uint16_t width,
+                                     uint16_t height)
+{
+    std::string out;
+    out += static_cast<char>(client::framebufferUpdateRequest);
+    out += static_cast<char>(incremental);
+    appendU32(out, 0);
+    appendU16(out, width);
+    appendU16(out, height);
+    return out;
+}
+
+/**
+ * @brief A FramebufferUpdate holding only a DesktopSize pseudo-rectangle
+ */
+inline std::string makeDesktopSize(uint16_t width, uint16_t height)
+{
+    std::string out;
+    out += static_cast<char>(server::framebufferUpdate);
+    out += '\0';
+    appendU16(out, 1);
+    appendU32(out, 0);
+    appendU16(out, width);
+    appendU16(out, height);
+    appendU32(out, static_cast<uint32_t>(encoding::desktopSize));
+    return out;
+}
+
+/**
+ * @brief Finds where each server to client message ends, without buffering
+ * the messages
+ */
+class ServerFramer
+{
+  public:
+    ServerFramer(uint16_t width, uint16_t height) :
+        frameWidth(width), frameHeight(height)
+    {
+    }
+
+    /**
+     * @brief Sets the pixel format of the updates that follow
+     *
+     * @param[in] format    A PIXEL_FORMAT, pixelFormatLength bytes long
+     *
+     * @return false for a pixel size RFB doesn't have
+     */
+    bool setPixelFormat(std::string_view format)
+    {
+        uint8_t bits = static_cast<uint8_t>(format[0]);
+        if (bits != 8 && bits != 16 && bits != 32)
+        {
+            return false;
+        }
+        bytesPerPixel = bits / 8;
+        // Tight leaves out the unused byte of 24 bit true colour pixels
+        uint8_t depth = static_cast<uint8_t>(format[1]);
+        bool trueColour = format[3] != 0;
+        if (bits == 32 && depth == 24 && trueColour &&
+            readU16(format, 4) == 255 && readU16(format, 6) == 255 &&
+            readU16(format, 8) == 255)
+        {
+            tightPixelSize = 3;
+        }
+        else
+        {
+            tightPixelSize = bytesPerPixel;
+        }
+        return true;
+    }
+
+    /**
+     * @brief True before the first byte of a message
+     */
+    bool atBoundary() const
+    {
+        return state == State::messageType && have == 0 && skip == 0;
+    }
+
+    /**
+     * @brief The type of the message being framed
+     */
+    uint8_t messageType() const
+    {
+        return type;
+    }
+
+    bool failed() const
+    {
+        return error;
+    }
+
+    /**
+     * @brief True once the update being framed has a Tight rectangle that
+     * changes the viewer's zlib streams, so a viewer that misses the update
+     * can't decode the ones that follow
+     */
+    bool keepsState() const
+    {
+        return stateful;
+    }
+
+    // The framebuffer size, as last changed by a DesktopSize rectangle
+    uint16_t width() const
+    {
+        return frameWidth;
+    }
+
+    uint16_t height() const
+    {
+        return frameHeight;
+    }
+
+    /**
+     * @brief Consumes data up to the end of the current message
+     *
+     * @return The number of bytes consumed.  Less than data.size() means the
+     * message ended there, or that the data can't be framed if failed()
+     */
+    size_t advance(std::string_view data)
+    {
+        size_t pos = 0;
+        while (!error)
+        {
+            uint64_t skipped = std::min<uint64_t>(skip, data.size() - pos);
+            skip -= skipped;
+            pos += static_cast<size_t>(skipped);
+            if (skip > 0)
+            {
+                return pos;
+            }
+            if (state == State::end)
+            {
+                state = State::messageType;
+                need = 1;
+                return pos;
+            }
+            if (pos == data.size())
+            {
+                return pos;
+            }
+            size_t n = std::min(need - have, data.size() - pos);
+            std::copy_n(data.data() + pos, n, header.data() + have);
+            have += n;
+            pos += n;
+            if (have < need)
+            {
+                return pos;
+            }
+            have = 0;
+            error = !parse();
+        }
+        return pos;
+    }
+
+  private:
+    enum class State
+    {
+        messageType,
+        updateHeader,
+        rectHeader,
+        rreHeader,
+        tileType,
+        tileHeader,
+        tightControl,
+        tightFilter,
+        tightPalette,
+        tightLength,
+        colourMapHeader,
+        cutTextHeader,
+        // The message ends once skip is consumed
+        end,
+    };
+
+    uint16_t headerU16(size_t pos) const
+    {
+        return readU16(std::string_view(header.data(), header.size()), pos);
+    }
+
+    uint32_t headerU32(size_t pos) const
+    {
+        return readU32(std::string_view(header.data(), header.size()), pos);
+    }
+
+    void expect(State next, size_t length)
+    {
+        state = next;
+        need = length;
+    }
+
+    void nextRect()
+    {
+        if (rectsLeft == 0)
+        {
+            state = State::end;
+            return;
+        }
+        rectsLeft--;
+        expect(State::rectHeader, 12);
+    }
+
+    void nextTile()
+    {
+        tileX += 16;
+        if (tileX >= rectWidth)
+        {
+            tileX = 0;
+            tileY += 16;
+        }
+        if (tileY >= rectHeight)
+        {
+            nextRect();
+            return;
+        }
+        expect(State::tileType, 1);
+    }
+
+    uint64_t tileArea() const
+    {
+        return static_cast<uint64_t>(std::min(16U, rectWidth - tileX)) *
+               std::min(16U, rectHeight - tileY);
+    }
+
+    // Basic compression data follows, after any palette
+    void tightData()
+    {
+        uint64_t area = static_cast<uint64_t>(rectWidth) * rectHeight;
+        uint64_t length = 0;
+        if (paletteSize == 2)
+        {
+            // A bit per pixel, with each row padded to a byte
+            length = static_cast<uint64_t>((rectWidth + 7) / 8) * rectHeight;
+        }
+        else if (paletteSize > 2)
+        {
+            length = area;
+        }
+        else
+        {
+            length = area * tightPixelSize;
+        }
+        if (length < tightMinToCompress)
+        {
+            // Sent as is, leaving the zlib streams alone
+            skip += length;
+            nextRect();
+            return;
+        }
+        stateful = true;
+        expectCompactLength();
+    }
+
+    void expectCompactLength()
+    {
+        compactLength = 0;
+        lengthBytes = 0;
+        expect(State::tightLength, 1);
+    }
+
+    bool parse()
+    {
+        switch (state)
+        {
+            case State::messageType:
+                type = static_cast<uint8_t>(header[0]);
+                stateful = false;
+                switch (type)
+                {
+                    case server::framebufferUpdate:
+                        expect(State::updateHeader, 3);
+                        return true;
+                    case server::setColourMapEntries:
+                        expect(State::colourMapHeader, 5);
+                        return true;
+                    case server::bell:
+                        state = State::end;
+                        return true;
+                    case server::serverCutText:
+                        expect(State::cutTextHeader, 7);
+                        return true;
+                    default:
+                        return false;
+                }
+            case State::updateHeader:
+                rectsLeft = headerU16(1);
+                nextRect();
+                return true;
+            case State::rectHeader:
+            {
+                rectWidth = headerU16(4);
+                rectHeight = headerU16(6);
+                int32_t rectEncoding = static_cast<int32_t>(headerU32(8));
+                switch (rectEncoding)
+                {
+                    case encoding::raw:
+                        skip = static_cast<uint64_t>(rectWidth) * rectHeight *
+                               bytesPerPixel;
+                        nextRect();
+                        return true;
+                    case encoding::copyRect:
+                        skip = 4;
+                        nextRect();
+                        return true;
+                    case encoding::rre:
+                        expect(State::rreHeader, 4 + bytesPerPixel);
+                        return true;
+                    case encoding::hextile:
+                        tileX = 0;
+                        tileY = 0;
+                        if (rectWidth == 0 || rectHeight == 0)
+                        {
+                            nextRect();
+                            return true;
+                        }
+                        expect(State::tileType, 1);
+                        return true;
+                    case encoding::tight:
+                        expect(State::tightControl, 1);
+                        return true;
+                    case encoding::desktopSize:
+                        frameWidth = static_cast<uint16_t>(rectWidth);
+                        frameHeight = static_cast<uint16_t>(rectHeight);
+                        nextRect();
+                        return true;
+                    case encoding::lastRect:
+                        state = State::end;
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+            case State::rreHeader:
+                skip = static_cast<uint64_t>(headerU32(0)) *
+                       (bytesPerPixel + 8);
+                nextRect();
+                return true;
+            case State::tileType:
+            {
+                tileFlags = static_cast<uint8_t>(header[0]);
+                if (tileFlags & hextileRaw)
+                {
+                    skip = tileArea() * bytesPerPixel;
+                    nextTile();
+                    return true;
+                }
+                size_t length = 0;
+                length += (tileFlags & hextileBackground) ? bytesPerPixel : 0;
+                length += (tileFlags & hextileForeground) ? bytesPerPixel : 0;
+                length += (tileFlags & hextileAnySubrects) ? 1 : 0;
+                if (length == 0)
+                {
+                    nextTile();
+                    return true;
+                }
+                expect(State::tileHeader, length);
+                return true;
+            }
+            case State::tileHeader:
+                if (tileFlags & hextileAnySubrects)
+                {
+                    uint64_t subrects = static_cast<uint8_t>(header[need - 1]);
+                    skip = subrects * ((tileFlags & hextileColoured)
+                                           ? bytesPerPixel + 2
+                                           : 2);
+                }
+                nextTile();
+                return true;
+            case State::tightControl:
+            {
+                uint8_t control = static_cast<uint8_t>(header[0]);
+                if (control & tightResetMask)
+                {
+                    stateful = true;
+                }
+                uint8_t method = control >> 4;
+                paletteSize = 0;
+                if (method == tightFill)
+                {
+                    skip = tightPixelSize;
+                    nextRect();
+                    return true;
+                }
+                if (method == tightJpeg)
+                {
+                    expectCompactLength();
+                    return true;
+                }
+                if (method > tightJpeg)
+                {
+                    return false;
+                }
+                if (method & tightExplicitFilter)
+                {
+                    expect(State::tightFilter, 1);
+                    return true;
+                }
+                tightData();
+                return true;
+            }
+            case State::tightFilter:
+                switch (static_cast<uint8_t>(header[0]))
+                {
+                    case tightFilterCopy:
+                    case tightFilterGradient:
+                        tightData();
+                        return true;
+                    case tightFilterPalette:
+                        expect(State::tightPalette, 1);
+                        return true;
+                    default:
+                        return false;
+                }
+            case State::tightPalette:
+                paletteSize = static_cast<size_t>(
+                                  static_cast<uint8_t>(header[0])) +
+                              1;
+                skip = paletteSize * tightPixelSize;
+                tightData();
+                return true;
+            case State::tightLength:
+            {
+                // 7 bits in each of the first two bytes, and 8 in the third
+                uint64_t byte = static_cast<uint8_t>(header[0]);
+                if (lengthBytes == 2)
+                {
+                    compactLength |= byte << 14;
+                }
+                else
+                {
+                    compactLength |= (byte & 0x7f) << (7 * lengthBytes);
+                    lengthBytes++;
+                    if (byte & 0x80)
+                    {
+                        expect(State::tightLength, 1);
+                        return true;
+                    }
+                }
+                skip = compactLength;
+                nextRect();
+                return true;
+            }
+            case State::colourMapHeader:
+                skip = 6 * static_cast<uint64_t>(headerU16(3));
+                state = State::end;
+                return true;
+            case State::cutTextHeader:
+                skip = headerU32(3);
+                state = State::end;
+                return true;
+            case State::end:
+                return false;
+        }
+        return false;
+    }
+
+    static constexpr uint8_t hextileRaw = 1;
+    static constexpr uint8_t hextileBackground = 2;
+    static constexpr uint8_t hextileForeground = 4;
+    static constexpr uint8_t hextileAnySubrects = 8;
+    static constexpr uint8_t hextileColoured = 16;
+
+    static constexpr uint8_t tightResetMask = 0x0f;
+    static constexpr uint8_t tightExplicitFilter = 4;
+    static constexpr uint8_t tightFill = 8;
+    static constexpr uint8_t tightJpeg = 9;
+    static constexpr uint8_t tightFilterCopy = 0;
+    static constexpr uint8_t tightFilterPalette = 1;
+    static constexpr uint8_t tightFilterGradient = 2;
+    // Basic compression data shorter than this isn't compressed
+    static constexpr uint64_t tightMinToCompress = 12;
+
+    State state = State::messageType;
+    // Header bytes wanted for the current state, and collected so far
+    size_t need = 1;
+    size_t have = 0;
+    std::array<char, 16> header{};
+    // Bytes to pass over before the next header
+    uint64_t skip = 0;
+    bool error = false;
+
+    uint8_t type = 0;
+    size_t bytesPerPixel = 4;
+    // Size of a Tight TPIXEL
+    size_t tightPixelSize = 4;
+    uint16_t frameWidth;
+    uint16_t frameHeight;
+    uint16_t rectsLeft = 0;
+    unsigned int rectWidth = 0;
+    unsigned int rectHeight = 0;
+    unsigned int tileX = 0;
+    unsigned int tileY = 0;
+    uint8_t tileFlags = 0;
+    size_t paletteSize = 0;
+    uint64_t compactLength = 0;
+    unsigned int lengthBytes = 0;
+    bool stateful = false;
+};
+
+} // namespace rfb
@@ -7,7 +7,8 @@
 #include <dbus_singleton.hpp>
 #include <nlohmann/json.hpp>
 #include <pam_authenticate.hpp>
-#include <random>
+#include <privileges.hpp>
+#include <random.hpp>
 #include <sdbusplus/bus/match.hpp>
 
 #include "crow/logging.h"
@@ -210,8 +211,12 @@ struct UserRoleMap
             return;
         }
         it->second = *role;
+        updateSessionRoles(user, *role);
     }
 
+    // Defined after SessionStore, which holds the sessions to refresh
+    void updateSessionRoles(const std::string& user, const std::string& role);
+
     UserRoleMap() :
         userAddedSignal(
             *crow::connections::systemBus,
@@ -257,7 +262,10 @@ struct UserRoleMap
                     };
                     std::string name = managedObj.first.str.substr(lastPos + 1);
                     std::string role = extractUserRole(managedObj.second);
-                    roleMap.emplace(name, role);
+                    // Sessions restored from the persistent store before the
+                    // user manager answered still need their role resolved
+                    updateSessionRoles(name, role);
+                    roleMap.emplace(name, std::move(role));
                 }
             },
             userService, userObjPath, "org.freedesktop.DBus.ObjectManager",
@@ -279,6 +287,19 @@ struct UserSession
     std::string csrfToken;
     std::chrono::time_point<std::chrono::steady_clock> lastUpdated;
     PersistenceType persistence;
+    // userRole resolved once, so that requests don't need string compares
+    redfish::RoleId roleId = redfish::RoleId::readOnly;
+
+    /**
+     * @brief Sets the role of the session and the RoleId derived from it
+     *
+     * @param[in] role   Role as reported by the user manager
+     */
+    void setUserRole(const std::string& role)
+    {
+        userRole = role;
+        roleId = redfish::getRoleId(userRole);
+    }
 
     /**
      * @brief Fills object with data from UserSession's JSON representation
@@ -353,37 +374,18 @@ class SessionStore
     {
         // TODO(ed) find a secure way to not generate session identifiers if
         // persistence is set to SINGLE_REQUEST
-        static constexpr std::array<char, 62> alphanum = {
-            '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C',
-            'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-            'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c',
-            'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p',
-            'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'};
-
-        // entropy: 30 characters, 62 possibilities.  log2(62^30) = 178 bits of
+        crow::random::TokenGenerator& generator =
+            crow::random::TokenGenerator::getInstance();
+
+        // entropy: 20 characters, 62 possibilities.  log2(62^20) = 119 bits of
         // entropy.  OWASP recommends at least 60
         // https://www.owasp.org/index.php/Session_Management_Cheat_Sheet#Session_ID_Entropy
-        std::string sessionToken;
-        sessionToken.resize(20, '0');
-        std::uniform_int_distribution<int> dist(0, alphanum.size() - 1);
-        for (int i = 0; i < sessionToken.size(); ++i)
-        {
-            sessionToken[i] = alphanum[dist(rd)];
-        }
+        std::string sessionToken = generator.generate(20);
+
         // Only need csrf tokens for cookie based auth, token doesn't matter
-        std::string csrfToken;
-        csrfToken.resize(20, '0');
-        for (int i = 0; i < csrfToken.size(); ++i)
-        {
-            csrfToken[i] = alphanum[dist(rd)];
-        }
+        std::string csrfToken = generator.generate(20);
 
-        std::string uniqueId;
-        uniqueId.resize(10, '0');
-        for (int i = 0; i < uniqueId.size(); ++i)
-        {
-            uniqueId[i] = alphanum[dist(rd)];
-        }
+        std::string uniqueId = generator.generate(10);
 
         // Get the User Privilege
         const std::string& role =
@@ -393,6 +395,7 @@ class SessionStore
         auto session = std::make_shared<UserSession>(UserSession{
             uniqueId, sessionToken, std::string(username), role, csrfToken,
             std::chrono::steady_clock::now(), persistence});
+        session->setUserRole(role);
         auto it = authTokens.emplace(std::make_pair(sessionToken, session));
         // Only need to write to disk if session isn't about to be destroyed.
         needWrite = persistence == PersistenceType::TIMEOUT;
@@ -429,6 +432,17 @@ class SessionStore
         return nullptr;
     }
 
+    void updateUserRole(const std::string& username, const std::string& role)
+    {
+        for (auto& session : authTokens)
+        {
+            if (session.second->username == username)
+            {
+                session.second->setUserRole(role);
+            }
+        }
+    }
+
     void removeSession(std::shared_ptr<UserSession> session)
     {
         authTokens.erase(session->sessionToken);
@@ -506,11 +520,16 @@ class SessionStore
     std::chrono::time_point<std::chrono::steady_clock> lastTimeoutUpdate;
     boost::container::flat_map<std::string, std::shared_ptr<UserSession>>
         authTokens;
-    std::random_device rd;
     bool needWrite{false};
     std::chrono::minutes timeoutInMinutes;
 };
 
+inline void UserRoleMap::updateSessionRoles(const std::string& user,
+                                            const std::string& role)
+{
+    SessionStore::getInstance().updateUserRole(user, role);
+}
+
 } // namespace persistent_data
 } // namespace crow
 
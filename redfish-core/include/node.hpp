@@ -15,11 +15,20 @@
 */
 #pragma once
 
+#include "http_utility.hpp"
 #include "privileges.hpp"
 #include "token_authorization_middleware.hpp"
 #include "webserver_common.hpp"
 
+#include <array>
+#include <boost/asio/post.hpp>
+#include <boost/container/flat_map.hpp>
+#include <chrono>
 #include <error_messages.hpp>
+#include <memory>
+#include <optional>
+#include <sdbusplus/bus/match.hpp>
+#include <string>
 #include <vector>
 
 #include "crow/http_request.h"
@@ -55,7 +64,8 @@ class Node
 {
   public:
     template <typename... Params>
-    Node(CrowApp& app, std::string&& entityUrl, Params... params)
+    Node(CrowApp& app, std::string&& entityUrlIn, Params... params) :
+        entityUrl(std::move(entityUrlIn))
     {
         crow::DynamicRule& get = app.routeDynamic(entityUrl.c_str());
         getRule = &get;
@@ -63,6 +73,14 @@ class Node
                                          crow::Response& res,
                                          Params... params) {
             std::vector<std::string> paramVec = {params...};
+            if (responseCacheEnabled && !http_helpers::requestPrefersHtml(req))
+            {
+                if (serveCachedResponse(req, res))
+                {
+                    return;
+                }
+                cacheResponseOnCompletion(req, res);
+            }
             doGet(res, req, paramVec);
         });
 
@@ -72,6 +90,16 @@ class Node
                                              crow::Response& res,
                                              Params... params) {
             std::vector<std::string> paramVec = {params...};
+            if (responseCacheEnabled)
+            {
+                invalidateResponseCacheOnWrite(res);
+            }
+            if (!req.getHeaderValue(boost::beast::http::field::if_match)
+                     .empty())
+            {
+                doPatchIfMatch(res, req, paramVec);
+                return;
+            }
             doPatch(res, req, paramVec);
         });
 
@@ -81,6 +109,10 @@ class Node
                                            crow::Response& res,
                                            Params... params) {
             std::vector<std::string> paramVec = {params...};
+            if (responseCacheEnabled)
+            {
+                invalidateResponseCacheOnWrite(res);
+            }
             doPost(res, req, paramVec);
         });
 
@@ -90,6 +122,10 @@ class Node
                                                 crow::Response& res,
                                                 Params... params) {
             std::vector<std::string> paramVec = {params...};
+            if (responseCacheEnabled)
+            {
+                invalidateResponseCacheOnWrite(res);
+            }
             doDelete(res, req, paramVec);
         });
     }
@@ -130,8 +166,36 @@ class Node
         }
     }
 
+    struct ResponseCacheStats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        size_t entries;
+    };
+
+    /**
+     * @brief Reports how well the response cache is doing
+     *
+     * @return The counters, or std::nullopt if this node doesn't cache
+     */
+    std::optional<ResponseCacheStats> getResponseCacheStats() const
+    {
+        if (!responseCacheEnabled)
+        {
+            return std::nullopt;
+        }
+        size_t entries = 0;
+        for (const auto& roleResponses : cachedResponses)
+        {
+            entries += roleResponses.size();
+        }
+        return ResponseCacheStats{cacheHits, cacheMisses, entries};
+    }
+
     virtual ~Node() = default;
 
+    std::string entityUrl;
+
     OperationMap entityPrivileges;
 
     crow::DynamicRule* getRule = nullptr;
@@ -140,6 +204,44 @@ class Node
     crow::DynamicRule* deleteRule = nullptr;
 
   protected:
+    static constexpr std::chrono::seconds noExpiry =
+        std::chrono::seconds::max();
+
+    /**
+     * @brief Serves GET responses from their cached serialized form
+     *
+     * The first successful response for each URL and role is serialized and
+     * tagged once, then later requests are answered with those bytes, or with
+     * 304 Not Modified if the client already has them.  Responses must only
+     * depend on the URL and the role of the session.  Any PATCH, POST or
+     * DELETE on this node drops the cached responses.
+     *
+     * @param[in] ttl                 How long a cached response may be served.
+     * By default, until invalidateResponseCache() is called
+     * @param[in] invalidationRules   D-Bus match rules for signals that mean
+     * the cached responses are out of date
+     */
+    void enableResponseCache(std::chrono::seconds ttl = noExpiry,
+                             std::vector<std::string> invalidationRules = {})
+    {
+        responseCacheEnabled = true;
+        responseCacheTtl = ttl;
+        cacheInvalidationRules = std::move(invalidationRules);
+    }
+
+    /**
+     * @brief Drops the cached responses, so the next GET rebuilds them
+     */
+    void invalidateResponseCache()
+    {
+        for (auto& roleResponses : cachedResponses)
+        {
+            roleResponses.clear();
+        }
+        // Responses that are still being built may predate the change
+        cacheGeneration++;
+    }
+
     // Node is designed to be an abstract class, so doGet is pure virtual
     virtual void doGet(crow::Response& res, const crow::Request& req,
                        const std::vector<std::string>& params)
@@ -168,6 +270,200 @@ class Node
         res.result(boost::beast::http::status::method_not_allowed);
         res.end();
     }
+
+  private:
+    struct CachedResponse
+    {
+        std::shared_ptr<const std::string> body;
+        std::string etag;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    using CachedResponseMap =
+        boost::container::flat_map<std::string, CachedResponse, std::less<>>;
+
+    // Bounds the cache for nodes with URL parameters
+    static constexpr size_t maxCachedResponses = 64;
+
+    static RoleId getRequestRole(const crow::Request& req)
+    {
+        return req.session != nullptr ? req.session->roleId : RoleId::none;
+    }
+
+    static void setCachedResponse(crow::Response& res,
+                                  const CachedResponse& cached,
+                                  std::string_view ifNoneMatch)
+    {
+        res.addHeader(boost::beast::http::field::etag, cached.etag);
+        if (http_helpers::etagMatches(ifNoneMatch, cached.etag))
+        {
+            res.result(boost::beast::http::status::not_modified);
+            res.jsonValue.clear();
+            res.body().clear();
+            return;
+        }
+        res.addHeader("Content-Type", "application/json");
+        res.body() = *cached.body;
+    }
+
+    bool serveCachedResponse(const crow::Request& req, crow::Response& res)
+    {
+        CachedResponseMap& roleResponses =
+            cachedResponses[static_cast<size_t>(getRequestRole(req))];
+        auto it = roleResponses.find(req.url);
+        if (it == roleResponses.end())
+        {
+            cacheMisses++;
+            return false;
+        }
+        if (std::chrono::steady_clock::now() >= it->second.expires)
+        {
+            roleResponses.erase(it);
+            cacheMisses++;
+            return false;
+        }
+        cacheHits++;
+        setCachedResponse(
+            res, it->second,
+            req.getHeaderValue(boost::beast::http::field::if_none_match));
+        res.end();
+        return true;
+    }
+
+    void cacheResponseOnCompletion(const crow::Request& req,
+                                   crow::Response& res)
+    {
+        watchCacheInvalidationRules();
+
+        std::function<void()> complete = res.replaceCompleteRequestHandler({});
+        res.replaceCompleteRequestHandler(
+            [this, &res, role{getRequestRole(req)}, url{std::string(req.url)},
+             ifNoneMatch{std::string(req.getHeaderValue(
+                 boost::beast::http::field::if_none_match))},
+             generation{cacheGeneration},
+             complete{std::move(complete)}]() mutable {
+                CachedResponseMap& roleResponses =
+                    cachedResponses[static_cast<size_t>(role)];
+                if (generation == cacheGeneration &&
+                    res.result() == boost::beast::http::status::ok &&
+                    res.body().empty() && !res.jsonValue.empty() &&
+                    roleResponses.size() < maxCachedResponses)
+                {
+                    auto body = std::make_shared<const std::string>(
+                        res.jsonValue.dump(2, ' ', true));
+                    CachedResponse cached{
+                        body, http_helpers::makeETag(*body),
+                        std::chrono::steady_clock::time_point::max()};
+                    if (responseCacheTtl != noExpiry)
+                    {
+                        cached.expires =
+                            std::chrono::steady_clock::now() + responseCacheTtl;
+                    }
+                    setCachedResponse(res, cached, ifNoneMatch);
+                    roleResponses.insert_or_assign(std::move(url),
+                                                   std::move(cached));
+                }
+                // Replacing the handler from within completion destroys this
+                // lambda, so keep the next handler alive locally
+                std::function<void()> next = std::move(complete);
+                if (next)
+                {
+                    next();
+                }
+            });
+    }
+
+    // Runs a fresh GET of the resource, and only applies the PATCH if the
+    // If-Match header still matches the ETag of what it returned
+    void doPatchIfMatch(crow::Response& res, const crow::Request& req,
+                        const std::vector<std::string>& params)
+    {
+        auto current = std::make_shared<crow::Response>();
+        crow::Response& getRes = *current;
+        getRes.replaceCompleteRequestHandler(
+            [this, &res, &req, params, current{std::move(current)}]() mutable {
+                // The GET response is still ending here, so check it from the
+                // io_context, which also owns it until then
+                boost::asio::post(*req.ioService,
+                                  [this, &res, &req, params{std::move(params)},
+                                   getRes{std::move(current)}]() {
+                                      patchIfMatch(res, req, params, *getRes);
+                                  });
+            });
+        doGet(getRes, req, params);
+    }
+
+    // Compares If-Match with the ETag a GET would have sent for getRes
+    void patchIfMatch(crow::Response& res, const crow::Request& req,
+                      const std::vector<std::string>& params,
+                      crow::Response& getRes)
+    {
+        std::string body = getRes.body();
+        if (body.empty())
+        {
+            body = getRes.jsonValue.dump(2, ' ', true);
+        }
+        if (getRes.result() != boost::beast::http::status::ok ||
+            !http_helpers::etagMatches(
+                req.getHeaderValue(boost::beast::http::field::if_match),
+                http_helpers::makeETag(body),
+                http_helpers::ETagComparison::strong))
+        {
+            BMCWEB_LOG_DEBUG << entityUrl << " If-Match precondition failed";
+            res.result(boost::beast::http::status::precondition_failed);
+            res.end();
+            return;
+        }
+        doPatch(res, req, params);
+    }
+
+    // Writes change the resource both when they start and when the backend
+    // finishes applying them, so drop the cache at both points
+    void invalidateResponseCacheOnWrite(crow::Response& res)
+    {
+        invalidateResponseCache();
+        std::function<void()> complete = res.replaceCompleteRequestHandler({});
+        res.replaceCompleteRequestHandler(
+            [this, complete{std::move(complete)}]() mutable {
+                invalidateResponseCache();
+                std::function<void()> next = std::move(complete);
+                if (next)
+                {
+                    next();
+                }
+            });
+    }
+
+    // The matches are added on first use, once the system bus is connected
+    void watchCacheInvalidationRules()
+    {
+        if (!cacheInvalidationMatches.empty() ||
+            crow::connections::systemBus == nullptr)
+        {
+            return;
+        }
+        for (const std::string& rule : cacheInvalidationRules)
+        {
+            cacheInvalidationMatches.emplace_back(
+                std::make_unique<sdbusplus::bus::match::match>(
+                    *crow::connections::systemBus, rule,
+                    [this](sdbusplus::message::message&) {
+                        BMCWEB_LOG_DEBUG << entityUrl
+                                         << " response cache invalidated";
+                        invalidateResponseCache();
+                    }));
+        }
+    }
+
+    bool responseCacheEnabled = false;
+    std::chrono::seconds responseCacheTtl = noExpiry;
+    std::vector<std::string> cacheInvalidationRules;
+    std::vector<std::unique_ptr<sdbusplus::bus::match::match>>
+        cacheInvalidationMatches;
+    std::array<CachedResponseMap, roleIdCount> cachedResponses;
+    uint64_t cacheGeneration = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
 };
 
 } // namespace redfish
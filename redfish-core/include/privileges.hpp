@@ -22,6 +22,7 @@
 #include <boost/beast/http/verb.hpp>
 #include <boost/container/flat_map.hpp>
 #include <cstdint>
+#include <string_view>
 #include <vector>
 
 namespace redfish
@@ -177,27 +178,100 @@ class Privileges
     std::bitset<maxPrivilegeCount> privilegeBitset = 0;
 };
 
-inline const Privileges& getUserPrivileges(const std::string& userRole)
+/**
+ * @brief Interned identifiers for the roles a request can be made with.
+ *
+ *        Sessions resolve their D-Bus role string to one of these once, so the
+ *        router never has to compare role strings while handling a request.
+ *        RoleId::none is used for requests that carry no session.
+ */
+enum class RoleId : uint8_t
+{
+    none,
+    readOnly,
+    op,
+    admin
+};
+
+/** @brief Number of entries in RoleId */
+constexpr const size_t roleIdCount = 4;
+
+/**
+ * @brief Maps a D-Bus user role string to its interned role id
+ *
+ * @param[in] userRole  Role as reported by the user manager (priv-*)
+ *
+ * @return              Role id.  Unknown roles are treated as read only
+ *
+ */
+inline RoleId getRoleId(std::string_view userRole)
 {
-    // Redfish privilege : Administrator
     if (userRole == "priv-admin")
     {
-        static Privileges admin{"Login", "ConfigureManager", "ConfigureSelf",
-                                "ConfigureUsers", "ConfigureComponents"};
-        return admin;
+        return RoleId::admin;
     }
-    else if (userRole == "priv-operator")
+    if (userRole == "priv-operator")
     {
+        return RoleId::op;
+    }
+    return RoleId::readOnly;
+}
+
+inline const Privileges& getUserPrivileges(RoleId roleId)
+{
+    // Indexed by RoleId
+    static const std::array<Privileges, roleIdCount> rolePrivileges{
+        // No session
+        Privileges{},
+        // Redfish privilege : Readonly
+        Privileges{"Login", "ConfigureSelf"},
         // Redfish privilege : Operator
-        static Privileges op{"Login", "ConfigureSelf", "ConfigureComponents"};
-        return op;
+        Privileges{"Login", "ConfigureSelf", "ConfigureComponents"},
+        // Redfish privilege : Administrator
+        Privileges{"Login", "ConfigureManager", "ConfigureSelf",
+                   "ConfigureUsers", "ConfigureComponents"}};
+
+    return rolePrivileges[static_cast<size_t>(roleId)];
+}
+
+inline const Privileges& getUserPrivileges(const std::string& userRole)
+{
+    return getUserPrivileges(getRoleId(userRole));
+}
+
+/**
+ * @brief Resolves which roles satisfy at least one of the given privilege sets
+ *
+ * @param[in] privilegesSet  Alternative privilege sets, any of which grants
+ * access.  An empty list requires no privileges.
+ *
+ * @return                   Bitset indexed by RoleId
+ *
+ */
+inline std::bitset<roleIdCount>
+    getAllowedRoles(const std::vector<Privileges>& privilegesSet)
+{
+    std::bitset<roleIdCount> allowedRoles;
+    if (privilegesSet.empty())
+    {
+        allowedRoles.set();
+        return allowedRoles;
     }
-    else
+
+    for (size_t roleIndex = 0; roleIndex < roleIdCount; roleIndex++)
     {
-        // Redfish privilege : Readonly
-        static Privileges readOnly{"Login", "ConfigureSelf"};
-        return readOnly;
+        const Privileges& userPrivileges =
+            getUserPrivileges(static_cast<RoleId>(roleIndex));
+        for (const Privileges& requiredPrivileges : privilegesSet)
+        {
+            if (userPrivileges.isSupersetOf(requiredPrivileges))
+            {
+                allowedRoles.set(roleIndex);
+                break;
+            }
+        }
     }
+    return allowedRoles;
 }
 
 using OperationMap = boost::container::flat_map<boost::beast::http::verb,
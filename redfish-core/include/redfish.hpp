@@ -20,6 +20,7 @@
 #include "../lib/chassis.hpp"
 #include "../lib/cpudimm.hpp"
 #include "../lib/ethernet.hpp"
+#include "../lib/event_service.hpp"
 #include "../lib/log_services.hpp"
 #include "../lib/managers.hpp"
 #include "../lib/message_registries.hpp"
@@ -30,6 +31,7 @@
 #include "../lib/roles.hpp"
 #include "../lib/service_root.hpp"
 #include "../lib/systems.hpp"
+#include "../lib/telemetry_service.hpp"
 #include "../lib/thermal.hpp"
 #include "../lib/update_service.hpp"
 #include "webserver_common.hpp"
@@ -140,12 +142,52 @@ class RedfishService
         nodes.emplace_back(std::make_unique<TrustStoreCertificate>(app));
         nodes.emplace_back(std::make_unique<SystemPCIeFunction>(app));
         nodes.emplace_back(std::make_unique<SystemPCIeDevice>(app));
+        nodes.emplace_back(std::make_unique<EventService>(app));
+        nodes.emplace_back(std::make_unique<EventDestinationCollection>(app));
+        nodes.emplace_back(std::make_unique<EventDestination>(app));
+        nodes.emplace_back(std::make_unique<TelemetryService>(app));
+        nodes.emplace_back(
+            std::make_unique<MetricReportDefinitionCollection>(app));
+        nodes.emplace_back(std::make_unique<MetricReportDefinition>(app));
+        nodes.emplace_back(std::make_unique<MetricReportCollection>(app));
+        nodes.emplace_back(std::make_unique<MetricReport>(app));
+        nodes.emplace_back(std::make_unique<SensorChanges>(app));
         for (const auto& node : nodes)
         {
             node->initPrivileges();
         }
     }
 
+    /*
+     * @brief Reports the response cache hit ratio of every caching node
+     *
+     * @param[out] res  Response to fill in
+     */
+    void getResponseCacheStats(crow::Response& res) const
+    {
+        nlohmann::json& nodeStats = res.jsonValue["Nodes"];
+        nodeStats = nlohmann::json::array();
+        for (const auto& node : nodes)
+        {
+            std::optional<Node::ResponseCacheStats> stats =
+                node->getResponseCacheStats();
+            if (!stats)
+            {
+                continue;
+            }
+            uint64_t requests = stats->hits + stats->misses;
+            nodeStats.push_back(
+                {{"Url", node->entityUrl},
+                 {"Hits", stats->hits},
+                 {"Misses", stats->misses},
+                 {"HitRatio", requests == 0 ? 0.0
+                                            : static_cast<double>(stats->hits) /
+                                                  static_cast<double>(requests)},
+                 {"Entries", stats->entries}});
+        }
+        res.end();
+    }
+
   private:
     std::vector<std::unique_ptr<Node>> nodes;
 };
@@ -14,6 +14,16 @@
 // limitations under the License.
 */
 #pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+
 namespace redfish::message_registries
 {
 struct Header
@@ -39,4 +49,242 @@ struct Message
     const char* resolution;
 };
 using MessageEntry = std::pair<const char*, const Message>;
+
+/**
+ * @brief A registry Message split into literal text and MessageArg slots
+ *
+ * Parsed once, at compile time, so filling in the MessageArgs is a single
+ * append pass instead of a search and replace per argument.
+ */
+struct MessageTemplate
+{
+    struct Segment
+    {
+        // Position of the literal text within Message::message
+        uint16_t offset;
+        uint16_t length;
+        // 1 based MessageArg number, or 0 for literal text
+        uint8_t arg;
+    };
+
+    // A Message has at most 5 args, so 16 segments leaves room for repeats.
+    // Overflowing this fails the constant evaluation
+    static constexpr std::size_t maxSegments = 16;
+
+    const Message* message;
+    std::array<Segment, maxSegments> segments;
+    std::size_t segmentCount;
+    // Total length of the literal text
+    std::size_t literalSize;
+};
+
+/**
+ * @brief Splits a Message on its %1 to %9 placeholders
+ */
+constexpr MessageTemplate makeMessageTemplate(const Message& message)
+{
+    MessageTemplate messageTemplate{&message, {}, 0, 0};
+    std::string_view text(message.message);
+    std::size_t literalStart = 0;
+    auto addSegment = [&messageTemplate](std::size_t offset, std::size_t length,
+                                         uint8_t arg) {
+        messageTemplate.segments[messageTemplate.segmentCount++] = {
+            static_cast<uint16_t>(offset), static_cast<uint16_t>(length), arg};
+    };
+    for (std::size_t i = 0; i + 1 < text.size(); i++)
+    {
+        if (text[i] != '%' || text[i + 1] < '1' || text[i + 1] > '9')
+        {
+            continue;
+        }
+        if (i > literalStart)
+        {
+            addSegment(literalStart, i - literalStart, 0);
+            messageTemplate.literalSize += i - literalStart;
+        }
+        addSegment(i, 2, static_cast<uint8_t>(text[i + 1] - '0'));
+        literalStart = i + 2;
+        i++;
+    }
+    if (text.size() > literalStart)
+    {
+        addSegment(literalStart, text.size() - literalStart, 0);
+        messageTemplate.literalSize += text.size() - literalStart;
+    }
+    return messageTemplate;
+}
+
+/**
+ * @brief Appends a Message with its MessageArgs filled in
+ *
+ * @param[o] out              String to append to
+ * @param[i] messageTemplate  Parsed Message
+ * @param[i] args             MessageArgs, as a random access range of strings.
+ * Placeholders without a matching arg are left in the text.
+ */
+template <typename Args>
+void appendMessage(std::string& out, const MessageTemplate& messageTemplate,
+                   const Args& args)
+{
+    const char* text = messageTemplate.message->message;
+    const std::size_t argCount = std::size(args);
+    std::size_t size = out.size() + messageTemplate.literalSize;
+    for (std::size_t i = 0; i < messageTemplate.segmentCount; i++)
+    {
+        const MessageTemplate::Segment& segment = messageTemplate.segments[i];
+        if (segment.arg != 0)
+        {
+            size += segment.arg <= argCount
+                        ? std::size(std::begin(args)[segment.arg - 1])
+                        : segment.length;
+        }
+    }
+    out.reserve(size);
+
+    for (std::size_t i = 0; i < messageTemplate.segmentCount; i++)
+    {
+        const MessageTemplate::Segment& segment = messageTemplate.segments[i];
+        if (segment.arg != 0 && segment.arg <= argCount)
+        {
+            const auto& arg = std::begin(args)[segment.arg - 1];
+            out.append(std::data(arg), std::size(arg));
+        }
+        else
+        {
+            out.append(text + segment.offset, segment.length);
+        }
+    }
+}
+
+/**
+ * @brief FNV-1a hash of a MessageKey, usable at compile time
+ */
+constexpr uint32_t hashMessageKey(std::string_view key)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : key)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Open addressing hash table from MessageKey to registry position,
+ * along with the parsed template of every Message
+ *
+ * Built at compile time alongside each registry, so finding a message is a
+ * hash and, almost always, a single string compare.
+ */
+template <std::size_t N>
+struct RegistryIndex
+{
+    static_assert(N < std::numeric_limits<uint16_t>::max(),
+                  "Registry too large to index");
+
+    static constexpr uint16_t emptySlot = std::numeric_limits<uint16_t>::max();
+
+    // At most half full, so probe sequences stay short
+    static constexpr std::size_t tableSize = []() {
+        std::size_t size = 1;
+        while (size < N * 2)
+        {
+            size *= 2;
+        }
+        return size;
+    }();
+
+    std::array<uint16_t, tableSize> slots{};
+    std::array<MessageTemplate, N> templates{};
+};
+
+template <std::size_t N>
+constexpr RegistryIndex<N>
+    makeRegistryIndex(const std::array<MessageEntry, N>& registry)
+{
+    RegistryIndex<N> index{};
+    for (uint16_t& slot : index.slots)
+    {
+        slot = RegistryIndex<N>::emptySlot;
+    }
+    for (std::size_t i = 0; i < N; i++)
+    {
+        std::size_t pos = hashMessageKey(registry[i].first) &
+                          (RegistryIndex<N>::tableSize - 1);
+        while (index.slots[pos] != RegistryIndex<N>::emptySlot)
+        {
+            pos = (pos + 1) & (RegistryIndex<N>::tableSize - 1);
+        }
+        index.slots[pos] = static_cast<uint16_t>(i);
+        index.templates[i] = makeMessageTemplate(registry[i].second);
+    }
+    return index;
+}
+
+// Registry position of a MessageKey, or N if it isn't in the registry
+template <std::size_t N>
+constexpr std::size_t
+    findMessagePosition(std::string_view messageKey,
+                        const std::array<MessageEntry, N>& registry,
+                        const RegistryIndex<N>& index)
+{
+    std::size_t pos =
+        hashMessageKey(messageKey) & (RegistryIndex<N>::tableSize - 1);
+    while (index.slots[pos] != RegistryIndex<N>::emptySlot)
+    {
+        if (messageKey == registry[index.slots[pos]].first)
+        {
+            return index.slots[pos];
+        }
+        pos = (pos + 1) & (RegistryIndex<N>::tableSize - 1);
+    }
+    return N;
+}
+
+/**
+ * @brief Finds a message in a registry through its index
+ *
+ * @param[in] messageKey  MessageKey part of the MessageId
+ * @param[in] registry    Registry to search
+ * @param[in] index       Index built over the registry by makeRegistryIndex
+ *
+ * @return The message, or nullptr if the registry doesn't contain it
+ */
+template <std::size_t N>
+constexpr const Message*
+    getMessageFromRegistry(std::string_view messageKey,
+                           const std::array<MessageEntry, N>& registry,
+                           const RegistryIndex<N>& index)
+{
+    std::size_t position = findMessagePosition(messageKey, registry, index);
+    if (position == N)
+    {
+        return nullptr;
+    }
+    return &registry[position].second;
+}
+
+/**
+ * @brief Finds the parsed template of a message through the registry index
+ *
+ * @param[in] messageKey  MessageKey part of the MessageId
+ * @param[in] registry    Registry to search
+ * @param[in] index       Index built over the registry by makeRegistryIndex
+ *
+ * @return The template, or nullptr if the registry doesn't contain the message
+ */
+template <std::size_t N>
+constexpr const MessageTemplate*
+    getMessageTemplateFromRegistry(std::string_view messageKey,
+                                   const std::array<MessageEntry, N>& registry,
+                                   const RegistryIndex<N>& index)
+{
+    std::size_t position = findMessagePosition(messageKey, registry, index);
+    if (position == N)
+    {
+        return nullptr;
+    }
+    return &index.templates[position];
+}
 } // namespace redfish::message_registries
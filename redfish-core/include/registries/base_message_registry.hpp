@@ -33,7 +33,7 @@ const Header header = {
     .registryVersion = "1.4.0",
     .owningEntity = "DMTF",
 };
-const std::array registry = {
+constexpr std::array registry = {
     MessageEntry{
         "AccessDenied",
         {
@@ -964,4 +964,7 @@ const std::array registry = {
                           "if it failed.",
         }},
 };
+
+constexpr RegistryIndex<registry.size()> registryIndex =
+    makeRegistryIndex(registry);
 } // namespace redfish::message_registries::base
@@ -29,7 +29,7 @@ const Header header = {
     .registryVersion = "0.1.0",
     .owningEntity = "OpenBMC",
 };
-const std::array registry = {
+constexpr std::array registry = {
     MessageEntry{
         "ADDDCCorrectable",
         {
@@ -1324,4 +1324,7 @@ const std::array registry = {
             .resolution = "None.",
         }},
 };
+
+constexpr RegistryIndex<registry.size()> registryIndex =
+    makeRegistryIndex(registry);
 } // namespace redfish::message_registries::openbmc
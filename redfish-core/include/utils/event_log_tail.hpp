@@ -0,0 +1,356 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include "utils/event_log_utils.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <cerrno>
+#include <crow/logging.h>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+namespace event_log_util
+{
+
+/**
+ * @brief Follows the redfish event log and keeps the newest entries parsed
+ *
+ * The log directory is watched with inotify, so the line index is refreshed
+ * when rsyslog appends, rotates or removes a log file instead of on every
+ * request.  The most recent entries are kept as ready to serve LogEntry JSON,
+ * which covers the common "newest page" and recent single entry queries
+ * without touching the log files.  If the directory can't be watched, the
+ * index is refreshed on every request as before.
+ */
+class EventLogTail
+{
+  public:
+    static constexpr size_t maxRecentEntries = 256;
+
+    // Builds the LogEntry JSON of a log line, returning 0 on success
+    using Formatter = std::function<int(
+        const std::string &, const std::string &, nlohmann::json &)>;
+
+    /**
+     * @brief Starts following a log
+     *
+     * @param[i] ioc          Context the inotify watch runs on
+     * @param[i] logDir       Directory holding the log files
+     * @param[i] logFilename  Name of the newest log file, which the rotated
+     * files start with
+     * @param[i] formatter    Turns a log line into its LogEntry JSON
+     */
+    EventLogTail(boost::asio::io_context &ioc, std::string logDir,
+                 std::string logFilename, Formatter formatter) :
+        logIndex(EventLogIndex::getInstance()),
+        inotifyConn(ioc), logDir(std::move(logDir)),
+        logFilename(std::move(logFilename)), formatter(std::move(formatter))
+    {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+        {
+            BMCWEB_LOG_ERROR << "inotify_init1 failed: " << strerror(errno);
+            return;
+        }
+        if (inotify_add_watch(fd, this->logDir.c_str(),
+                              IN_MODIFY | IN_CREATE | IN_DELETE |
+                                  IN_MOVED_FROM | IN_MOVED_TO) < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to watch " << this->logDir << ": "
+                             << strerror(errno);
+            close(fd);
+            return;
+        }
+        inotifyConn.assign(fd);
+        watching = true;
+        refresh();
+        watch();
+    }
+
+    /**
+     * @brief Returns an up to date line index of the event log
+     */
+    EventLogIndex &getIndex()
+    {
+        if (!watching)
+        {
+            refresh();
+            return logIndex;
+        }
+
+        // Changes the watch hasn't been woken up for yet are read here, so a
+        // request never sees the log as it was before an earlier write
+        alignas(inotify_event) std::array<char, 4096> pending;
+        bool changed = false;
+        while (true)
+        {
+            ssize_t bytes = read(inotifyConn.native_handle(), pending.data(),
+                                 pending.size());
+            if (bytes <= 0)
+            {
+                break;
+            }
+            changed |= parseEvents(pending.data(),
+                                   static_cast<std::size_t>(bytes));
+        }
+        if (changed)
+        {
+            refresh();
+        }
+        return logIndex;
+    }
+
+    /**
+     * @brief Returns the entry at a position of the log, oldest first, if it
+     * is one of the recent entries held in memory
+     */
+    const nlohmann::json *getRecentEntry(uint64_t position) const
+    {
+        uint64_t total = logIndex.size();
+        if (position >= total || total - position > recentEntries.size())
+        {
+            return nullptr;
+        }
+        return &recentEntries[recentEntries.size() - (total - position)]
+                    .second;
+    }
+
+    /**
+     * @brief Returns the entry with the given ID, if it is one of the recent
+     * entries held in memory
+     */
+    const nlohmann::json *findRecentEntry(std::string_view entryID) const
+    {
+        for (auto it = recentEntries.rbegin(); it != recentEntries.rend();
+             it++)
+        {
+            if (it->first == entryID)
+            {
+                return &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    void clear()
+    {
+        logIndex.clear();
+        recentEntries.clear();
+    }
+
+    /**
+     * @brief Registers a callback for entries appended to the log
+     *
+     * @param[i] listener  Called with the LogEntry JSON of each new entry
+     */
+    void addListener(std::function<void(const nlohmann::json &)> &&listener)
+    {
+        listeners.emplace_back(std::move(listener));
+    }
+
+    EventLogTail(const EventLogTail &) = delete;
+    EventLogTail &operator=(const EventLogTail &) = delete;
+
+  private:
+    void watch()
+    {
+        inotifyConn.async_read_some(
+            boost::asio::buffer(readBuffer),
+            [this](const boost::system::error_code &ec,
+                   std::size_t bytesTransferred) {
+                if (ec)
+                {
+                    if (ec != boost::asio::error::operation_aborted)
+                    {
+                        BMCWEB_LOG_ERROR << "Event log watch failed: " << ec;
+                        watching = false;
+                    }
+                    return;
+                }
+                if (parseEvents(readBuffer.data(), bytesTransferred))
+                {
+                    refresh();
+                }
+                watch();
+            });
+    }
+
+    // Returns true if any of the events read touch the log files
+    bool parseEvents(const char *events, std::size_t bytesTransferred) const
+    {
+        bool changed = false;
+        std::size_t pos = 0;
+        while (pos + sizeof(inotify_event) <= bytesTransferred)
+        {
+            const inotify_event *event =
+                reinterpret_cast<const inotify_event *>(&events[pos]);
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len > 0 &&
+                 boost::starts_with(std::string_view(event->name),
+                                    logFilename)))
+            {
+                changed = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+        return changed;
+    }
+
+    // Log files ordered from oldest to newest
+    std::vector<std::filesystem::path> getLogFiles() const
+    {
+        std::vector<std::filesystem::path> logFiles;
+        std::error_code ec;
+        for (const std::filesystem::directory_entry &dirEnt :
+             std::filesystem::directory_iterator(logDir, ec))
+        {
+            if (boost::starts_with(dirEnt.path().filename().string(),
+                                   logFilename))
+            {
+                logFiles.emplace_back(dirEnt.path());
+            }
+        }
+        // As the log files rotate, they are appended with a ".#" that is
+        // higher for the older logs. Since we don't expect more than 10 log
+        // files, sorting in reverse puts them in order from oldest to newest
+        std::sort(logFiles.rbegin(), logFiles.rend());
+        return logFiles;
+    }
+
+    void refresh()
+    {
+        logIndex.update(getLogFiles());
+
+        uint64_t total = logIndex.size();
+        uint64_t first = total > maxRecentEntries ? total - maxRecentEntries : 0;
+        std::vector<std::string> entryIDs =
+            logIndex.getEntryIDs(first, maxRecentEntries);
+
+        // Keep whatever is still within the window, which normally is all
+        // but the entries pushed out by the newly appended ones
+        std::size_t kept = 0;
+        if (!recentEntries.empty())
+        {
+            auto newest = std::find(entryIDs.rbegin(), entryIDs.rend(),
+                                    recentEntries.back().first);
+            kept = static_cast<std::size_t>(entryIDs.rend() - newest);
+        }
+        while (recentEntries.size() > kept)
+        {
+            recentEntries.pop_front();
+        }
+        if (recentEntries.size() != kept ||
+            !std::equal(recentEntries.begin(), recentEntries.end(),
+                        entryIDs.begin(),
+                        [](const auto &entry, const std::string &entryID) {
+                            return entry.first == entryID;
+                        }))
+        {
+            recentEntries.clear();
+            kept = 0;
+        }
+
+        // Then parse only the entries that are new
+        bool entriesValid = logIndex.getEntries(
+            first + kept, entryIDs.size() - kept,
+            [this](const std::string &idStr, const std::string &logEntry) {
+                nlohmann::json entry;
+                if (formatter(idStr, logEntry, entry) != 0)
+                {
+                    return false;
+                }
+                recentEntries.emplace_back(idStr, std::move(entry));
+                return true;
+            });
+        if (!entriesValid || recentEntries.size() != entryIDs.size())
+        {
+            // Let requests go to the files, which reports the error
+            recentEntries.clear();
+            return;
+        }
+        notifyListeners();
+    }
+
+    // Passes on the entries after the last one that was reported
+    void notifyListeners()
+    {
+        if (recentEntries.empty())
+        {
+            return;
+        }
+        auto first = recentEntries.begin();
+        if (!lastNotifiedID.empty())
+        {
+            auto last = std::find_if(
+                recentEntries.rbegin(), recentEntries.rend(),
+                [this](const auto &entry) {
+                    return entry.first == lastNotifiedID;
+                });
+            // If it's gone, the log was cleared or rotated past it, so
+            // everything held is new
+            if (last != recentEntries.rend())
+            {
+                first = last.base();
+            }
+        }
+        if (!listeners.empty())
+        {
+            for (auto it = first; it != recentEntries.end(); it++)
+            {
+                for (const auto &listener : listeners)
+                {
+                    listener(it->second);
+                }
+            }
+        }
+        lastNotifiedID = recentEntries.back().first;
+    }
+
+    EventLogIndex &logIndex;
+    boost::asio::posix::stream_descriptor inotifyConn;
+    alignas(inotify_event) std::array<char, 4096> readBuffer;
+    bool watching = false;
+    std::string logDir;
+    std::string logFilename;
+    Formatter formatter;
+    // Newest entries of the log, oldest first, keyed by entry ID
+    std::deque<std::pair<std::string, nlohmann::json>> recentEntries;
+    std::vector<std::function<void(const nlohmann::json &)>> listeners;
+    // Newest entry passed to the listeners, or that existed before any were
+    // registered
+    std::string lastNotifiedID;
+};
+
+} // namespace event_log_util
+} // namespace redfish
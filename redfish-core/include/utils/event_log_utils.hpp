@@ -0,0 +1,537 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/container/flat_map.hpp>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace redfish
+{
+
+namespace event_log_util
+{
+
+/**
+ * @brief Reads the timestamp at the start of a redfish log entry
+ *
+ * @param[i] logEntry  Log line in the "<Timestamp> <MessageId>,<MessageArgs>"
+ * format
+ *
+ * @return Seconds since the epoch, or 0 if the timestamp couldn't be parsed
+ */
+inline uint64_t getEntryTimestamp(const std::string &logEntry)
+{
+    uint64_t curTs = 0;
+    std::tm timeStruct = {};
+    std::istringstream entryStream(logEntry);
+    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+    {
+        curTs = std::mktime(&timeStruct);
+    }
+    return curTs;
+}
+
+/**
+ * @brief Parses entry timestamps in bulk
+ *
+ * Produces the same values as getEntryTimestamp, but avoids a stream and a
+ * mktime call per line by converting each hour only once.  The tm struct has
+ * tm_isdst cleared, so within an hour the result is linear in the minutes and
+ * seconds.
+ */
+class EntryTimestampParser
+{
+  public:
+    uint64_t parse(const std::string &logEntry)
+    {
+        // "YYYY-MM-DDTHH:MM:SS"
+        constexpr std::string_view format = "0000-00-00T00:00:00";
+        if (logEntry.size() < format.size())
+        {
+            return getEntryTimestamp(logEntry);
+        }
+        for (size_t i = 0; i < format.size(); i++)
+        {
+            bool isDigit = logEntry[i] >= '0' && logEntry[i] <= '9';
+            if ((format[i] == '0') != isDigit ||
+                (!isDigit && format[i] != logEntry[i]))
+            {
+                return getEntryTimestamp(logEntry);
+            }
+        }
+
+        auto number = [&logEntry](size_t pos, size_t len) {
+            int value = 0;
+            for (size_t i = pos; i < pos + len; i++)
+            {
+                value = value * 10 + (logEntry[i] - '0');
+            }
+            return value;
+        };
+        int minutes = number(14, 2);
+        int seconds = number(17, 2);
+        if (minutes > 59 || seconds > 60)
+        {
+            return getEntryTimestamp(logEntry);
+        }
+
+        std::string_view hour(logEntry.data(), hourKey.size());
+        if (!hourValid || hour != std::string_view(hourKey.data(),
+                                                   hourKey.size()))
+        {
+            std::copy(hour.begin(), hour.end(), hourKey.begin());
+            hourValid = true;
+            hourStart = getEntryTimestamp(std::string(hour) + ":00:00");
+        }
+        if (hourStart == 0)
+        {
+            return getEntryTimestamp(logEntry);
+        }
+        return hourStart + static_cast<uint64_t>(minutes * 60 + seconds);
+    }
+
+  private:
+    // "YYYY-MM-DDTHH" of the last converted hour
+    std::array<char, 13> hourKey{};
+    bool hourValid = false;
+    uint64_t hourStart = 0;
+};
+
+/**
+ * @brief Builds the Redfish entry ID from a timestamp and its duplicate index
+ */
+inline std::string makeEntryID(uint64_t timestamp, uint32_t index)
+{
+    std::string entryID = std::to_string(timestamp);
+    if (index > 0)
+    {
+        entryID += "_" + std::to_string(index);
+    }
+    return entryID;
+}
+
+/**
+ * @brief Splits an entry ID built by makeEntryID back into its parts
+ *
+ * @return false if the ID is malformed
+ */
+inline bool parseEntryID(std::string_view entryID, uint64_t &timestamp,
+                         uint32_t &index)
+{
+    auto parseNumber = [](std::string_view str, uint64_t &value) {
+        if (str.empty() || str.size() > 20)
+        {
+            return false;
+        }
+        value = 0;
+        for (char c : str)
+        {
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+            uint64_t digit = static_cast<uint64_t>(c - '0');
+            if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+            {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
+    };
+
+    index = 0;
+    std::string_view tsStr = entryID;
+    size_t underscorePos = entryID.find('_');
+    if (underscorePos != std::string_view::npos)
+    {
+        tsStr = entryID.substr(0, underscorePos);
+        uint64_t indexValue = 0;
+        if (!parseNumber(entryID.substr(underscorePos + 1), indexValue) ||
+            indexValue == 0 ||
+            indexValue > std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+        index = static_cast<uint32_t>(indexValue);
+    }
+    return parseNumber(tsStr, timestamp);
+}
+
+/**
+ * @brief Line offset index over the rotated redfish event log files
+ *
+ * Each file is indexed once, keyed by inode, and then extended incrementally
+ * as rsyslog appends to it.  Since rotation renames files without changing
+ * their inode, rotated files keep their index.  A file whose indexed lines no
+ * longer match, because it was truncated or rewritten in place, is indexed
+ * again.  Paged reads and single entry lookups seek straight to the requested
+ * lines instead of reading every file from the beginning.
+ */
+class EventLogIndex
+{
+  public:
+    static EventLogIndex &getInstance()
+    {
+        static EventLogIndex index;
+        return index;
+    }
+
+    /**
+     * @brief Brings the index in sync with the given log files
+     *
+     * @param[i] logFiles  Redfish log files, ordered from oldest to newest
+     */
+    void update(const std::vector<std::filesystem::path> &logFiles)
+    {
+        boost::container::flat_map<ino_t, FileIndex> updated;
+        updated.reserve(logFiles.size());
+        order.clear();
+        totalEntries = 0;
+
+        for (const std::filesystem::path &logFile : logFiles)
+        {
+            struct stat st = {};
+            if (stat(logFile.c_str(), &st) != 0)
+            {
+                continue;
+            }
+
+            FileIndex fileIndex;
+            auto existing = files.find(st.st_ino);
+            if (existing != files.end() &&
+                static_cast<uint64_t>(st.st_size) >= existing->second.size &&
+                isUnchanged(existing->second, logFile))
+            {
+                fileIndex = std::move(existing->second);
+            }
+            fileIndex.path = logFile;
+            if (static_cast<uint64_t>(st.st_size) != fileIndex.size)
+            {
+                extend(fileIndex);
+            }
+            totalEntries += fileIndex.lines.size();
+            order.push_back(st.st_ino);
+            updated.emplace(st.st_ino, std::move(fileIndex));
+        }
+        files = std::move(updated);
+    }
+
+    /**
+     * @brief Drops everything that has been indexed
+     */
+    void clear()
+    {
+        files.clear();
+        order.clear();
+        totalEntries = 0;
+    }
+
+    /**
+     * @brief Number of entries across all files at the time of the last update
+     */
+    uint64_t size() const
+    {
+        return totalEntries;
+    }
+
+    /**
+     * @brief Reads a page of entries, oldest first
+     *
+     * @param[i] skip     Number of entries to skip
+     * @param[i] top      Maximum number of entries to read
+     * @param[i] handler  Called as handler(entryID, logEntry) for each entry.
+     * Returning false stops the iteration.
+     *
+     * @return false if a log file could not be read
+     */
+    template <typename Handler>
+    bool getEntries(uint64_t skip, uint64_t top, Handler &&handler) const
+    {
+        std::string logEntry;
+        for (ino_t inode : order)
+        {
+            if (top == 0)
+            {
+                break;
+            }
+            const FileIndex &fileIndex = files.find(inode)->second;
+            if (skip >= fileIndex.lines.size())
+            {
+                skip -= fileIndex.lines.size();
+                continue;
+            }
+
+            std::ifstream logStream(fileIndex.path);
+            if (!logStream.is_open())
+            {
+                return false;
+            }
+            logStream.seekg(fileIndex.lines[skip].offset);
+            for (size_t line = skip; line < fileIndex.lines.size() && top > 0;
+                 line++, top--)
+            {
+                if (!std::getline(logStream, logEntry))
+                {
+                    return false;
+                }
+                const LineRecord &record = fileIndex.lines[line];
+                if (!handler(makeEntryID(record.timestamp, record.index),
+                             logEntry))
+                {
+                    return true;
+                }
+            }
+            skip = 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lists the IDs of a range of entries, oldest first, without
+     * reading the log files
+     *
+     * @param[i] skip  Number of entries to skip
+     * @param[i] top   Maximum number of IDs to return
+     *
+     * @return The entry IDs
+     */
+    std::vector<std::string> getEntryIDs(uint64_t skip, uint64_t top) const
+    {
+        std::vector<std::string> entryIDs;
+        for (ino_t inode : order)
+        {
+            const FileIndex &fileIndex = files.find(inode)->second;
+            if (skip >= fileIndex.lines.size())
+            {
+                skip -= fileIndex.lines.size();
+                continue;
+            }
+            for (size_t line = skip; line < fileIndex.lines.size() && top > 0;
+                 line++, top--)
+            {
+                const LineRecord &record = fileIndex.lines[line];
+                entryIDs.emplace_back(
+                    makeEntryID(record.timestamp, record.index));
+            }
+            skip = 0;
+        }
+        return entryIDs;
+    }
+
+    /**
+     * @brief Reads a single entry by its ID
+     *
+     * @param[i] entryID   ID built by makeEntryID
+     * @param[o] logEntry  The matching log line
+     *
+     * @return true if the entry was found
+     */
+    bool findEntry(std::string_view entryID, std::string &logEntry) const
+    {
+        uint64_t timestamp = 0;
+        uint32_t index = 0;
+        if (!parseEntryID(entryID, timestamp, index))
+        {
+            return false;
+        }
+
+        for (ino_t inode : order)
+        {
+            const FileIndex &fileIndex = files.find(inode)->second;
+            auto run = std::lower_bound(
+                fileIndex.runs.begin(), fileIndex.runs.end(),
+                RunStart{timestamp, 0},
+                [](const RunStart &lhs, const RunStart &rhs) {
+                    return lhs.timestamp < rhs.timestamp;
+                });
+            for (; run != fileIndex.runs.end() && run->timestamp == timestamp;
+                 run++)
+            {
+                uint64_t line = static_cast<uint64_t>(run->line) + index;
+                if (line >= fileIndex.lines.size() ||
+                    fileIndex.lines[line].timestamp != timestamp ||
+                    fileIndex.lines[line].index != index)
+                {
+                    continue;
+                }
+                std::ifstream logStream(fileIndex.path);
+                if (!logStream.is_open())
+                {
+                    return false;
+                }
+                logStream.seekg(fileIndex.lines[line].offset);
+                return static_cast<bool>(std::getline(logStream, logEntry));
+            }
+        }
+        return false;
+    }
+
+    EventLogIndex(const EventLogIndex &) = delete;
+    EventLogIndex &operator=(const EventLogIndex &) = delete;
+
+  private:
+    EventLogIndex() = default;
+
+    struct LineRecord
+    {
+        uint64_t timestamp;
+        uint32_t offset;
+        uint32_t index;
+    };
+
+    // First line of a run of entries with the same timestamp
+    struct RunStart
+    {
+        uint64_t timestamp;
+        uint32_t line;
+    };
+
+    struct FileIndex
+    {
+        std::filesystem::path path;
+        // Bytes indexed so far.  Always ends on a line boundary
+        uint64_t size = 0;
+        std::vector<LineRecord> lines;
+        // Sorted by timestamp, and by line within a timestamp, so an entry
+        // ID is found with a binary search
+        std::vector<RunStart> runs;
+        // Kept to notice the file being rewritten in place
+        std::string firstLine;
+    };
+
+    // Checks that the lines indexed so far are still at the start of the file
+    static bool isUnchanged(const FileIndex &fileIndex,
+                            const std::filesystem::path &logFile)
+    {
+        if (fileIndex.size == 0)
+        {
+            return true;
+        }
+        std::ifstream logStream(logFile);
+        std::string line;
+        if (!std::getline(logStream, line) || line != fileIndex.firstLine)
+        {
+            return false;
+        }
+        // The indexed part must still end with a complete line
+        logStream.seekg(fileIndex.size - 1);
+        return logStream.get() == '\n';
+    }
+
+    // Indexes any complete lines that were appended since the last call
+    static void extend(FileIndex &fileIndex)
+    {
+        std::ifstream logStream(fileIndex.path);
+        if (!logStream.is_open())
+        {
+            return;
+        }
+        logStream.seekg(fileIndex.size);
+
+        // Duplicate timestamps within a file are numbered in order, so carry
+        // on from the last indexed line
+        uint64_t prevTs = 0;
+        uint32_t index = 0;
+        if (!fileIndex.lines.empty())
+        {
+            prevTs = fileIndex.lines.back().timestamp;
+            index = fileIndex.lines.back().index;
+        }
+
+        EntryTimestampParser parser;
+        std::string logEntry;
+        size_t sortedRuns = fileIndex.runs.size();
+        while (std::getline(logStream, logEntry))
+        {
+            // A line without its newline is still being written, so leave it
+            // for the next update
+            if (logStream.eof())
+            {
+                break;
+            }
+            uint64_t offset = fileIndex.size;
+            if (offset > std::numeric_limits<uint32_t>::max())
+            {
+                break;
+            }
+            fileIndex.size += logEntry.size() + 1;
+
+            uint64_t curTs = parser.parse(logEntry);
+            if (!fileIndex.lines.empty() && curTs == prevTs)
+            {
+                index++;
+            }
+            else
+            {
+                index = 0;
+            }
+            prevTs = curTs;
+            if (index == 0)
+            {
+                fileIndex.runs.push_back(
+                    {curTs, static_cast<uint32_t>(fileIndex.lines.size())});
+            }
+            if (fileIndex.lines.empty())
+            {
+                fileIndex.firstLine = logEntry;
+            }
+            fileIndex.lines.push_back(
+                {curTs, static_cast<uint32_t>(offset), index});
+        }
+
+        // Logs are written in time order, so the new runs normally already
+        // follow the old ones.  If the clock went back, sort them in, which
+        // keeps runs with the same timestamp in line order
+        auto byTimestamp = [](const RunStart &lhs, const RunStart &rhs) {
+            return lhs.timestamp < rhs.timestamp;
+        };
+        auto newRuns = fileIndex.runs.begin() +
+                       static_cast<std::ptrdiff_t>(sortedRuns);
+        if (!std::is_sorted(newRuns, fileIndex.runs.end(), byTimestamp))
+        {
+            std::stable_sort(newRuns, fileIndex.runs.end(), byTimestamp);
+        }
+        if (newRuns != fileIndex.runs.begin() &&
+            newRuns != fileIndex.runs.end() &&
+            byTimestamp(*newRuns, *(newRuns - 1)))
+        {
+            std::inplace_merge(fileIndex.runs.begin(), newRuns,
+                               fileIndex.runs.end(), byTimestamp);
+        }
+    }
+
+    boost::container::flat_map<ino_t, FileIndex> files;
+    // Inodes of the indexed files, oldest first
+    std::vector<ino_t> order;
+    uint64_t totalEntries = 0;
+};
+
+} // namespace event_log_util
+} // namespace redfish
@@ -0,0 +1,227 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace redfish
+{
+
+namespace event_util
+{
+
+/**
+ * @brief Bounded queue of event records waiting to be delivered
+ *
+ * Records that describe the latest state of something, such as a sensor
+ * reading, carry a coalescing key.  Queuing a record with the key of one that
+ * is still waiting replaces that record in place, so a slow subscriber gets
+ * the current value once instead of every intermediate one.  When the queue is
+ * full, the oldest record is dropped.
+ */
+class EventQueue
+{
+  public:
+    explicit EventQueue(size_t capacity) : capacity(capacity)
+    {
+    }
+
+    /**
+     * @brief Queues an event record
+     *
+     * @param[i] coalesceKey  Key of the state the record describes, or empty
+     * if every record must be delivered
+     * @param[i] record       Redfish EventRecord
+     *
+     * @return false if an older record had to be dropped to make room
+     */
+    bool push(const std::string &coalesceKey, nlohmann::json &&record)
+    {
+        if (!coalesceKey.empty())
+        {
+            auto pending = keyed.find(coalesceKey);
+            if (pending != keyed.end())
+            {
+                pending->second->record = std::move(record);
+                coalescedCount++;
+                return true;
+            }
+        }
+
+        bool room = true;
+        if (entries.size() >= capacity)
+        {
+            popFront();
+            droppedCount++;
+            room = false;
+        }
+        entries.push_back({coalesceKey, std::move(record)});
+        if (!coalesceKey.empty())
+        {
+            keyed.emplace(coalesceKey, std::prev(entries.end()));
+        }
+        return room;
+    }
+
+    /**
+     * @brief Removes up to maxRecords records, oldest first
+     */
+    std::vector<nlohmann::json> take(size_t maxRecords)
+    {
+        std::vector<nlohmann::json> records;
+        while (!entries.empty() && records.size() < maxRecords)
+        {
+            records.emplace_back(std::move(entries.front().record));
+            popFront();
+        }
+        return records;
+    }
+
+    void clear()
+    {
+        entries.clear();
+        keyed.clear();
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    bool empty() const
+    {
+        return entries.empty();
+    }
+
+    // Records lost because the queue was full
+    uint64_t dropped() const
+    {
+        return droppedCount;
+    }
+
+    // Records merged into one that was already queued
+    uint64_t coalesced() const
+    {
+        return coalescedCount;
+    }
+
+  private:
+    struct Entry
+    {
+        std::string coalesceKey;
+        nlohmann::json record;
+    };
+
+    void popFront()
+    {
+        if (!entries.front().coalesceKey.empty())
+        {
+            keyed.erase(entries.front().coalesceKey);
+        }
+        entries.pop_front();
+    }
+
+    size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> keyed;
+    uint64_t droppedCount = 0;
+    uint64_t coalescedCount = 0;
+};
+
+/**
+ * @brief Splits an event destination URL into what is needed to connect
+ *
+ * Only plain http destinations of the form http://host[:port][/path] are
+ * accepted.
+ *
+ * @param[i] url     Destination URL
+ * @param[o] host    Host name or address
+ * @param[o] port    Port, 80 if not given
+ * @param[o] target  Path and query to POST to, / if not given
+ *
+ * @return true if the URL could be parsed
+ */
+inline bool parseDestination(std::string_view url, std::string &host,
+                             std::string &port, std::string &target)
+{
+    constexpr std::string_view scheme = "http://";
+    if (url.substr(0, scheme.size()) != scheme)
+    {
+        return false;
+    }
+    url.remove_prefix(scheme.size());
+
+    size_t pathStart = url.find('/');
+    std::string_view authority = url.substr(0, pathStart);
+    target = pathStart == std::string_view::npos
+                 ? "/"
+                 : std::string(url.substr(pathStart));
+
+    // Credentials in the URL aren't supported
+    if (authority.find('@') != std::string_view::npos)
+    {
+        return false;
+    }
+    std::string_view hostView = authority;
+    std::string_view portView = "80";
+    if (!authority.empty() && authority.front() == '[')
+    {
+        // IPv6 literal, [addr] or [addr]:port
+        size_t hostEnd = authority.find(']');
+        if (hostEnd == std::string_view::npos)
+        {
+            return false;
+        }
+        hostView = authority.substr(1, hostEnd - 1);
+        std::string_view rest = authority.substr(hostEnd + 1);
+        if (!rest.empty())
+        {
+            if (rest.front() != ':')
+            {
+                return false;
+            }
+            portView = rest.substr(1);
+        }
+    }
+    else
+    {
+        size_t colon = authority.find(':');
+        if (colon != std::string_view::npos)
+        {
+            hostView = authority.substr(0, colon);
+            portView = authority.substr(colon + 1);
+        }
+    }
+
+    if (hostView.empty() || portView.empty() || portView.size() > 5 ||
+        portView.find_first_not_of("0123456789") != std::string_view::npos ||
+        std::stoul(std::string(portView)) > 65535)
+    {
+        return false;
+    }
+    host = hostView;
+    port = portView;
+    return true;
+}
+
+} // namespace event_util
+} // namespace redfish
@@ -0,0 +1,269 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <algorithm>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/container/flat_set.hpp>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+namespace health_util
+{
+
+enum class Health
+{
+    ok,
+    warning,
+    critical,
+};
+
+inline const char *toString(Health health)
+{
+    switch (health)
+    {
+        case Health::critical:
+            return "Critical";
+        case Health::warning:
+            return "Warning";
+        default:
+            return "OK";
+    }
+}
+
+// Status associations by path, with their endpoints
+using StatusAssociations =
+    std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+/**
+ * @brief Checks whether a path is a status association, which the mapper
+ * names <object>/critical or <object>/warning
+ */
+inline bool isStatusAssociation(const std::string &path)
+{
+    return boost::ends_with(path, "critical") ||
+           boost::ends_with(path, "warning");
+}
+
+/**
+ * @brief Folds one status association into a health and rollup
+ */
+inline void applyStatus(const std::string &path,
+                        const std::string &globalInventoryPath,
+                        Health &health, Health &rollup)
+{
+    bool global = boost::starts_with(path, globalInventoryPath);
+    Health status = boost::ends_with(path, "critical") ? Health::critical
+                                                       : Health::warning;
+    if (global)
+    {
+        health = std::max(health, status);
+    }
+    rollup = std::max(rollup, status);
+}
+
+/**
+ * @brief Computes health by checking every status association against the
+ * inventory
+ *
+ * This is the rollup done by each request before the index existed.  It
+ * visits every association, so HealthIndex is used instead; this is kept to
+ * check the index against.
+ *
+ * @param[i] statuses             Status associations
+ * @param[i] inventory            Inventory items to roll up, ignored if
+ * allInventory is set
+ * @param[i] allInventory         Roll up every status
+ * @param[i] globalInventoryPath  Item whose status is the health itself
+ * @param[o] health               Health of the resource
+ * @param[o] rollup               Health of the resource and what it contains
+ */
+inline void getHealthByScan(const StatusAssociations &statuses,
+                            const std::vector<std::string> &inventory,
+                            bool allInventory,
+                            const std::string &globalInventoryPath,
+                            Health &health, Health &rollup)
+{
+    health = Health::ok;
+    rollup = Health::ok;
+    for (const auto &[path, endpoints] : statuses)
+    {
+        if (!isStatusAssociation(path))
+        {
+            continue;
+        }
+        if (!allInventory)
+        {
+            // We only want to look at this association if either the path
+            // of this association is an inventory item, or one of the
+            // endpoints in this association is a child
+            bool isChild = false;
+            for (const std::string &child : inventory)
+            {
+                if (boost::starts_with(path, child))
+                {
+                    isChild = true;
+                    break;
+                }
+            }
+            if (!isChild)
+            {
+                for (const std::string &endpoint : endpoints)
+                {
+                    if (std::find(inventory.begin(), inventory.end(),
+                                  endpoint) != inventory.end())
+                    {
+                        isChild = true;
+                        break;
+                    }
+                }
+            }
+            if (!isChild)
+            {
+                continue;
+            }
+        }
+        applyStatus(path, globalInventoryPath, health, rollup);
+    }
+}
+
+/**
+ * @brief In-memory index of the status associations
+ *
+ * Associations are sorted by path, so those under an inventory item are found
+ * with a range lookup, and indexed by endpoint, so those pointing at an item
+ * are found directly.  A rollup only visits the associations that concern
+ * the requested inventory.
+ */
+class HealthIndex
+{
+  public:
+    /**
+     * @brief Adds or updates an association, ignoring anything that isn't a
+     * status association
+     */
+    void set(const std::string &path, std::vector<std::string> &&endpoints)
+    {
+        if (!isStatusAssociation(path))
+        {
+            return;
+        }
+        remove(path);
+        for (const std::string &endpoint : endpoints)
+        {
+            byEndpoint[endpoint].insert(path);
+        }
+        statuses.emplace(path, std::move(endpoints));
+    }
+
+    void remove(const std::string &path)
+    {
+        auto it = statuses.find(path);
+        if (it == statuses.end())
+        {
+            return;
+        }
+        for (const std::string &endpoint : it->second)
+        {
+            auto endpointIt = byEndpoint.find(endpoint);
+            if (endpointIt == byEndpoint.end())
+            {
+                continue;
+            }
+            endpointIt->second.erase(path);
+            if (endpointIt->second.empty())
+            {
+                byEndpoint.erase(endpointIt);
+            }
+        }
+        statuses.erase(it);
+    }
+
+    void clear()
+    {
+        statuses.clear();
+        byEndpoint.clear();
+    }
+
+    void setGlobalInventoryPath(std::string &&path)
+    {
+        globalInventoryPath = std::move(path);
+    }
+
+    size_t size() const
+    {
+        return statuses.size();
+    }
+
+    /**
+     * @brief Computes health the same way as getHealthByScan
+     */
+    void getHealth(const std::vector<std::string> &inventory,
+                   bool allInventory, Health &health, Health &rollup) const
+    {
+        health = Health::ok;
+        rollup = Health::ok;
+        if (allInventory)
+        {
+            for (const auto &status : statuses)
+            {
+                applyStatus(status.first, globalInventoryPath, health, rollup);
+            }
+            return;
+        }
+
+        // An association can concern more than one item, but only counts
+        // once
+        boost::container::flat_set<const std::string *> found;
+        for (const std::string &item : inventory)
+        {
+            for (auto it = statuses.lower_bound(item);
+                 it != statuses.end() && boost::starts_with(it->first, item);
+                 it++)
+            {
+                found.insert(&it->first);
+            }
+            auto endpointIt = byEndpoint.find(item);
+            if (endpointIt != byEndpoint.end())
+            {
+                for (const std::string &path : endpointIt->second)
+                {
+                    found.insert(&statuses.find(path)->first);
+                }
+            }
+        }
+        for (const std::string *path : found)
+        {
+            applyStatus(*path, globalInventoryPath, health, rollup);
+        }
+    }
+
+  private:
+    std::map<std::string, std::vector<std::string>> statuses;
+    std::unordered_map<std::string, boost::container::flat_set<std::string>>
+        byEndpoint;
+    // Default to an illegal D-Bus path, which nothing starts with
+    std::string globalInventoryPath = "-";
+};
+
+} // namespace health_util
+} // namespace redfish
@@ -0,0 +1,432 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace redfish
+{
+
+namespace telemetry_util
+{
+
+struct TierConfig
+{
+    // Seconds covered by one sample
+    uint32_t interval;
+    size_t capacity;
+};
+
+// 5 minutes at full resolution, an hour at 10 seconds and 6 hours at 1 minute
+constexpr std::array<TierConfig, 3> defaultTiers = {
+    {{1, 300}, {10, 360}, {60, 360}}};
+
+struct MetricSample
+{
+    float min;
+    float max;
+    float avg;
+};
+
+/**
+ * @brief Fixed size history of a set of metrics that are sampled together
+ *
+ * Samples are kept in tiers of increasing interval.  The first tier holds the
+ * samples as taken, the others the minimum, maximum and average of each
+ * interval.  Every tier is a ring buffer, so memory use is fixed once a metric
+ * has been added, and adding a metric fails once the budget is used up.
+ *
+ * As all metrics are sampled at the same time, each tier keeps a single
+ * column of timestamps and one column per statistic, with the slots of each
+ * metric next to each other.  Readings that aren't available are stored as
+ * NaN.
+ */
+class MetricStore
+{
+  public:
+    static constexpr size_t tierCount = defaultTiers.size();
+
+    explicit MetricStore(
+        size_t memoryBudget,
+        const std::array<TierConfig, tierCount>& tierConfig = defaultTiers) :
+        memoryBudget(memoryBudget)
+    {
+        for (size_t i = 0; i < tierCount; i++)
+        {
+            tiers[i].interval = std::max<uint32_t>(tierConfig[i].interval, 1);
+            tiers[i].capacity = std::max<size_t>(tierConfig[i].capacity, 1);
+            tiers[i].timestamps.resize(tiers[i].capacity);
+        }
+    }
+
+    /**
+     * @brief Memory needed for each metric
+     */
+    size_t bytesPerMetric() const
+    {
+        size_t bytes = 0;
+        for (const Tier& tier : tiers)
+        {
+            if (tier.interval == 1)
+            {
+                bytes += tier.capacity * sizeof(float);
+            }
+            else
+            {
+                bytes += tier.capacity * sizeof(float) * 3 +
+                         sizeof(float) * 2 + sizeof(double) + sizeof(uint32_t);
+            }
+        }
+        return bytes;
+    }
+
+    size_t memoryUsed() const
+    {
+        return metricCount * bytesPerMetric();
+    }
+
+    size_t size() const
+    {
+        return metricCount;
+    }
+
+    /**
+     * @brief Adds a metric, which has no readings until the next sample
+     *
+     * @return Index of the metric, or nothing if it would exceed the budget
+     */
+    std::optional<size_t> addMetric()
+    {
+        if (memoryUsed() + bytesPerMetric() > memoryBudget)
+        {
+            return std::nullopt;
+        }
+        metricCount++;
+        for (Tier& tier : tiers)
+        {
+            size_t slots = metricCount * tier.capacity;
+            tier.avg.resize(slots, nan);
+            if (tier.interval != 1)
+            {
+                tier.min.resize(slots, nan);
+                tier.max.resize(slots, nan);
+                tier.accMin.push_back(nan);
+                tier.accMax.push_back(nan);
+                tier.accSum.push_back(0.0);
+                tier.accCount.push_back(0);
+            }
+        }
+        return metricCount - 1;
+    }
+
+    /**
+     * @brief Records one reading of every metric
+     *
+     * @param[i] timestamp  Seconds since the epoch, increasing between calls
+     * @param[i] values     Reading of each metric by index, NaN if unknown
+     */
+    void sample(uint64_t timestamp, const std::vector<float>& values)
+    {
+        for (Tier& tier : tiers)
+        {
+            if (tier.interval == 1)
+            {
+                size_t slot = tier.beginSlot();
+                tier.timestamps[slot] = timestamp;
+                for (size_t metric = 0; metric < metricCount; metric++)
+                {
+                    tier.avg[metric * tier.capacity + slot] =
+                        valueOf(values, metric);
+                }
+                tier.advance();
+                continue;
+            }
+
+            uint64_t bucket = timestamp / tier.interval;
+            if (tier.bucketOpen && bucket != tier.bucket)
+            {
+                closeBucket(tier);
+            }
+            tier.bucket = bucket;
+            tier.bucketOpen = true;
+            for (size_t metric = 0; metric < metricCount; metric++)
+            {
+                float value = valueOf(values, metric);
+                if (std::isnan(value))
+                {
+                    continue;
+                }
+                if (tier.accCount[metric] == 0)
+                {
+                    tier.accMin[metric] = value;
+                    tier.accMax[metric] = value;
+                }
+                else
+                {
+                    tier.accMin[metric] = std::min(tier.accMin[metric], value);
+                    tier.accMax[metric] = std::max(tier.accMax[metric], value);
+                }
+                tier.accSum[metric] += value;
+                tier.accCount[metric]++;
+            }
+        }
+    }
+
+    uint32_t interval(size_t tier) const
+    {
+        return tiers[tier].interval;
+    }
+
+    /**
+     * @brief Number of completed samples held in a tier
+     */
+    size_t sampleCount(size_t tier) const
+    {
+        return tiers[tier].count;
+    }
+
+    /**
+     * @brief Start time of the n-th oldest sample of a tier
+     */
+    uint64_t timestamp(size_t tier, size_t n) const
+    {
+        return tiers[tier].timestamps[tiers[tier].slotOf(n)];
+    }
+
+    /**
+     * @brief The n-th oldest sample of a metric in a tier
+     */
+    MetricSample get(size_t metric, size_t tier, size_t n) const
+    {
+        const Tier& t = tiers[tier];
+        size_t index = metric * t.capacity + t.slotOf(n);
+        if (t.interval == 1)
+        {
+            return {t.avg[index], t.avg[index], t.avg[index]};
+        }
+        return {t.min[index], t.max[index], t.avg[index]};
+    }
+
+  private:
+    static constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+    struct Tier
+    {
+        // Next slot to write
+        size_t beginSlot() const
+        {
+            return head;
+        }
+
+        void advance()
+        {
+            head = (head + 1) % capacity;
+            count = std::min(count + 1, capacity);
+        }
+
+        size_t slotOf(size_t n) const
+        {
+            return (head + capacity - count + n) % capacity;
+        }
+
+        uint32_t interval = 1;
+        size_t capacity = 1;
+        size_t head = 0;
+        size_t count = 0;
+        std::vector<uint64_t> timestamps;
+        std::vector<float> avg;
+        std::vector<float> min;
+        std::vector<float> max;
+
+        // The interval being collected
+        uint64_t bucket = 0;
+        bool bucketOpen = false;
+        std::vector<float> accMin;
+        std::vector<float> accMax;
+        std::vector<double> accSum;
+        std::vector<uint32_t> accCount;
+    };
+
+    static float valueOf(const std::vector<float>& values, size_t metric)
+    {
+        return metric < values.size() ? values[metric] : nan;
+    }
+
+    void closeBucket(Tier& tier)
+    {
+        size_t slot = tier.beginSlot();
+        tier.timestamps[slot] = tier.bucket * tier.interval;
+        for (size_t metric = 0; metric < metricCount; metric++)
+        {
+            size_t index = metric * tier.capacity + slot;
+            uint32_t count = tier.accCount[metric];
+            if (count == 0)
+            {
+                tier.min[index] = nan;
+                tier.max[index] = nan;
+                tier.avg[index] = nan;
+            }
+            else
+            {
+                tier.min[index] = tier.accMin[metric];
+                tier.max[index] = tier.accMax[metric];
+                tier.avg[index] =
+                    static_cast<float>(tier.accSum[metric] / count);
+            }
+            tier.accSum[metric] = 0.0;
+            tier.accCount[metric] = 0;
+        }
+        tier.advance();
+    }
+
+    size_t memoryBudget;
+    size_t metricCount = 0;
+    std::array<Tier, tierCount> tiers;
+};
+
+/**
+ * @brief Latest reading of each sensor and when it last changed
+ *
+ * Every change is numbered from a single increasing sequence, so a client that
+ * remembers the sequence it last saw can ask for only what changed since.
+ * Changes are also indexed by sequence, so finding them doesn't scan sensors
+ * that stayed the same.
+ */
+class SensorTable
+{
+  public:
+    /**
+     * @param[i] lastSequence  Sequence to number changes after
+     */
+    explicit SensorTable(uint64_t lastSequence = 0) :
+        firstSequence(lastSequence), lastSequence(lastSequence)
+    {
+    }
+
+    /**
+     * @brief Sets the reading of a sensor, adding it if it's new
+     *
+     * @return Index of the sensor, which doesn't change once added
+     */
+    size_t set(const std::string& path, float value)
+    {
+        size_t index = 0;
+        auto it = indices.find(path);
+        if (it == indices.end())
+        {
+            index = paths.size();
+            indices.emplace(path, index);
+            paths.emplace_back(path);
+            values.emplace_back(std::numeric_limits<float>::quiet_NaN());
+            sequences.emplace_back(0);
+        }
+        else
+        {
+            index = it->second;
+        }
+
+        float& current = values[index];
+        if (current == value || (std::isnan(current) && std::isnan(value)))
+        {
+            return index;
+        }
+        current = value;
+        if (sequences[index] != 0)
+        {
+            changes.erase(sequences[index]);
+        }
+        sequences[index] = ++lastSequence;
+        changes.emplace(lastSequence, index);
+        return index;
+    }
+
+    std::optional<size_t> find(const std::string& path) const
+    {
+        auto it = indices.find(path);
+        if (it == indices.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Calls f(path, value) for every sensor that changed after the
+     * given sequence, oldest change first
+     */
+    template <typename Callback>
+    void forEachChangeSince(uint64_t since, Callback&& f) const
+    {
+        for (auto it = changes.upper_bound(since); it != changes.end(); it++)
+        {
+            f(paths[it->second], values[it->second]);
+        }
+    }
+
+    // Sequence of the last change
+    uint64_t sequence() const
+    {
+        return lastSequence;
+    }
+
+    /**
+     * @brief Checks whether a sequence was handed out by this table, so the
+     * changes since it are known
+     */
+    bool isKnownSequence(uint64_t since) const
+    {
+        return since >= firstSequence && since <= lastSequence;
+    }
+
+    size_t size() const
+    {
+        return paths.size();
+    }
+
+    const std::string& getPath(size_t index) const
+    {
+        return paths[index];
+    }
+
+    // Readings by sensor index
+    const std::vector<float>& getValues() const
+    {
+        return values;
+    }
+
+  private:
+    uint64_t firstSequence;
+    uint64_t lastSequence;
+    std::unordered_map<std::string, size_t> indices;
+    std::vector<std::string> paths;
+    std::vector<float> values;
+    // Sequence of the last change of each sensor, 0 if it has no reading yet
+    std::vector<uint64_t> sequences;
+    // Sensor index by sequence of its last change
+    std::map<uint64_t, size_t> changes;
+};
+
+} // namespace telemetry_util
+} // namespace redfish
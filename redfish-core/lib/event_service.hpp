@@ -0,0 +1,687 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include "log_services.hpp"
+#include "node.hpp"
+
+#include <algorithm>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <chrono>
+#include <crow/http_client.h>
+#include <crow/streaming.h>
+#include <memory>
+#include <sdbusplus/bus/match.hpp>
+#include <string>
+#include <utils/event_utils.hpp>
+#include <variant>
+#include <vector>
+
+namespace redfish
+{
+
+namespace event_service
+{
+constexpr size_t maxSubscriptions = 20;
+// Events held for a push subscriber that is slow or unreachable
+constexpr size_t maxQueuedEvents = 1024;
+constexpr size_t maxEventsPerMessage = 32;
+constexpr uint32_t deliveryRetryAttempts = 5;
+constexpr std::chrono::seconds maxRetryInterval{60};
+
+constexpr std::array<const char *, 3> supportedEventTypes = {
+    "Alert", "StatusChange", "ResourceUpdated"};
+
+constexpr const char *sensorsPath = "/xyz/openbmc_project/sensors";
+constexpr const char *propertyValueModified =
+    "Base.1.4.0.PropertyValueModified";
+
+/**
+ * @brief A destination that events are POSTed to
+ */
+struct Subscription
+{
+    explicit Subscription(boost::asio::io_context &ioc) :
+        queue(maxQueuedEvents), retryTimer(ioc)
+    {
+    }
+
+    bool wantsEventType(const std::string &eventType) const
+    {
+        return eventTypes.empty() ||
+               std::find(eventTypes.begin(), eventTypes.end(), eventType) !=
+                   eventTypes.end();
+    }
+
+    std::string id;
+    std::string destination;
+    std::string context;
+    // Empty means all event types
+    std::vector<std::string> eventTypes;
+
+    std::string host;
+    std::string port;
+    std::string target;
+
+    event_util::EventQueue queue;
+    // Records of the message being sent, kept until it is acknowledged
+    std::vector<nlohmann::json> inFlight;
+    uint32_t failedAttempts = 0;
+    bool sending = false;
+    boost::asio::steady_timer retryTimer;
+};
+
+/**
+ * @brief Turns log entries and sensor changes into Redfish events and
+ * delivers them to subscribers
+ *
+ * Event log entries are taken from the log tail and become Alert events.
+ * Sensor readings and threshold alarms come from a PropertiesChanged match,
+ * which is only installed while someone is listening.  Events are delivered
+ * to Server-Sent Event streams as they happen, and to push subscribers
+ * through a bounded queue per subscriber, so a slow or unreachable
+ * destination only delays its own events.
+ */
+class EventServiceManager
+{
+  public:
+    static EventServiceManager &getInstance(boost::asio::io_context &ioc)
+    {
+        static EventServiceManager manager(ioc);
+        return manager;
+    }
+
+    EventServiceManager(const EventServiceManager &) = delete;
+    EventServiceManager &operator=(const EventServiceManager &) = delete;
+
+    /**
+     * @brief Adds a push subscription
+     *
+     * @return The new subscription, or nullptr if the limit was reached
+     */
+    std::shared_ptr<Subscription>
+        addSubscription(std::string &&destination, std::string &&host,
+                        std::string &&port, std::string &&target,
+                        std::string &&context,
+                        std::vector<std::string> &&eventTypes)
+    {
+        if (subscriptions.size() >= maxSubscriptions)
+        {
+            return nullptr;
+        }
+        auto subscription = std::make_shared<Subscription>(ioc);
+        subscription->id = std::to_string(++lastSubscriptionId);
+        subscription->destination = std::move(destination);
+        subscription->host = std::move(host);
+        subscription->port = std::move(port);
+        subscription->target = std::move(target);
+        subscription->context = std::move(context);
+        subscription->eventTypes = std::move(eventTypes);
+        subscriptions.emplace(subscription->id, subscription);
+        updateSensorMatch();
+        return subscription;
+    }
+
+    bool removeSubscription(const std::string &id)
+    {
+        auto it = subscriptions.find(id);
+        if (it == subscriptions.end())
+        {
+            return false;
+        }
+        // A delivery in progress only holds a weak reference, so it ends
+        // once the subscription is gone
+        it->second->retryTimer.cancel();
+        subscriptions.erase(it);
+        updateSensorMatch();
+        return true;
+    }
+
+    const boost::container::flat_map<std::string,
+                                     std::shared_ptr<Subscription>> &
+        getSubscriptions() const
+    {
+        return subscriptions;
+    }
+
+    void addStream(crow::streaming::Connection &conn)
+    {
+        streams.insert(&conn);
+        updateSensorMatch();
+    }
+
+    void removeStream(crow::streaming::Connection &conn)
+    {
+        streams.erase(&conn);
+        updateSensorMatch();
+    }
+
+  private:
+    EventServiceManager(boost::asio::io_context &ioc) : ioc(ioc)
+    {
+        getEventLogTail(ioc).addListener(
+            [this](const nlohmann::json &entry) { onLogEntry(entry); });
+    }
+
+    bool hasListeners() const
+    {
+        return !subscriptions.empty() || !streams.empty();
+    }
+
+    /**
+     * @brief Queues an event record for everyone who wants its type
+     *
+     * @param[i] eventType    Redfish EventType of the record
+     * @param[i] coalesceKey  Key of the state the record describes, so a newer
+     * record can replace one that hasn't been delivered yet.  Empty if every
+     * record must be delivered
+     * @param[i] record       Redfish EventRecord
+     */
+    void publish(const std::string &eventType, const std::string &coalesceKey,
+                 nlohmann::json &&record)
+    {
+        record["EventType"] = eventType;
+        if (!streams.empty())
+        {
+            nlohmann::json event = makeEvent("", {record});
+            std::string id = event["Id"];
+            std::string data = event.dump();
+            // A stream that can't keep up may close, and remove itself, while
+            // sending
+            std::vector<crow::streaming::Connection *> receivers(
+                streams.begin(), streams.end());
+            for (crow::streaming::Connection *conn : receivers)
+            {
+                if (streams.find(conn) != streams.end())
+                {
+                    conn->sendEvent(id, data);
+                }
+            }
+        }
+
+        for (auto &subscription : subscriptions)
+        {
+            if (!subscription.second->wantsEventType(eventType))
+            {
+                continue;
+            }
+            if (!subscription.second->queue.push(coalesceKey,
+                                                 nlohmann::json(record)))
+            {
+                BMCWEB_LOG_ERROR << "Event queue of subscription "
+                                 << subscription.first
+                                 << " is full, dropped the oldest event";
+            }
+            flush(subscription.second);
+        }
+    }
+
+    nlohmann::json makeEvent(const std::string &context,
+                             std::vector<nlohmann::json> records)
+    {
+        int memberId = 0;
+        for (nlohmann::json &record : records)
+        {
+            record["MemberId"] = std::to_string(memberId++);
+        }
+        return {{"@odata.type", "#Event.v1_4_0.Event"},
+                {"Id", std::to_string(++lastEventId)},
+                {"Name", "Event Log"},
+                {"Context", context},
+                {"Events", std::move(records)}};
+    }
+
+    // Sends the next batch of queued events, unless one is still on its way
+    void flush(const std::shared_ptr<Subscription> &subscription)
+    {
+        if (subscription->sending || subscription->queue.empty())
+        {
+            return;
+        }
+        subscription->inFlight =
+            subscription->queue.take(maxEventsPerMessage);
+        subscription->sending = true;
+        send(subscription);
+    }
+
+    void send(const std::shared_ptr<Subscription> &subscription)
+    {
+        nlohmann::json event =
+            makeEvent(subscription->context, subscription->inFlight);
+        auto client = std::make_shared<crow::HttpClient>(
+            ioc, subscription->host, subscription->port);
+        client->post(
+            subscription->target, event.dump(),
+            [this, weak{std::weak_ptr<Subscription>(subscription)}](
+                bool success, unsigned status) {
+                std::shared_ptr<Subscription> subscription = weak.lock();
+                if (subscription == nullptr)
+                {
+                    return;
+                }
+                if (success)
+                {
+                    subscription->failedAttempts = 0;
+                    subscription->inFlight.clear();
+                    subscription->sending = false;
+                    flush(subscription);
+                    return;
+                }
+
+                subscription->failedAttempts++;
+                BMCWEB_LOG_ERROR << "Failed to deliver events to "
+                                 << subscription->destination << ", status "
+                                 << status << ", attempt "
+                                 << subscription->failedAttempts;
+                if (subscription->failedAttempts >= deliveryRetryAttempts)
+                {
+                    BMCWEB_LOG_ERROR << "Dropping "
+                                     << subscription->inFlight.size()
+                                     << " events for "
+                                     << subscription->destination;
+                    subscription->failedAttempts = 0;
+                    subscription->inFlight.clear();
+                    subscription->sending = false;
+                    flush(subscription);
+                    return;
+                }
+
+                // Back off exponentially, so an unreachable destination
+                // doesn't keep the BMC busy
+                std::chrono::seconds delay = std::min(
+                    std::chrono::seconds(1 << (subscription->failedAttempts -
+                                               1)),
+                    maxRetryInterval);
+                subscription->retryTimer.expires_after(delay);
+                subscription->retryTimer.async_wait(
+                    [this, weak](const boost::system::error_code &ec) {
+                        std::shared_ptr<Subscription> subscription =
+                            weak.lock();
+                        if (ec || subscription == nullptr)
+                        {
+                            return;
+                        }
+                        send(subscription);
+                    });
+            });
+    }
+
+    void onLogEntry(const nlohmann::json &entry)
+    {
+        if (!hasListeners())
+        {
+            return;
+        }
+        nlohmann::json record = {
+            {"EventId", entry["Id"]},
+            {"EventTimestamp", entry["Created"]},
+            {"Severity", entry["Severity"]},
+            {"Message", entry["Message"]},
+            {"MessageId", entry["MessageId"]},
+            {"MessageArgs", entry["MessageArgs"]},
+            {"OriginOfCondition", {{"@odata.id", entry["@odata.id"]}}}};
+        publish("Alert", "", std::move(record));
+    }
+
+    // The match is only needed while someone is listening
+    void updateSensorMatch()
+    {
+        if (!hasListeners())
+        {
+            sensorMatch.reset();
+            return;
+        }
+        if (sensorMatch != nullptr)
+        {
+            return;
+        }
+        sensorMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::type::signal() +
+                sdbusplus::bus::match::rules::member("PropertiesChanged") +
+                sdbusplus::bus::match::rules::interface(
+                    "org.freedesktop.DBus.Properties") +
+                sdbusplus::bus::match::rules::path_namespace(sensorsPath),
+            [this](sdbusplus::message::message &m) {
+                onSensorPropertiesChanged(m);
+            });
+    }
+
+    void onSensorPropertiesChanged(sdbusplus::message::message &m)
+    {
+        std::string interface;
+        boost::container::flat_map<
+            std::string,
+            std::variant<int64_t, double, uint32_t, bool, std::string>>
+            values;
+        m.read(interface, values);
+
+        // Sensor paths are /xyz/openbmc_project/sensors/<type>/<name>
+        std::string path = m.get_path();
+        std::string sensor = path.substr(std::min(
+            path.size(), std::char_traits<char>::length(sensorsPath) + 1));
+
+        for (const auto &value : values)
+        {
+            std::string eventType;
+            std::string severity = "OK";
+            std::string valueStr;
+            if (value.first == "Value")
+            {
+                eventType = "ResourceUpdated";
+                std::visit(
+                    [&valueStr](const auto &v) {
+                        valueStr = nlohmann::json(v).dump();
+                    },
+                    value.second);
+            }
+            else if (value.first.find("Alarm") != std::string::npos)
+            {
+                const bool *alarm = std::get_if<bool>(&value.second);
+                if (alarm == nullptr)
+                {
+                    continue;
+                }
+                eventType = "StatusChange";
+                valueStr = *alarm ? "true" : "false";
+                if (*alarm)
+                {
+                    severity = boost::ends_with(interface, ".Critical")
+                                   ? "Critical"
+                                   : "Warning";
+                }
+            }
+            else
+            {
+                continue;
+            }
+
+            std::string property = sensor + "/" + value.first;
+            std::array<std::string, 2> args = {property, valueStr};
+            std::string msg;
+            const message_registries::MessageTemplate *messageTemplate =
+                message_registries::getMessage(propertyValueModified);
+            if (messageTemplate != nullptr)
+            {
+                message_registries::appendMessage(msg, *messageTemplate,
+                                                  args);
+            }
+            nlohmann::json record = {
+                {"EventTimestamp", crow::utility::dateTimeNow()},
+                {"Severity", severity},
+                {"Message", std::move(msg)},
+                {"MessageId", propertyValueModified},
+                {"MessageArgs", args}};
+            publish(eventType, path + "/" + value.first, std::move(record));
+        }
+    }
+
+    boost::asio::io_context &ioc;
+    boost::container::flat_map<std::string, std::shared_ptr<Subscription>>
+        subscriptions;
+    boost::container::flat_set<crow::streaming::Connection *> streams;
+    std::unique_ptr<sdbusplus::bus::match::match> sensorMatch;
+    uint64_t lastSubscriptionId = 0;
+    uint64_t lastEventId = 0;
+};
+} // namespace event_service
+
+class EventService : public Node
+{
+  public:
+    EventService(CrowApp &app) : Node(app, "/redfish/v1/EventService/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+
+        BMCWEB_ROUTE(app, "/redfish/v1/EventService/SSE")
+            .requires({"Login"})
+            .streaming()
+            .onopen([](crow::streaming::Connection &conn) {
+                BMCWEB_LOG_DEBUG << "Event stream " << &conn << " opened";
+                event_service::EventServiceManager::getInstance(
+                    conn.get_io_context())
+                    .addStream(conn);
+            })
+            .onclose([](crow::streaming::Connection &conn) {
+                BMCWEB_LOG_DEBUG << "Event stream " << &conn << " closed";
+                event_service::EventServiceManager::getInstance(
+                    conn.get_io_context())
+                    .removeStream(conn);
+            });
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        res.jsonValue = {
+            {"@odata.type", "#EventService.v1_3_0.EventService"},
+            {"@odata.context",
+             "/redfish/v1/$metadata#EventService.EventService"},
+            {"@odata.id", "/redfish/v1/EventService"},
+            {"Id", "EventService"},
+            {"Name", "Event Service"},
+            {"ServiceEnabled", true},
+            {"Status", {{"State", "Enabled"}, {"Health", "OK"}}},
+            {"DeliveryRetryAttempts", event_service::deliveryRetryAttempts},
+            {"EventTypesForSubscription",
+             event_service::supportedEventTypes},
+            {"ServerSentEventUri", "/redfish/v1/EventService/SSE"},
+            {"Subscriptions",
+             {{"@odata.id", "/redfish/v1/EventService/Subscriptions"}}}};
+        res.end();
+    }
+};
+
+class EventDestinationCollection : public Node
+{
+  public:
+    EventDestinationCollection(CrowApp &app) :
+        Node(app, "/redfish/v1/EventService/Subscriptions/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        const auto &subscriptions =
+            event_service::EventServiceManager::getInstance(*req.ioService)
+                .getSubscriptions();
+        nlohmann::json members = nlohmann::json::array();
+        for (const auto &subscription : subscriptions)
+        {
+            members.push_back(
+                {{"@odata.id", "/redfish/v1/EventService/Subscriptions/" +
+                                   subscription.first}});
+        }
+        res.jsonValue = {
+            {"@odata.type",
+             "#EventDestinationCollection.EventDestinationCollection"},
+            {"@odata.context", "/redfish/v1/"
+                               "$metadata#EventDestinationCollection."
+                               "EventDestinationCollection"},
+            {"@odata.id", "/redfish/v1/EventService/Subscriptions"},
+            {"Name", "Event Destination Collection"},
+            {"Members@odata.count", members.size()},
+            {"Members", std::move(members)}};
+        res.end();
+    }
+
+    void doPost(crow::Response &res, const crow::Request &req,
+                const std::vector<std::string> &params) override
+    {
+        auto asyncResp = std::make_shared<AsyncResp>(res);
+
+        std::string destination;
+        std::string protocol;
+        std::optional<std::string> context;
+        std::optional<std::vector<std::string>> eventTypes;
+        if (!json_util::readJson(req, res, "Destination", destination,
+                                 "Protocol", protocol, "Context", context,
+                                 "EventTypes", eventTypes))
+        {
+            return;
+        }
+
+        if (protocol != "Redfish")
+        {
+            messages::propertyValueNotInList(asyncResp->res, protocol,
+                                             "Protocol");
+            return;
+        }
+
+        std::string host;
+        std::string port;
+        std::string target;
+        if (!event_util::parseDestination(destination, host, port, target))
+        {
+            messages::propertyValueFormatError(asyncResp->res, destination,
+                                               "Destination");
+            return;
+        }
+
+        if (eventTypes)
+        {
+            for (const std::string &eventType : *eventTypes)
+            {
+                if (std::find(event_service::supportedEventTypes.begin(),
+                              event_service::supportedEventTypes.end(),
+                              eventType) ==
+                    event_service::supportedEventTypes.end())
+                {
+                    messages::propertyValueNotInList(asyncResp->res,
+                                                     eventType, "EventTypes");
+                    return;
+                }
+            }
+        }
+
+        std::shared_ptr<event_service::Subscription> subscription =
+            event_service::EventServiceManager::getInstance(*req.ioService)
+                .addSubscription(std::move(destination), std::move(host),
+                                 std::move(port), std::move(target),
+                                 context ? std::move(*context) : "",
+                                 eventTypes ? std::move(*eventTypes)
+                                            : std::vector<std::string>());
+        if (subscription == nullptr)
+        {
+            messages::eventSubscriptionLimitExceeded(asyncResp->res);
+            return;
+        }
+
+        messages::created(asyncResp->res);
+        asyncResp->res.addHeader("Location",
+                                 "/redfish/v1/EventService/Subscriptions/" +
+                                     subscription->id);
+    }
+};
+
+class EventDestination : public Node
+{
+  public:
+    EventDestination(CrowApp &app) :
+        Node(app, "/redfish/v1/EventService/Subscriptions/<str>/",
+             std::string())
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        if (params.size() != 1)
+        {
+            messages::internalError(res);
+            res.end();
+            return;
+        }
+        const auto &subscriptions =
+            event_service::EventServiceManager::getInstance(*req.ioService)
+                .getSubscriptions();
+        auto it = subscriptions.find(params[0]);
+        if (it == subscriptions.end())
+        {
+            messages::resourceNotFound(res, "EventDestination", params[0]);
+            res.end();
+            return;
+        }
+        const event_service::Subscription &subscription = *it->second;
+
+        nlohmann::json eventTypes = subscription.eventTypes;
+        if (subscription.eventTypes.empty())
+        {
+            eventTypes = event_service::supportedEventTypes;
+        }
+        res.jsonValue = {
+            {"@odata.type", "#EventDestination.v1_4_0.EventDestination"},
+            {"@odata.context",
+             "/redfish/v1/$metadata#EventDestination.EventDestination"},
+            {"@odata.id",
+             "/redfish/v1/EventService/Subscriptions/" + subscription.id},
+            {"Id", subscription.id},
+            {"Name", "Event Destination " + subscription.id},
+            {"Destination", subscription.destination},
+            {"Context", subscription.context},
+            {"Protocol", "Redfish"},
+            {"EventTypes", std::move(eventTypes)}};
+        res.end();
+    }
+
+    void doDelete(crow::Response &res, const crow::Request &req,
+                  const std::vector<std::string> &params) override
+    {
+        if (params.size() != 1)
+        {
+            messages::internalError(res);
+            res.end();
+            return;
+        }
+        if (!event_service::EventServiceManager::getInstance(*req.ioService)
+                 .removeSubscription(params[0]))
+        {
+            messages::resourceNotFound(res, "EventDestination", params[0]);
+            res.end();
+            return;
+        }
+        messages::success(res);
+        res.end();
+    }
+};
+
+} // namespace redfish
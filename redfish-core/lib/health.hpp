@@ -17,123 +17,259 @@
 
 #include "async_resp.hpp"
 
+#include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <utils/health_utils.hpp>
 #include <variant>
 
 namespace redfish
 {
 
-struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
+constexpr const char *associationInterface = "xyz.openbmc_project.Association";
+
+/**
+ * @brief Returns the endpoints of an association object, or nothing if it
+ * has none
+ */
+inline std::vector<std::string> getAssociationEndpoints(
+    const boost::container::flat_map<
+        std::string,
+        boost::container::flat_map<std::string,
+                                   dbus::utility::DbusVariantType>>
+        &interfaces)
 {
-    HealthPopulate(const std::shared_ptr<AsyncResp> &asyncResp) :
-        asyncResp(asyncResp)
+    auto assocIt = interfaces.find(associationInterface);
+    if (assocIt == interfaces.end())
+    {
+        return {};
+    }
+    auto endpointsIt = assocIt->second.find("endpoints");
+    if (endpointsIt == assocIt->second.end())
+    {
+        return {};
+    }
+    const std::vector<std::string> *endpoints =
+        std::get_if<std::vector<std::string>>(&endpointsIt->second);
+    if (endpoints == nullptr)
     {
+        return {};
     }
+    return *endpoints;
+}
 
-    ~HealthPopulate()
+/**
+ * @brief Status associations of the whole system, kept current from mapper
+ * signals
+ *
+ * The index is loaded once and then follows the InterfacesAdded,
+ * InterfacesRemoved and PropertiesChanged signals the mapper sends for
+ * associations, so a health rollup doesn't need any D-Bus calls.  It is
+ * reloaded if the mapper restarts.  Until it has loaded, isReady() is false
+ * and rollups query the mapper themselves.
+ */
+class HealthStateIndex
+{
+  public:
+    static HealthStateIndex &getInstance()
     {
-        nlohmann::json &health = asyncResp->res.jsonValue["Status"]["Health"];
-        nlohmann::json &rollup =
-            asyncResp->res.jsonValue["Status"]["HealthRollup"];
+        static HealthStateIndex index;
+        return index;
+    }
 
-        health = "OK";
-        rollup = "OK";
+    HealthStateIndex(const HealthStateIndex &) = delete;
+    HealthStateIndex &operator=(const HealthStateIndex &) = delete;
 
-        for (const auto &[path, interfaces] : statuses)
-        {
-            bool isChild = false;
+    bool isReady() const
+    {
+        return ready;
+    }
 
-            // managers inventory is all the inventory, don't skip any
-            if (!isManagersHealth)
-            {
+    void getHealth(const std::vector<std::string> &inventory,
+                   bool allInventory, health_util::Health &health,
+                   health_util::Health &rollup) const
+    {
+        index.getHealth(inventory, allInventory, health, rollup);
+    }
 
-                // We only want to look at this association if either the path
-                // of this association is an inventory item, or one of the
-                // endpoints in this association is a child
+  private:
+    HealthStateIndex() :
+        addedMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::interfacesAdded() +
+                sdbusplus::bus::match::rules::sender(mapperService),
+            [this](sdbusplus::message::message &m) {
+                sdbusplus::message::object_path path;
+                boost::container::flat_map<
+                    std::string,
+                    boost::container::flat_map<std::string,
+                                               dbus::utility::DbusVariantType>>
+                    interfaces;
+                m.read(path, interfaces);
+                if (interfaces.find(associationInterface) != interfaces.end())
+                {
+                    index.set(path.str, getAssociationEndpoints(interfaces));
+                }
+            }),
+        removedMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::interfacesRemoved() +
+                sdbusplus::bus::match::rules::sender(mapperService),
+            [this](sdbusplus::message::message &m) {
+                sdbusplus::message::object_path path;
+                std::vector<std::string> interfaces;
+                m.read(path, interfaces);
+                if (std::find(interfaces.begin(), interfaces.end(),
+                              associationInterface) != interfaces.end())
+                {
+                    index.remove(path.str);
+                }
+            }),
+        changedMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::type::signal() +
+                sdbusplus::bus::match::rules::sender(mapperService) +
+                sdbusplus::bus::match::rules::member("PropertiesChanged") +
+                sdbusplus::bus::match::rules::interface(
+                    "org.freedesktop.DBus.Properties") +
+                sdbusplus::bus::match::rules::argN(0, associationInterface),
+            [this](sdbusplus::message::message &m) {
+                std::string interface;
+                boost::container::flat_map<std::string,
+                                           dbus::utility::DbusVariantType>
+                    properties;
+                m.read(interface, properties);
+                auto endpointsIt = properties.find("endpoints");
+                if (endpointsIt == properties.end())
+                {
+                    return;
+                }
+                const std::vector<std::string> *endpoints =
+                    std::get_if<std::vector<std::string>>(
+                        &endpointsIt->second);
+                if (endpoints != nullptr)
+                {
+                    index.set(m.get_path(),
+                              std::vector<std::string>(*endpoints));
+                }
+            }),
+        mapperMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::nameOwnerChanged(mapperService),
+            [this](sdbusplus::message::message &) {
+                BMCWEB_LOG_DEBUG << "Mapper restarted, reloading health";
+                ready = false;
+                load();
+            })
+    {
+        load();
+    }
 
-                for (const std::string &child : inventory)
+    // Loads the associations after the matches are in place, so nothing
+    // that changes in between is missed
+    void load()
+    {
+        uint64_t thisLoad = ++loadCount;
+        crow::connections::systemBus->async_method_call(
+            [this, thisLoad](const boost::system::error_code ec,
+                             const std::vector<std::string> &resp) {
+                if (thisLoad != loadCount)
                 {
-                    if (boost::starts_with(path.str, child))
-                    {
-                        isChild = true;
-                        break;
-                    }
+                    return;
                 }
-                if (!isChild)
+                // No global item, or too many
+                index.setGlobalInventoryPath(
+                    !ec && resp.size() == 1 ? std::string(resp[0]) : "-");
+                loadAssociations(thisLoad);
+            },
+            mapperService, "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", "/",
+            int32_t(0),
+            std::array<const char *, 1>{
+                "xyz.openbmc_project.Inventory.Item.Global"});
+    }
+
+    void loadAssociations(uint64_t thisLoad)
+    {
+        crow::connections::systemBus->async_method_call(
+            [this, thisLoad](const boost::system::error_code ec,
+                             const dbus::utility::ManagedObjectType &resp) {
+                if (thisLoad != loadCount)
                 {
-                    auto assocIt =
-                        interfaces.find("xyz.openbmc_project.Association");
-                    if (assocIt == interfaces.end())
-                    {
-                        continue;
-                    }
-                    auto endpointsIt = assocIt->second.find("endpoints");
-                    if (endpointsIt == assocIt->second.end())
-                    {
-                        BMCWEB_LOG_ERROR << "Illegal association at "
-                                         << path.str;
-                        continue;
-                    }
-                    const std::vector<std::string> *endpoints =
-                        std::get_if<std::vector<std::string>>(
-                            &endpointsIt->second);
-                    if (endpoints == nullptr)
-                    {
-                        BMCWEB_LOG_ERROR << "Illegal association at "
-                                         << path.str;
-                        continue;
-                    }
-                    bool containsChild = false;
-                    for (const std::string &endpoint : *endpoints)
-                    {
-                        if (std::find(inventory.begin(), inventory.end(),
-                                      endpoint) != inventory.end())
-                        {
-                            containsChild = true;
-                            break;
-                        }
-                    }
-                    if (!containsChild)
-                    {
-                        continue;
-                    }
+                    return;
                 }
-            }
-
-            if (boost::starts_with(path.str, globalInventoryPath) &&
-                boost::ends_with(path.str, "critical"))
-            {
-                health = "Critical";
-                rollup = "Critical";
-                return;
-            }
-            else if (boost::starts_with(path.str, globalInventoryPath) &&
-                     boost::ends_with(path.str, "warning"))
-            {
-                health = "Warning";
-                if (rollup != "Critical")
+                if (ec)
                 {
-                    rollup = "Warning";
+                    BMCWEB_LOG_ERROR << "Failed to load health associations: "
+                                     << ec;
+                    return;
                 }
-            }
-            else if (boost::ends_with(path.str, "critical"))
-            {
-                rollup = "Critical";
-            }
-            else if (boost::ends_with(path.str, "warning"))
-            {
-                if (rollup != "Critical")
+                index.clear();
+                for (const auto &[path, interfaces] : resp)
                 {
-                    rollup = "Warning";
+                    index.set(path.str, getAssociationEndpoints(interfaces));
                 }
-            }
+                ready = true;
+                BMCWEB_LOG_DEBUG << "Loaded " << index.size()
+                                 << " health associations";
+            },
+            mapperService, "/", "org.freedesktop.DBus.ObjectManager",
+            "GetManagedObjects");
+    }
+
+    static constexpr const char *mapperService =
+        "xyz.openbmc_project.ObjectMapper";
+
+    health_util::HealthIndex index;
+    bool ready = false;
+    // Identifies the newest load, so an older reply can't overwrite it
+    uint64_t loadCount = 0;
+    sdbusplus::bus::match::match addedMatch;
+    sdbusplus::bus::match::match removedMatch;
+    sdbusplus::bus::match::match changedMatch;
+    sdbusplus::bus::match::match mapperMatch;
+};
+
+struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
+{
+    HealthPopulate(const std::shared_ptr<AsyncResp> &asyncResp) :
+        asyncResp(asyncResp)
+    {
+    }
+
+    ~HealthPopulate()
+    {
+        health_util::Health health = health_util::Health::ok;
+        health_util::Health rollup = health_util::Health::ok;
+        if (useIndex)
+        {
+            HealthStateIndex::getInstance().getHealth(
+                inventory, isManagersHealth, health, rollup);
         }
+        else
+        {
+            health_util::getHealthByScan(statuses, inventory,
+                                         isManagersHealth, globalInventoryPath,
+                                         health, rollup);
+        }
+        asyncResp->res.jsonValue["Status"]["Health"] =
+            health_util::toString(health);
+        asyncResp->res.jsonValue["Status"]["HealthRollup"] =
+            health_util::toString(rollup);
     }
 
     void populate()
     {
+        // Also starts loading the index on first use
+        if (HealthStateIndex::getInstance().isReady())
+        {
+            useIndex = true;
+            return;
+        }
         getAllStatusAssociations();
         getGlobalPath();
     }
@@ -164,22 +300,19 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
         std::shared_ptr<HealthPopulate> self = shared_from_this();
         crow::connections::systemBus->async_method_call(
             [self](const boost::system::error_code ec,
-                   dbus::utility::ManagedObjectType &resp) {
+                   const dbus::utility::ManagedObjectType &resp) {
                 if (ec)
                 {
                     return;
                 }
-                for (auto it = resp.begin(); it != resp.end();)
+                for (const auto &[path, interfaces] : resp)
                 {
-                    if (boost::ends_with(it->first.str, "critical") ||
-                        boost::ends_with(it->first.str, "warning"))
+                    if (health_util::isStatusAssociation(path.str))
                     {
-                        it++;
-                        continue;
+                        self->statuses.emplace_back(
+                            path.str, getAssociationEndpoints(interfaces));
                     }
-                    it = resp.erase(it);
                 }
-                self->statuses = std::move(resp);
             },
             "xyz.openbmc_project.ObjectMapper", "/",
             "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
@@ -188,7 +321,9 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
     std::shared_ptr<AsyncResp> asyncResp;
     std::vector<std::string> inventory;
     bool isManagersHealth = false;
-    dbus::utility::ManagedObjectType statuses;
+    // Set when the rollup comes from HealthStateIndex
+    bool useIndex = false;
+    health_util::StatusAssociations statuses;
     std::string globalInventoryPath = "-"; // default to illegal dbus path
 };
-} // namespace redfish
\ No newline at end of file
+} // namespace redfish
@@ -19,6 +19,8 @@
 #include "registries.hpp"
 #include "registries/base_message_registry.hpp"
 #include "registries/openbmc_message_registry.hpp"
+#include "utils/event_log_tail.hpp"
+#include "utils/event_log_utils.hpp"
 
 #include <systemd/sd-journal.h>
 
@@ -44,46 +46,30 @@ constexpr char const *CrashdumpRawPECIInterface =
 
 namespace message_registries
 {
-static const Message *getMessageFromRegistry(
-    const std::string &messageKey,
-    const boost::beast::span<const MessageEntry> registry)
-{
-    boost::beast::span<const MessageEntry>::const_iterator messageIt =
-        std::find_if(registry.cbegin(), registry.cend(),
-                     [&messageKey](const MessageEntry &messageEntry) {
-                         return !std::strcmp(messageEntry.first,
-                                             messageKey.c_str());
-                     });
-    if (messageIt != registry.cend())
-    {
-        return &messageIt->second;
-    }
-
-    return nullptr;
-}
-
-static const Message *getMessage(const std::string_view &messageID)
+static const MessageTemplate *getMessage(const std::string_view &messageID)
 {
     // Redfish MessageIds are in the form
     // RegistryName.MajorVersion.MinorVersion.MessageKey, so parse it to find
     // the right Message
-    std::vector<std::string> fields;
-    fields.reserve(4);
-    boost::split(fields, messageID, boost::is_any_of("."));
-    std::string &registryName = fields[0];
-    std::string &messageKey = fields[3];
+    size_t registryEnd = messageID.find('.');
+    size_t keyStart = messageID.rfind('.');
+    if (registryEnd == std::string_view::npos)
+    {
+        return nullptr;
+    }
+    std::string_view registryName = messageID.substr(0, registryEnd);
+    std::string_view messageKey = messageID.substr(keyStart + 1);
 
     // Find the right registry and check it for the MessageKey
-    if (std::string(base::header.registryPrefix) == registryName)
+    if (registryName == base::header.registryPrefix)
     {
-        return getMessageFromRegistry(
-            messageKey, boost::beast::span<const MessageEntry>(base::registry));
+        return getMessageTemplateFromRegistry(messageKey, base::registry,
+                                              base::registryIndex);
     }
-    if (std::string(openbmc::header.registryPrefix) == registryName)
+    if (registryName == openbmc::header.registryPrefix)
     {
-        return getMessageFromRegistry(
-            messageKey,
-            boost::beast::span<const MessageEntry>(openbmc::registry));
+        return getMessageTemplateFromRegistry(messageKey, openbmc::registry,
+                                              openbmc::registryIndex);
     }
     return nullptr;
 }
@@ -298,45 +284,162 @@ static bool getUniqueEntryID(sd_journal *journal, std::string &entryID,
     return true;
 }
 
-static bool getUniqueEntryID(const std::string &logEntry, std::string &entryID,
-                             const bool firstEntry = true)
+static bool getUniqueEntryIDInContext(sd_journal *journal,
+                                      std::string &entryID)
 {
-    static uint64_t prevTs = 0;
-    static int index = 0;
-    if (firstEntry)
+    // Entries that share a timestamp are numbered in order, so step back to
+    // the first entry with this timestamp and count forward from there
+    uint64_t curTs = 0;
+    int ret = sd_journal_get_realtime_usec(journal, &curTs);
+    if (ret < 0)
     {
-        prevTs = 0;
+        BMCWEB_LOG_ERROR << "Failed to read entry timestamp: "
+                         << strerror(-ret);
+        return false;
+    }
+    int stepsBack = 0;
+    while (sd_journal_previous(journal) > 0)
+    {
+        uint64_t prevTs = 0;
+        if (sd_journal_get_realtime_usec(journal, &prevTs) < 0 ||
+            prevTs != curTs)
+        {
+            sd_journal_next(journal);
+            break;
+        }
+        stepsBack++;
     }
 
-    // Get the entry timestamp
-    uint64_t curTs = 0;
-    std::tm timeStruct = {};
-    std::istringstream entryStream(logEntry);
-    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+    if (!getUniqueEntryID(journal, entryID, true))
     {
-        curTs = std::mktime(&timeStruct);
+        return false;
     }
-    // If the timestamp isn't unique, increment the index
-    if (curTs == prevTs)
+    for (; stepsBack > 0; stepsBack--)
     {
-        index++;
+        if (sd_journal_next(journal) <= 0 ||
+            !getUniqueEntryID(journal, entryID, false))
+        {
+            return false;
+        }
     }
-    else
+    return true;
+}
+
+static std::string getJournalSkipToken(sd_journal *journal)
+{
+    char *cursor = nullptr;
+    int ret = sd_journal_get_cursor(journal, &cursor);
+    if (ret < 0)
     {
-        // Otherwise, reset it
-        index = 0;
+        BMCWEB_LOG_ERROR << "Failed to read journal cursor: " << strerror(-ret);
+        return "";
     }
-    // Save the timestamp
-    prevTs = curTs;
+    std::string token =
+        crow::utility::base64encodeUrlsafe(cursor, std::strlen(cursor));
+    free(cursor);
+    // Padding isn't needed to decode, and '=' doesn't belong in a query value
+    token.erase(token.find_last_not_of('=') + 1);
+    return token;
+}
 
-    entryID = std::to_string(curTs);
-    if (index > 0)
+static bool getJournalCursorFromSkipToken(std::string token,
+                                          std::string &cursor)
+{
+    for (char &c : token)
     {
-        entryID += "_" + std::to_string(index);
+        if (c == '-')
+        {
+            c = '+';
+        }
+        else if (c == '_')
+        {
+            c = '/';
+        }
     }
-    return true;
+    return !token.empty() && crow::utility::base64Decode(token, cursor);
 }
 
+/**
+ * @brief Keeps a running count of the entries in the BMC journal
+ *
+ * Counting requires walking every entry, so the journal is walked once and
+ * the count is then advanced past entries as they are appended.  If journal
+ * files are added or removed (rotation, vacuuming), the count is rebuilt.
+ */
+class JournalEntryCounter
+{
+  public:
+    static JournalEntryCounter &getInstance()
+    {
+        static JournalEntryCounter counter;
+        return counter;
+    }
+
+    bool getCount(uint64_t &count)
+    {
+        if (journal == nullptr)
+        {
+            sd_journal *journalTmp = nullptr;
+            int ret = sd_journal_open(&journalTmp, SD_JOURNAL_LOCAL_ONLY);
+            if (ret < 0)
+            {
+                BMCWEB_LOG_ERROR << "failed to open journal: "
+                                 << strerror(-ret);
+                return false;
+            }
+            journal.reset(journalTmp);
+            recount();
+        }
+        else
+        {
+            // Doesn't block with a zero timeout; only picks up what changed
+            int ret = sd_journal_wait(journal.get(), 0);
+            if (ret < 0)
+            {
+                BMCWEB_LOG_ERROR << "failed to process journal changes: "
+                                 << strerror(-ret);
+                journal.reset();
+                return false;
+            }
+            if (ret == SD_JOURNAL_INVALIDATE)
+            {
+                recount();
+            }
+            else
+            {
+                countNewEntries();
+            }
+        }
+        count = entryCount;
+        return true;
+    }
+
+    JournalEntryCounter(const JournalEntryCounter &) = delete;
+    JournalEntryCounter &operator=(const JournalEntryCounter &) = delete;
+
+  private:
+    JournalEntryCounter() = default;
+
+    void recount()
+    {
+        entryCount = 0;
+        sd_journal_seek_head(journal.get());
+        countNewEntries();
+    }
+
+    void countNewEntries()
+    {
+        while (sd_journal_next(journal.get()) > 0)
+        {
+            entryCount++;
+        }
+    }
+
+    std::unique_ptr<sd_journal, decltype(&sd_journal_close)> journal{
+        nullptr, sd_journal_close};
+    uint64_t entryCount = 0;
+};
+
 static bool getTimestampFromID(crow::Response &res, const std::string &entryID,
                                uint64_t &timestamp, uint16_t &index)
 {
@@ -399,11 +502,12 @@ static bool getTimestampFromID(crow::Response &res, const std::string &entryID,
     return true;
 }
 
+constexpr char const *redfishLogDir = "/var/log";
+constexpr char const *redfishLogFilename = "redfish";
+
 static bool
     getRedfishLogFiles(std::vector<std::filesystem::path> &redfishLogFiles)
 {
-    static const std::filesystem::path redfishLogDir = "/var/log";
-    static const std::string redfishLogFilename = "redfish";
 
     // Loop through the directory looking for redfish log files
     for (const std::filesystem::directory_entry &dirEnt :
@@ -413,7 +517,8 @@ static bool
         std::string filename = dirEnt.path().filename();
         if (boost::starts_with(filename, redfishLogFilename))
         {
-            redfishLogFiles.emplace_back(redfishLogDir / filename);
+            redfishLogFiles.emplace_back(
+                std::filesystem::path(redfishLogDir) / filename);
         }
     }
     // As the log files rotate, they are appended with a ".#" that is higher for
@@ -515,57 +620,6 @@ class EventLogService : public Node
     }
 };
 
-class EventLogClear : public Node
-{
-  public:
-    EventLogClear(CrowApp &app) :
-        Node(app, "/redfish/v1/Systems/system/LogServices/EventLog/Actions/"
-                  "LogService.ClearLog/")
-    {
-        entityPrivileges = {
-            {boost::beast::http::verb::get, {{"Login"}}},
-            {boost::beast::http::verb::head, {{"Login"}}},
-            {boost::beast::http::verb::patch, {{"ConfigureComponents"}}},
-            {boost::beast::http::verb::put, {{"ConfigureComponents"}}},
-            {boost::beast::http::verb::delete_, {{"ConfigureComponents"}}},
-            {boost::beast::http::verb::post, {{"ConfigureComponents"}}}};
-    }
-
-  private:
-    void doPost(crow::Response &res, const crow::Request &req,
-                const std::vector<std::string> &params) override
-    {
-        std::shared_ptr<AsyncResp> asyncResp = std::make_shared<AsyncResp>(res);
-
-        // Clear the EventLog by deleting the log files
-        std::vector<std::filesystem::path> redfishLogFiles;
-        if (getRedfishLogFiles(redfishLogFiles))
-        {
-            for (const std::filesystem::path &file : redfishLogFiles)
-            {
-                std::error_code ec;
-                std::filesystem::remove(file, ec);
-            }
-        }
-
-        // Reload rsyslog so it knows to start new log files
-        crow::connections::systemBus->async_method_call(
-            [asyncResp](const boost::system::error_code ec) {
-                if (ec)
-                {
-                    BMCWEB_LOG_ERROR << "Failed to reload rsyslog: " << ec;
-                    messages::internalError(asyncResp->res);
-                    return;
-                }
-
-                messages::success(asyncResp->res);
-            },
-            "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-            "org.freedesktop.systemd1.Manager", "ReloadUnit", "rsyslog.service",
-            "replace");
-    }
-};
-
 static int fillEventLogEntryJson(const std::string &logEntryID,
                                  const std::string logEntry,
                                  nlohmann::json &logEntryJson)
@@ -598,17 +652,9 @@ static int fillEventLogEntryJson(const std::string &logEntryID,
     std::string &messageID = logEntryFields[0];
 
     // Get the Message from the MessageRegistry
-    const message_registries::Message *message =
+    const message_registries::MessageTemplate *messageTemplate =
         message_registries::getMessage(messageID);
 
-    std::string msg;
-    std::string severity;
-    if (message != nullptr)
-    {
-        msg = message->message;
-        severity = message->severity;
-    }
-
     // Get the MessageArgs from the log if there are any
     boost::beast::span<std::string> messageArgs;
     if (logEntryFields.size() > 1)
@@ -622,18 +668,15 @@ static int fillEventLogEntryJson(const std::string &logEntryID,
         }
 
         messageArgs = boost::beast::span(&messageArgsStart, messageArgsSize);
+    }
 
-        // Fill the MessageArgs into the Message
-        int i = 0;
-        for (const std::string &messageArg : messageArgs)
-        {
-            std::string argStr = "%" + std::to_string(++i);
-            size_t argPos = msg.find(argStr);
-            if (argPos != std::string::npos)
-            {
-                msg.replace(argPos, argStr.length(), messageArg);
-            }
-        }
+    // Fill the MessageArgs into the Message
+    std::string msg;
+    std::string severity;
+    if (messageTemplate != nullptr)
+    {
+        message_registries::appendMessage(msg, *messageTemplate, messageArgs);
+        severity = messageTemplate->message->severity;
     }
 
     // Get the Created time from the timestamp. The log timestamp is in RFC3339
@@ -664,6 +707,69 @@ static int fillEventLogEntryJson(const std::string &logEntryID,
     return 0;
 }
 
+/**
+ * @brief Returns the follower of the redfish event log
+ */
+inline event_log_util::EventLogTail &
+    getEventLogTail(boost::asio::io_context &ioc)
+{
+    static event_log_util::EventLogTail tail(
+        ioc, redfishLogDir, redfishLogFilename, fillEventLogEntryJson);
+    return tail;
+}
+
+class EventLogClear : public Node
+{
+  public:
+    EventLogClear(CrowApp &app) :
+        Node(app, "/redfish/v1/Systems/system/LogServices/EventLog/Actions/"
+                  "LogService.ClearLog/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureComponents"}}},
+            {boost::beast::http::verb::put, {{"ConfigureComponents"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureComponents"}}},
+            {boost::beast::http::verb::post, {{"ConfigureComponents"}}}};
+    }
+
+  private:
+    void doPost(crow::Response &res, const crow::Request &req,
+                const std::vector<std::string> &params) override
+    {
+        std::shared_ptr<AsyncResp> asyncResp = std::make_shared<AsyncResp>(res);
+
+        // Clear the EventLog by deleting the log files
+        getEventLogTail(*req.ioService).clear();
+        std::vector<std::filesystem::path> redfishLogFiles;
+        if (getRedfishLogFiles(redfishLogFiles))
+        {
+            for (const std::filesystem::path &file : redfishLogFiles)
+            {
+                std::error_code ec;
+                std::filesystem::remove(file, ec);
+            }
+        }
+
+        // Reload rsyslog so it knows to start new log files
+        crow::connections::systemBus->async_method_call(
+            [asyncResp](const boost::system::error_code ec) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to reload rsyslog: " << ec;
+                    messages::internalError(asyncResp->res);
+                    return;
+                }
+
+                messages::success(asyncResp->res);
+            },
+            "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+            "org.freedesktop.systemd1.Manager", "ReloadUnit", "rsyslog.service",
+            "replace");
+    }
+};
+
 class JournalEventLogEntryCollection : public Node
 {
   public:
@@ -709,52 +815,42 @@ class JournalEventLogEntryCollection : public Node
 
         nlohmann::json &logEntryArray = asyncResp->res.jsonValue["Members"];
         logEntryArray = nlohmann::json::array();
-        // Go through the log files and create a unique ID for each entry
-        std::vector<std::filesystem::path> redfishLogFiles;
-        getRedfishLogFiles(redfishLogFiles);
-        uint64_t entryCount = 0;
-        std::string logEntry;
-
-        // Oldest logs are in the last file, so start there and loop backwards
-        for (auto it = redfishLogFiles.rbegin(); it < redfishLogFiles.rend();
-             it++)
+        // Pages within the newest entries are served from memory, otherwise
+        // only the requested page is read from the log files
+        event_log_util::EventLogTail &tail = getEventLogTail(*req.ioService);
+        event_log_util::EventLogIndex &logIndex = tail.getIndex();
+        uint64_t entryCount = logIndex.size();
+        uint64_t pageEnd =
+            std::min(static_cast<uint64_t>(skip + top), entryCount);
+        if (static_cast<uint64_t>(skip) < pageEnd &&
+            tail.getRecentEntry(skip) != nullptr)
         {
-            std::ifstream logStream(*it);
-            if (!logStream.is_open())
+            for (uint64_t position = skip; position < pageEnd; position++)
             {
-                continue;
+                logEntryArray.push_back(*tail.getRecentEntry(position));
             }
-
-            // Reset the unique ID on the first entry
-            bool firstEntry = true;
-            while (std::getline(logStream, logEntry))
+        }
+        else
+        {
+            bool entryValid = true;
+            bool readOk = logIndex.getEntries(
+                skip, top,
+                [&logEntryArray, &entryValid](const std::string &idStr,
+                                              const std::string &logEntry) {
+                    logEntryArray.push_back({});
+                    nlohmann::json &bmcLogEntry = logEntryArray.back();
+                    if (fillEventLogEntryJson(idStr, logEntry, bmcLogEntry) !=
+                        0)
+                    {
+                        entryValid = false;
+                        return false;
+                    }
+                    return true;
+                });
+            if (!readOk || !entryValid)
             {
-                entryCount++;
-                // Handle paging using skip (number of entries to skip from the
-                // start) and top (number of entries to display)
-                if (entryCount <= skip || entryCount > skip + top)
-                {
-                    continue;
-                }
-
-                std::string idStr;
-                if (!getUniqueEntryID(logEntry, idStr, firstEntry))
-                {
-                    continue;
-                }
-
-                if (firstEntry)
-                {
-                    firstEntry = false;
-                }
-
-                logEntryArray.push_back({});
-                nlohmann::json &bmcLogEntry = logEntryArray.back();
-                if (fillEventLogEntryJson(idStr, logEntry, bmcLogEntry) != 0)
-                {
-                    messages::internalError(asyncResp->res);
-                    return;
-                }
+                messages::internalError(asyncResp->res);
+                return;
             }
         }
         asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
@@ -797,48 +893,26 @@ class JournalEventLogEntry : public Node
         }
         const std::string &targetID = params[0];
 
-        // Go through the log files and check the unique ID for each entry to
-        // find the target entry
-        std::vector<std::filesystem::path> redfishLogFiles;
-        getRedfishLogFiles(redfishLogFiles);
-        std::string logEntry;
-
-        // Oldest logs are in the last file, so start there and loop backwards
-        for (auto it = redfishLogFiles.rbegin(); it < redfishLogFiles.rend();
-             it++)
+        // Recent entries are held in memory.  Otherwise look the ID up in the
+        // line index and read only that entry
+        event_log_util::EventLogTail &tail = getEventLogTail(*req.ioService);
+        event_log_util::EventLogIndex &logIndex = tail.getIndex();
+        const nlohmann::json *recentEntry = tail.findRecentEntry(targetID);
+        if (recentEntry != nullptr)
         {
-            std::ifstream logStream(*it);
-            if (!logStream.is_open())
-            {
-                continue;
-            }
+            asyncResp->res.jsonValue = *recentEntry;
+            return;
+        }
 
-            // Reset the unique ID on the first entry
-            bool firstEntry = true;
-            while (std::getline(logStream, logEntry))
+        std::string logEntry;
+        if (logIndex.findEntry(targetID, logEntry))
+        {
+            if (fillEventLogEntryJson(targetID, logEntry,
+                                      asyncResp->res.jsonValue) != 0)
             {
-                std::string idStr;
-                if (!getUniqueEntryID(logEntry, idStr, firstEntry))
-                {
-                    continue;
-                }
-
-                if (firstEntry)
-                {
-                    firstEntry = false;
-                }
-
-                if (idStr == targetID)
-                {
-                    if (fillEventLogEntryJson(idStr, logEntry,
-                                              asyncResp->res.jsonValue) != 0)
-                    {
-                        messages::internalError(asyncResp->res);
-                        return;
-                    }
-                    return;
-                }
+                messages::internalError(asyncResp->res);
             }
+            return;
         }
         // Requested ID was not found
         messages::resourceMissingAtURI(asyncResp->res, targetID);
@@ -1330,8 +1404,15 @@ class BMCJournalLogEntryCollection : public Node
         nlohmann::json &logEntryArray = asyncResp->res.jsonValue["Members"];
         logEntryArray = nlohmann::json::array();
 
-        // Go through the journal and use the timestamp to create a unique ID
-        // for each entry
+        // The count is kept up to date incrementally rather than walking the
+        // whole journal on every request
+        uint64_t entryCount = 0;
+        if (!JournalEntryCounter::getInstance().getCount(entryCount))
+        {
+            messages::internalError(asyncResp->res);
+            return;
+        }
+
         sd_journal *journalTmp = nullptr;
         int ret = sd_journal_open(&journalTmp, SD_JOURNAL_LOCAL_ONLY);
         if (ret < 0)
@@ -1343,28 +1424,64 @@ class BMCJournalLogEntryCollection : public Node
         std::unique_ptr<sd_journal, decltype(&sd_journal_close)> journal(
             journalTmp, sd_journal_close);
         journalTmp = nullptr;
-        uint64_t entryCount = 0;
-        // Reset the unique ID on the first entry
-        bool firstEntry = true;
-        SD_JOURNAL_FOREACH(journal.get())
+
+        // A $skiptoken from a previous nextLink holds the journal cursor of
+        // the first entry of the page, so seek straight to it.  Otherwise
+        // fall back to counting $skip entries from the start.
+        char *skipToken = req.urlParams.get("$skiptoken");
+        if (skipToken != nullptr)
         {
-            entryCount++;
-            // Handle paging using skip (number of entries to skip from the
-            // start) and top (number of entries to display)
-            if (entryCount <= skip || entryCount > skip + top)
+            std::string cursor;
+            if (!getJournalCursorFromSkipToken(skipToken, cursor))
             {
-                continue;
+                messages::queryParameterValueFormatError(
+                    asyncResp->res, std::string(skipToken), "$skiptoken");
+                return;
             }
-
-            std::string idStr;
-            if (!getUniqueEntryID(journal.get(), idStr, firstEntry))
+            ret = sd_journal_seek_cursor(journal.get(), cursor.c_str());
+            if (ret < 0)
             {
-                continue;
+                messages::queryParameterValueFormatError(
+                    asyncResp->res, std::string(skipToken), "$skiptoken");
+                return;
             }
+            // If the entry has since been vacuumed, this lands on the closest
+            // remaining one
+            ret = sd_journal_next(journal.get());
+        }
+        else
+        {
+            sd_journal_seek_head(journal.get());
+            ret = sd_journal_next_skip(journal.get(),
+                                       static_cast<uint64_t>(skip) + 1);
+            if (ret >= 0 && ret <= skip)
+            {
+                // Skipped past the end of the journal
+                ret = 0;
+            }
+        }
 
-            if (firstEntry)
+        std::string idStr;
+        if (ret > 0 && !getUniqueEntryIDInContext(journal.get(), idStr))
+        {
+            messages::internalError(asyncResp->res);
+            return;
+        }
+        long entriesOnPage = 0;
+        while (ret > 0)
+        {
+            if (entriesOnPage == top)
             {
-                firstEntry = false;
+                // The journal is now on the first entry of the next page
+                std::string nextToken = getJournalSkipToken(journal.get());
+                if (!nextToken.empty())
+                {
+                    asyncResp->res.jsonValue["Members@odata.nextLink"] =
+                        "/redfish/v1/Managers/bmc/LogServices/Journal/"
+                        "Entries?$skiptoken=" +
+                        nextToken;
+                }
+                break;
             }
 
             logEntryArray.push_back({});
@@ -1375,14 +1492,16 @@ class BMCJournalLogEntryCollection : public Node
                 messages::internalError(asyncResp->res);
                 return;
             }
+            entriesOnPage++;
+
+            ret = sd_journal_next(journal.get());
+            if (ret > 0 && !getUniqueEntryID(journal.get(), idStr, false))
+            {
+                messages::internalError(asyncResp->res);
+                return;
+            }
         }
         asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
-        if (skip + top < entryCount)
-        {
-            asyncResp->res.jsonValue["Members@odata.nextLink"] =
-                "/redfish/v1/Managers/bmc/LogServices/Journal/Entries?$skip=" +
-                std::to_string(skip + top);
-        }
     }
 };
 
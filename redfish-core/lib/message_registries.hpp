@@ -37,6 +37,7 @@ class MessageRegistryFileCollection : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache();
     }
 
   private:
@@ -81,6 +82,7 @@ class BaseMessageRegistryFile : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache();
     }
 
   private:
@@ -122,6 +124,7 @@ class BaseMessageRegistry : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache();
     }
 
   private:
@@ -183,6 +186,7 @@ class OpenBMCMessageRegistryFile : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache();
     }
 
   private:
@@ -223,6 +227,7 @@ class OpenBMCMessageRegistry : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache();
     }
 
   private:
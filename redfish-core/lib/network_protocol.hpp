@@ -154,6 +154,13 @@ class NetworkProtocol : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        // Unit states, the hostname and NTP settings all emit signals when
+        // they change; the TTL bounds anything that slips past them
+        enableResponseCache(
+            std::chrono::seconds(10),
+            {"type='signal',path_namespace='/org/freedesktop/systemd1/unit'",
+             "type='signal',path_namespace='/xyz/openbmc_project/network'",
+             "type='signal',path_namespace='/xyz/openbmc_project/time'"});
     }
 
   private:
@@ -84,6 +84,9 @@ class SystemPCIeDevice : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache(
+            std::chrono::seconds(60),
+            {"type='signal',path_namespace='/xyz/openbmc_project/PCIe'"});
     }
 
   private:
@@ -196,6 +199,9 @@ class SystemPCIeFunction : public Node
             {boost::beast::http::verb::put, {{"ConfigureManager"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
             {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        enableResponseCache(
+            std::chrono::seconds(60),
+            {"type='signal',path_namespace='/xyz/openbmc_project/PCIe'"});
     }
 
   private:
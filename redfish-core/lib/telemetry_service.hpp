@@ -0,0 +1,767 @@
+/*
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include "node.hpp"
+
+#include <array>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <optional>
+#include <sdbusplus/bus/match.hpp>
+#include <string>
+#include <utils/telemetry_utils.hpp>
+#include <variant>
+#include <vector>
+
+namespace redfish
+{
+
+namespace telemetry
+{
+// Upper bound of the memory used for sensor history
+constexpr size_t memoryBudget = 1024 * 1024;
+
+constexpr const char *sensorsPath = "/xyz/openbmc_project/sensors";
+constexpr const char *sensorValueInterface =
+    "xyz.openbmc_project.Sensor.Value";
+
+using SensorVariant =
+    std::variant<int64_t, double, uint32_t, bool, std::string>;
+
+/**
+ * @brief Samples every sensor once a second into a MetricStore
+ *
+ * Sensor values are kept up to date from PropertiesChanged signals, so taking
+ * a sample doesn't need any D-Bus calls.  Sensors are found once at startup;
+ * ones that appear later are added when they first report a value, as long as
+ * the memory budget allows.
+ */
+class SensorSampler
+{
+  public:
+    static SensorSampler &getInstance()
+    {
+        static SensorSampler sampler(
+            crow::connections::systemBus->get_io_context());
+        return sampler;
+    }
+
+    SensorSampler(const SensorSampler &) = delete;
+    SensorSampler &operator=(const SensorSampler &) = delete;
+
+    const telemetry_util::MetricStore &getStore() const
+    {
+        return store;
+    }
+
+    /**
+     * @brief Latest reading of every sensor
+     *
+     * Sensors are added to the store in the order they are found, so the
+     * first getStore().size() sensors of the table are the sampled metrics,
+     * with the same indices.
+     */
+    const telemetry_util::SensorTable &getTable() const
+    {
+        return table;
+    }
+
+    /**
+     * @brief Number of samples taken so far
+     */
+    uint64_t getSampleCount() const
+    {
+        return sampleCount;
+    }
+
+  private:
+    SensorSampler(boost::asio::io_context &ioc) :
+        // Start numbering changes from the current time in microseconds, so
+        // sequences keep increasing across restarts and a client holding one
+        // from before a restart gets every sensor again
+        table(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count())),
+        store(memoryBudget), timer(ioc),
+        valueMatch(
+            *crow::connections::systemBus,
+            sdbusplus::bus::match::rules::type::signal() +
+                sdbusplus::bus::match::rules::member("PropertiesChanged") +
+                sdbusplus::bus::match::rules::interface(
+                    "org.freedesktop.DBus.Properties") +
+                sdbusplus::bus::match::rules::path_namespace(sensorsPath) +
+                sdbusplus::bus::match::rules::argN(0, sensorValueInterface),
+            [this](sdbusplus::message::message &m) {
+                std::string interface;
+                boost::container::flat_map<std::string, SensorVariant>
+                    properties;
+                m.read(interface, properties);
+                auto value = properties.find("Value");
+                if (value != properties.end())
+                {
+                    setValue(m.get_path(), value->second, std::nullopt);
+                }
+            })
+    {
+        findSensors();
+        timer.expires_after(std::chrono::seconds(1));
+        takeSample();
+    }
+
+    void findSensors()
+    {
+        crow::connections::systemBus->async_method_call(
+            [this](const boost::system::error_code ec,
+                   const std::vector<std::pair<
+                       std::string,
+                       std::vector<std::pair<std::string,
+                                             std::vector<std::string>>>>>
+                       &subtree) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to find sensors: " << ec;
+                    return;
+                }
+                for (const auto &object : subtree)
+                {
+                    if (object.second.empty())
+                    {
+                        continue;
+                    }
+                    readSensor(object.first, object.second.front().first);
+                }
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree", sensorsPath, 2,
+            std::array<const char *, 1>{sensorValueInterface});
+    }
+
+    void readSensor(const std::string &path, const std::string &service)
+    {
+        crow::connections::systemBus->async_method_call(
+            [this, path](
+                const boost::system::error_code ec,
+                const boost::container::flat_map<std::string, SensorVariant>
+                    &properties) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to read " << path << ": "
+                                     << ec;
+                    return;
+                }
+                auto value = properties.find("Value");
+                if (value == properties.end())
+                {
+                    return;
+                }
+                int64_t scale = 0;
+                auto scaleIt = properties.find("Scale");
+                if (scaleIt != properties.end())
+                {
+                    const int64_t *scaleValue =
+                        std::get_if<int64_t>(&scaleIt->second);
+                    if (scaleValue != nullptr)
+                    {
+                        scale = *scaleValue;
+                    }
+                }
+                setValue(path, value->second, scale);
+            },
+            service, path, "org.freedesktop.DBus.Properties", "GetAll",
+            sensorValueInterface);
+    }
+
+    /**
+     * @brief Updates the reading a sensor will be sampled with
+     *
+     * @param[i] path   Sensor path
+     * @param[i] value  Value property
+     * @param[i] scale  Scale property, if it's known
+     */
+    void setValue(const std::string &path, const SensorVariant &value,
+                  std::optional<int64_t> scale)
+    {
+        std::optional<size_t> index = table.find(path);
+        size_t sensor = index ? *index : table.size();
+        if (!index)
+        {
+            scales.emplace_back(0);
+        }
+        if (scale)
+        {
+            scales[sensor] = *scale;
+        }
+
+        double reading = std::numeric_limits<double>::quiet_NaN();
+        if (const double *doubleValue = std::get_if<double>(&value))
+        {
+            reading = *doubleValue;
+        }
+        else if (const int64_t *intValue = std::get_if<int64_t>(&value))
+        {
+            reading = static_cast<double>(*intValue) *
+                      std::pow(10.0, static_cast<double>(scales[sensor]));
+        }
+        table.set(path, static_cast<float>(reading));
+
+        // Once the budget is used up, no later sensor fits either
+        if (!index && sensor == store.size() && !store.addMetric())
+        {
+            BMCWEB_LOG_ERROR << "No room in the telemetry budget for " << path
+                             << " and any sensor found after it";
+        }
+    }
+
+    void takeSample()
+    {
+        timer.async_wait([this](const boost::system::error_code &ec) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "Telemetry timer failed: " << ec;
+                return;
+            }
+            store.sample(static_cast<uint64_t>(std::time(nullptr)),
+                         table.getValues());
+            sampleCount++;
+            // Relative to the last expiry, so the interval doesn't drift
+            timer.expires_at(timer.expiry() + std::chrono::seconds(1));
+            takeSample();
+        });
+    }
+
+    telemetry_util::SensorTable table;
+    telemetry_util::MetricStore store;
+    boost::asio::steady_timer timer;
+    sdbusplus::bus::match::match valueMatch;
+    // Scale of each sensor in the table
+    std::vector<int64_t> scales;
+    uint64_t sampleCount = 0;
+};
+
+/**
+ * @brief Splits a sensor path into its type and name
+ */
+inline bool getSensorTypeAndName(std::string_view path, std::string_view &type,
+                                 std::string_view &name)
+{
+    std::string_view prefix = sensorsPath;
+    if (path.substr(0, prefix.size()) != prefix ||
+        path.size() <= prefix.size() + 1)
+    {
+        return false;
+    }
+    path.remove_prefix(prefix.size() + 1);
+    size_t slash = path.find('/');
+    if (slash == std::string_view::npos)
+    {
+        return false;
+    }
+    type = path.substr(0, slash);
+    name = path.substr(slash + 1);
+    return true;
+}
+
+/**
+ * @brief Calls f(reportId, sensorType, tier) for every report, which hold
+ * one tier of the history of one type of sensor
+ */
+template <typename Callback> void forEachReport(Callback &&f)
+{
+    const SensorSampler &sampler = SensorSampler::getInstance();
+    boost::container::flat_set<std::string_view> types;
+    for (size_t metric = 0; metric < sampler.getStore().size(); metric++)
+    {
+        std::string_view type;
+        std::string_view name;
+        if (getSensorTypeAndName(sampler.getTable().getPath(metric), type,
+                                 name))
+        {
+            types.insert(type);
+        }
+    }
+    const telemetry_util::MetricStore &store = sampler.getStore();
+    for (std::string_view type : types)
+    {
+        for (size_t tier = 0; tier < store.tierCount; tier++)
+        {
+            std::string reportId(type);
+            reportId += '_';
+            reportId += std::to_string(store.interval(tier));
+            reportId += 's';
+            f(reportId, type, tier);
+        }
+    }
+}
+
+/**
+ * @brief Finds the sensor type and tier of a report
+ */
+inline bool findReport(const std::string &reportId, std::string &type,
+                       size_t &tier)
+{
+    bool found = false;
+    forEachReport([&](const std::string &id, std::string_view reportType,
+                      size_t reportTier) {
+        if (!found && id == reportId)
+        {
+            type = reportType;
+            tier = reportTier;
+            found = true;
+        }
+    });
+    return found;
+}
+
+inline std::string getDuration(uint32_t seconds)
+{
+    return "PT" + std::to_string(seconds) + "S";
+}
+
+inline std::string formatReading(float value)
+{
+    std::array<char, 32> buffer;
+    int length = std::snprintf(buffer.data(), buffer.size(), "%g",
+                               static_cast<double>(value));
+    return std::string(buffer.data(),
+                       static_cast<size_t>(std::max(length, 0)));
+}
+
+} // namespace telemetry
+
+class TelemetryService : public Node
+{
+  public:
+    TelemetryService(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+        // History has to be collected before anyone asks for it
+        telemetry::SensorSampler::getInstance();
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        size_t reportCount = 0;
+        telemetry::forEachReport(
+            [&reportCount](const std::string &, std::string_view, size_t) {
+                reportCount++;
+            });
+        res.jsonValue = {
+            {"@odata.type", "#TelemetryService.v1_1_2.TelemetryService"},
+            {"@odata.context",
+             "/redfish/v1/$metadata#TelemetryService.TelemetryService"},
+            {"@odata.id", "/redfish/v1/TelemetryService"},
+            {"Id", "TelemetryService"},
+            {"Name", "Telemetry Service"},
+            {"Status", {{"State", "Enabled"}, {"Health", "OK"}}},
+            {"MaxReports", reportCount},
+            {"MinCollectionInterval", telemetry::getDuration(1)},
+            {"MetricReportDefinitions",
+             {{"@odata.id",
+               "/redfish/v1/TelemetryService/MetricReportDefinitions"}}},
+            {"MetricReports",
+             {{"@odata.id", "/redfish/v1/TelemetryService/MetricReports"}}},
+            {"Oem",
+             {{"OpenBMC",
+               {{"SensorChanges",
+                 {{"@odata.id", "/redfish/v1/TelemetryService/Oem/OpenBMC/"
+                                "SensorChanges"}}}}}}}};
+        res.end();
+    }
+};
+
+class MetricReportDefinitionCollection : public Node
+{
+  public:
+    MetricReportDefinitionCollection(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/MetricReportDefinitions/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        nlohmann::json members = nlohmann::json::array();
+        telemetry::forEachReport(
+            [&members](const std::string &id, std::string_view, size_t) {
+                members.push_back(
+                    {{"@odata.id",
+                      "/redfish/v1/TelemetryService/MetricReportDefinitions/" +
+                          id}});
+            });
+        res.jsonValue = {
+            {"@odata.type", "#MetricReportDefinitionCollection."
+                            "MetricReportDefinitionCollection"},
+            {"@odata.context", "/redfish/v1/"
+                               "$metadata#MetricReportDefinitionCollection."
+                               "MetricReportDefinitionCollection"},
+            {"@odata.id",
+             "/redfish/v1/TelemetryService/MetricReportDefinitions"},
+            {"Name", "Metric Definition Collection"},
+            {"Members@odata.count", members.size()},
+            {"Members", std::move(members)}};
+        res.end();
+    }
+};
+
+class MetricReportDefinition : public Node
+{
+  public:
+    MetricReportDefinition(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/MetricReportDefinitions/<str>/",
+             std::string())
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        if (params.size() != 1)
+        {
+            messages::internalError(res);
+            res.end();
+            return;
+        }
+        const std::string &id = params[0];
+        std::string type;
+        size_t tier = 0;
+        if (!telemetry::findReport(id, type, tier))
+        {
+            messages::resourceNotFound(res, "MetricReportDefinition", id);
+            res.end();
+            return;
+        }
+
+        const telemetry::SensorSampler &sampler =
+            telemetry::SensorSampler::getInstance();
+        uint32_t interval = sampler.getStore().interval(tier);
+        std::string duration = telemetry::getDuration(interval);
+        std::vector<const char *> functions = {"Average"};
+        if (interval != 1)
+        {
+            functions = {"Minimum", "Maximum", "Average"};
+        }
+
+        nlohmann::json metrics = nlohmann::json::array();
+        for (size_t metric = 0; metric < sampler.getStore().size(); metric++)
+        {
+            std::string_view sensorType;
+            std::string_view name;
+            if (!telemetry::getSensorTypeAndName(
+                    sampler.getTable().getPath(metric), sensorType, name) ||
+                sensorType != type)
+            {
+                continue;
+            }
+            for (const char *function : functions)
+            {
+                std::string metricId(name);
+                if (interval != 1)
+                {
+                    metricId += '_';
+                    metricId += function;
+                }
+                metrics.push_back({{"MetricId", std::move(metricId)},
+                                   {"CollectionFunction", function},
+                                   {"CollectionDuration", duration}});
+            }
+        }
+
+        res.jsonValue = {
+            {"@odata.type",
+             "#MetricReportDefinition.v1_2_0.MetricReportDefinition"},
+            {"@odata.context", "/redfish/v1/"
+                               "$metadata#MetricReportDefinition."
+                               "MetricReportDefinition"},
+            {"@odata.id",
+             "/redfish/v1/TelemetryService/MetricReportDefinitions/" + id},
+            {"Id", id},
+            {"Name", "Sensor " + type + " history"},
+            {"MetricReportDefinitionType", "Periodic"},
+            {"ReportUpdates", "Overwrite"},
+            {"Schedule", {{"RecurrenceInterval", duration}}},
+            {"Status", {{"State", "Enabled"}, {"Health", "OK"}}},
+            {"Metrics", std::move(metrics)},
+            {"MetricReport",
+             {{"@odata.id",
+               "/redfish/v1/TelemetryService/MetricReports/" + id}}}};
+        res.end();
+    }
+};
+
+class MetricReportCollection : public Node
+{
+  public:
+    MetricReportCollection(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/MetricReports/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        nlohmann::json members = nlohmann::json::array();
+        telemetry::forEachReport(
+            [&members](const std::string &id, std::string_view, size_t) {
+                members.push_back(
+                    {{"@odata.id",
+                      "/redfish/v1/TelemetryService/MetricReports/" + id}});
+            });
+        res.jsonValue = {
+            {"@odata.type", "#MetricReportCollection.MetricReportCollection"},
+            {"@odata.context",
+             "/redfish/v1/"
+             "$metadata#MetricReportCollection.MetricReportCollection"},
+            {"@odata.id", "/redfish/v1/TelemetryService/MetricReports"},
+            {"Name", "Metric Report Collection"},
+            {"Members@odata.count", members.size()},
+            {"Members", std::move(members)}};
+        res.end();
+    }
+};
+
+class MetricReport : public Node
+{
+  public:
+    MetricReport(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/MetricReports/<str>/",
+             std::string())
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        if (params.size() != 1)
+        {
+            messages::internalError(res);
+            res.end();
+            return;
+        }
+        const std::string &id = params[0];
+        std::string type;
+        size_t tier = 0;
+        if (!telemetry::findReport(id, type, tier))
+        {
+            messages::resourceNotFound(res, "MetricReport", id);
+            res.end();
+            return;
+        }
+
+        const telemetry::SensorSampler &sampler =
+            telemetry::SensorSampler::getInstance();
+        const telemetry_util::MetricStore &store = sampler.getStore();
+        bool downsampled = store.interval(tier) != 1;
+
+        // Every sensor shares the sample times, so format them only once
+        size_t sampleCount = store.sampleCount(tier);
+        std::vector<std::string> timestamps;
+        timestamps.reserve(sampleCount);
+        for (size_t n = 0; n < sampleCount; n++)
+        {
+            timestamps.emplace_back(crow::utility::getDateTime(
+                static_cast<std::time_t>(store.timestamp(tier, n))));
+        }
+
+        nlohmann::json metricValues = nlohmann::json::array();
+        for (size_t metric = 0; metric < store.size(); metric++)
+        {
+            std::string_view sensorType;
+            std::string_view name;
+            if (!telemetry::getSensorTypeAndName(
+                    sampler.getTable().getPath(metric), sensorType, name) ||
+                sensorType != type)
+            {
+                continue;
+            }
+            std::string metricId(name);
+            for (size_t n = 0; n < sampleCount; n++)
+            {
+                telemetry_util::MetricSample sample =
+                    store.get(metric, tier, n);
+                if (std::isnan(sample.avg))
+                {
+                    continue;
+                }
+                if (!downsampled)
+                {
+                    metricValues.push_back(
+                        {{"MetricId", metricId},
+                         {"MetricValue", telemetry::formatReading(sample.avg)},
+                         {"Timestamp", timestamps[n]}});
+                    continue;
+                }
+                metricValues.push_back(
+                    {{"MetricId", metricId + "_Minimum"},
+                     {"MetricValue", telemetry::formatReading(sample.min)},
+                     {"Timestamp", timestamps[n]}});
+                metricValues.push_back(
+                    {{"MetricId", metricId + "_Maximum"},
+                     {"MetricValue", telemetry::formatReading(sample.max)},
+                     {"Timestamp", timestamps[n]}});
+                metricValues.push_back(
+                    {{"MetricId", metricId + "_Average"},
+                     {"MetricValue", telemetry::formatReading(sample.avg)},
+                     {"Timestamp", timestamps[n]}});
+            }
+        }
+
+        res.jsonValue = {
+            {"@odata.type", "#MetricReport.v1_2_0.MetricReport"},
+            {"@odata.context",
+             "/redfish/v1/$metadata#MetricReport.MetricReport"},
+            {"@odata.id", "/redfish/v1/TelemetryService/MetricReports/" + id},
+            {"Id", id},
+            {"Name", "Sensor " + type + " history"},
+            {"ReportSequence", std::to_string(sampler.getSampleCount())},
+            {"Timestamp", crow::utility::dateTimeNow()},
+            {"MetricReportDefinition",
+             {{"@odata.id",
+               "/redfish/v1/TelemetryService/MetricReportDefinitions/" + id}}},
+            {"MetricValues", std::move(metricValues)}};
+        res.end();
+    }
+};
+
+/**
+ * @brief Sensor readings that changed since a sequence the client saw
+ *
+ * GET ?since=<Sequence of the previous response> returns only the sensors
+ * that changed in between, straight from the sampler's table.  Without since,
+ * or with one the service doesn't know, every sensor is returned and Full is
+ * true.
+ */
+class SensorChanges : public Node
+{
+  public:
+    SensorChanges(CrowApp &app) :
+        Node(app, "/redfish/v1/TelemetryService/Oem/OpenBMC/SensorChanges/")
+    {
+        entityPrivileges = {
+            {boost::beast::http::verb::get, {{"Login"}}},
+            {boost::beast::http::verb::head, {{"Login"}}},
+            {boost::beast::http::verb::patch, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::put, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::delete_, {{"ConfigureManager"}}},
+            {boost::beast::http::verb::post, {{"ConfigureManager"}}}};
+    }
+
+  private:
+    void doGet(crow::Response &res, const crow::Request &req,
+               const std::vector<std::string> &params) override
+    {
+        const telemetry_util::SensorTable &table =
+            telemetry::SensorSampler::getInstance().getTable();
+
+        uint64_t since = 0;
+        char *sinceParam = req.urlParams.get("since");
+        if (sinceParam != nullptr)
+        {
+            char *ptr = nullptr;
+            since = std::strtoull(sinceParam, &ptr, 10);
+            if (*sinceParam == '\0' || *ptr != '\0')
+            {
+                messages::queryParameterValueTypeError(
+                    res, std::string(sinceParam), "since");
+                res.end();
+                return;
+            }
+        }
+        // Sequences from before a restart are older than any this table
+        // knows about
+        bool full = !table.isKnownSequence(since);
+        if (full)
+        {
+            since = 0;
+        }
+
+        nlohmann::json sensors = nlohmann::json::object();
+        size_t prefixLength =
+            std::char_traits<char>::length(telemetry::sensorsPath) + 1;
+        table.forEachChangeSince(
+            since, [&sensors, prefixLength](const std::string &path,
+                                            float value) {
+                nlohmann::json &reading = sensors[path.substr(prefixLength)];
+                if (!std::isnan(value))
+                {
+                    reading = value;
+                }
+            });
+
+        res.jsonValue = {
+            {"@odata.type", "#OemSensorChanges.v1_0_0.SensorChanges"},
+            {"@odata.id",
+             "/redfish/v1/TelemetryService/Oem/OpenBMC/SensorChanges"},
+            {"Id", "SensorChanges"},
+            {"Name", "Sensor Changes"},
+            {"Sequence", table.sequence()},
+            {"Full", full},
+            {"Sensors", std::move(sensors)}};
+        res.end();
+    }
+};
+
+} // namespace redfish
@@ -452,6 +452,9 @@ class SoftwareInventoryCollection : public Node
             {boost::beast::http::verb::put, {{"ConfigureComponents"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureComponents"}}},
             {boost::beast::http::verb::post, {{"ConfigureComponents"}}}};
+        enableResponseCache(
+            std::chrono::seconds(60),
+            {"type='signal',path_namespace='/xyz/openbmc_project/software'"});
     }
 
   private:
@@ -533,6 +536,9 @@ class SoftwareInventory : public Node
             {boost::beast::http::verb::put, {{"ConfigureComponents"}}},
             {boost::beast::http::verb::delete_, {{"ConfigureComponents"}}},
             {boost::beast::http::verb::post, {{"ConfigureComponents"}}}};
+        enableResponseCache(
+            std::chrono::seconds(60),
+            {"type='signal',path_namespace='/xyz/openbmc_project/software'"});
     }
 
   private:
@@ -0,0 +1,136 @@
+#include "utils/event_log_tail.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::event_log_util;
+
+namespace
+{
+
+int formatEntry(const std::string &entryID, const std::string &logEntry,
+                nlohmann::json &entryJson)
+{
+    entryJson = {{"Id", entryID}, {"Line", logEntry}};
+    return 0;
+}
+
+class EventLogTailTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "bmcweb_event_log_tail";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        EventLogIndex::getInstance().clear();
+    }
+
+    void TearDown() override
+    {
+        EventLogIndex::getInstance().clear();
+        std::filesystem::remove_all(dir);
+    }
+
+    void append(const std::string &filename, const std::string &lines)
+    {
+        std::ofstream out(dir / filename, std::ios::app);
+        out << lines;
+    }
+
+    std::filesystem::path dir;
+    boost::asio::io_context ioc;
+};
+
+std::string line(int second, const std::string &args)
+{
+    return "2019-05-01T10:00:" + std::string(second < 10 ? "0" : "") +
+           std::to_string(second) + "+00:00 OpenBMC.0.1.A," + args + "\n";
+}
+
+} // namespace
+
+TEST_F(EventLogTailTest, FollowsAppends)
+{
+    append("redfish", line(0, "1"));
+    EventLogTail tail(ioc, dir, "redfish", formatEntry);
+    std::vector<std::string> seen;
+    tail.addListener([&seen](const nlohmann::json &entry) {
+        seen.push_back(entry["Line"]);
+    });
+    EXPECT_EQ(tail.getIndex().size(), 1);
+    ASSERT_NE(tail.getRecentEntry(0), nullptr);
+
+    // Picked up by the next request, without waiting for the watch to run
+    append("redfish", line(1, "2") + line(1, "3"));
+    EXPECT_EQ(tail.getIndex().size(), 3);
+    const nlohmann::json *entry = tail.getRecentEntry(2);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_THAT((*entry)["Line"].get<std::string>(),
+                ::testing::EndsWith(",3"));
+    EXPECT_EQ(tail.findRecentEntry((*entry)["Id"].get<std::string>()), entry);
+    EXPECT_EQ(seen.size(), 2);
+
+    // Or by the watch between requests, and only reported once
+    append("redfish", line(2, "4"));
+    ioc.poll();
+    EXPECT_EQ(seen.size(), 3);
+    EXPECT_EQ(tail.getIndex().size(), 4);
+    EXPECT_EQ(seen.size(), 3);
+}
+
+TEST_F(EventLogTailTest, FollowsRotation)
+{
+    append("redfish", line(0, "1") + line(1, "2"));
+    EventLogTail tail(ioc, dir, "redfish", formatEntry);
+    std::vector<std::string> seen;
+    tail.addListener([&seen](const nlohmann::json &entry) {
+        seen.push_back(entry["Line"]);
+    });
+
+    std::filesystem::rename(dir / "redfish", dir / "redfish.1");
+    append("redfish", line(2, "3"));
+    EXPECT_EQ(tail.getIndex().size(), 3);
+    ASSERT_EQ(seen.size(), 1);
+    EXPECT_THAT(seen[0], ::testing::EndsWith(",3"));
+    const nlohmann::json *oldest = tail.getRecentEntry(0);
+    ASSERT_NE(oldest, nullptr);
+    EXPECT_THAT((*oldest)["Line"].get<std::string>(),
+                ::testing::EndsWith(",1"));
+
+    // Dropping the oldest file moves everything up
+    std::filesystem::remove(dir / "redfish.1");
+    EXPECT_EQ(tail.getIndex().size(), 1);
+    oldest = tail.getRecentEntry(0);
+    ASSERT_NE(oldest, nullptr);
+    EXPECT_THAT((*oldest)["Line"].get<std::string>(),
+                ::testing::EndsWith(",3"));
+    EXPECT_EQ(seen.size(), 1);
+}
+
+TEST_F(EventLogTailTest, Clear)
+{
+    append("redfish", line(0, "1") + line(1, "2"));
+    EventLogTail tail(ioc, dir, "redfish", formatEntry);
+    ASSERT_EQ(tail.getIndex().size(), 2);
+    std::string id = (*tail.getRecentEntry(1))["Id"];
+
+    tail.clear();
+    EXPECT_EQ(tail.getRecentEntry(0), nullptr);
+    EXPECT_EQ(tail.findRecentEntry(id), nullptr);
+
+    std::filesystem::remove(dir / "redfish");
+    EXPECT_EQ(tail.getIndex().size(), 0);
+
+    // A new log starts from scratch
+    append("redfish", line(5, "3"));
+    EXPECT_EQ(tail.getIndex().size(), 1);
+    ASSERT_NE(tail.getRecentEntry(0), nullptr);
+    EXPECT_THAT((*tail.getRecentEntry(0))["Line"].get<std::string>(),
+                ::testing::EndsWith(",3"));
+}
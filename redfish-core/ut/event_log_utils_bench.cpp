@@ -0,0 +1,79 @@
+#include "utils/event_log_utils.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::event_log_util;
+
+// Compares paged reads against a full scan on a synthetic 100k line log
+TEST(EventLogIndex, Benchmark)
+{
+    constexpr int lineCount = 100000;
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "bmcweb_event_log_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::path logFile = dir / "redfish";
+    {
+        std::ofstream out(logFile);
+        for (int i = 0; i < lineCount; i++)
+        {
+            out << "2019-05-01T10:" << std::setw(2) << std::setfill('0')
+                << (i / 60) % 60 << ":" << std::setw(2) << i % 60
+                << ".123456+00:00 OpenBMC.0.1.DIMMThermalTrip,DIMM" << i
+                << "\n";
+        }
+    }
+
+    auto timeIt = [](const char *name, auto &&func) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        std::cout << name << ": "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count()
+                  << "us\n";
+    };
+
+    timeIt("full scan for $skip=90000&$top=10", [&]() {
+        std::ifstream logStream(logFile);
+        std::string logEntry;
+        int entryCount = 0;
+        while (std::getline(logStream, logEntry))
+        {
+            entryCount++;
+        }
+        EXPECT_EQ(entryCount, lineCount);
+    });
+
+    EventLogIndex &index = EventLogIndex::getInstance();
+    index.clear();
+    timeIt("initial index build", [&]() { index.update({logFile}); });
+
+    std::vector<std::string> ids;
+    timeIt("indexed $skip=90000&$top=10", [&]() {
+        index.update({logFile});
+        EXPECT_TRUE(index.getEntries(
+            90000, 10, [&ids](const std::string &id, const std::string &) {
+                ids.push_back(id);
+                return true;
+            }));
+    });
+    ASSERT_EQ(ids.size(), 10);
+
+    timeIt("indexed single entry lookup", [&]() {
+        index.update({logFile});
+        std::string entry;
+        EXPECT_TRUE(index.findEntry(ids.back(), entry));
+    });
+
+    index.clear();
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,250 @@
+#include "utils/event_log_utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::event_log_util;
+
+namespace
+{
+
+class EventLogIndexTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "bmcweb_event_log_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        EventLogIndex::getInstance().clear();
+    }
+
+    void TearDown() override
+    {
+        EventLogIndex::getInstance().clear();
+        std::filesystem::remove_all(dir);
+    }
+
+    std::filesystem::path dir;
+};
+
+std::vector<std::string>
+    readAll(const EventLogIndex &index, uint64_t skip, uint64_t top,
+            std::vector<std::string> *ids = nullptr)
+{
+    std::vector<std::string> lines;
+    EXPECT_TRUE(index.getEntries(
+        skip, top, [&](const std::string &id, const std::string &line) {
+            lines.push_back(line);
+            if (ids != nullptr)
+            {
+                ids->push_back(id);
+            }
+            return true;
+        }));
+    return lines;
+}
+
+} // namespace
+
+TEST(EventLogUtils, ParseEntryID)
+{
+    uint64_t timestamp = 0;
+    uint32_t index = 0;
+    EXPECT_TRUE(parseEntryID("1559000000", timestamp, index));
+    EXPECT_EQ(timestamp, 1559000000);
+    EXPECT_EQ(index, 0);
+
+    EXPECT_TRUE(parseEntryID("1559000000_3", timestamp, index));
+    EXPECT_EQ(timestamp, 1559000000);
+    EXPECT_EQ(index, 3);
+    EXPECT_EQ(makeEntryID(timestamp, index), "1559000000_3");
+
+    EXPECT_FALSE(parseEntryID("", timestamp, index));
+    EXPECT_FALSE(parseEntryID("abc", timestamp, index));
+    EXPECT_FALSE(parseEntryID("1559000000_", timestamp, index));
+    EXPECT_FALSE(parseEntryID("1559000000_0", timestamp, index));
+    EXPECT_FALSE(parseEntryID("99999999999999999999999", timestamp, index));
+}
+
+TEST(EventLogUtils, TimestampParserMatchesGetTime)
+{
+    EntryTimestampParser parser;
+    for (const char *line :
+         {"2019-05-01T10:00:00+00:00 OpenBMC.0.1.A",
+          "2019-05-01T10:59:59.123456+00:00 OpenBMC.0.1.A",
+          "2019-05-01T11:00:01+00:00 OpenBMC.0.1.A",
+          "2019-12-31T23:30:00+00:00 OpenBMC.0.1.A", "2019-05-01 10:00:00",
+          "garbage", ""})
+    {
+        EXPECT_EQ(parser.parse(line), getEntryTimestamp(line)) << line;
+    }
+}
+
+TEST_F(EventLogIndexTest, PagesAcrossRotatedFiles)
+{
+    std::filesystem::path older = dir / "redfish.1";
+    std::filesystem::path newer = dir / "redfish";
+    {
+        std::ofstream out(older);
+        out << "2019-05-01T10:00:00+00:00 OpenBMC.0.1.A,1\n"
+               "2019-05-01T10:00:00+00:00 OpenBMC.0.1.B,2\n";
+    }
+    {
+        std::ofstream out(newer);
+        out << "2019-05-01T10:00:01+00:00 OpenBMC.0.1.C,3\n"
+               "2019-05-01T10:00:02+00:00 OpenBMC.0.1.D,4\n"
+               "2019-05-01T10:00:03+00:00 OpenBMC.0.1.E,5";
+    }
+
+    EventLogIndex &index = EventLogIndex::getInstance();
+    index.update({older, newer});
+    // The unterminated last line is still being written
+    EXPECT_EQ(index.size(), 4);
+
+    std::vector<std::string> ids;
+    std::vector<std::string> lines = readAll(index, 1, 2, &ids);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0], "2019-05-01T10:00:00+00:00 OpenBMC.0.1.B,2");
+    EXPECT_EQ(lines[1], "2019-05-01T10:00:01+00:00 OpenBMC.0.1.C,3");
+    // Duplicate timestamps within a file are numbered
+    EXPECT_THAT(ids[0], ::testing::EndsWith("_1"));
+
+    EXPECT_EQ(index.getEntryIDs(1, 2), ids);
+
+    std::string entry;
+    ASSERT_TRUE(index.findEntry(ids[1], entry));
+    EXPECT_EQ(entry, lines[1]);
+    EXPECT_FALSE(index.findEntry("1", entry));
+
+    // Appends are picked up incrementally
+    {
+        std::ofstream out(newer, std::ios::app);
+        out << "\n2019-05-01T10:00:04+00:00 OpenBMC.0.1.F,6\n";
+    }
+    index.update({older, newer});
+    EXPECT_EQ(index.size(), 6);
+    lines = readAll(index, 4, 10);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0], "2019-05-01T10:00:03+00:00 OpenBMC.0.1.E,5");
+    EXPECT_EQ(lines[1], "2019-05-01T10:00:04+00:00 OpenBMC.0.1.F,6");
+
+    // Rotation keeps the inode, so the index follows the renamed file
+    std::filesystem::path oldest = dir / "redfish.2";
+    std::filesystem::rename(older, oldest);
+    std::filesystem::rename(newer, older);
+    {
+        std::ofstream out(newer);
+        out << "2019-05-01T10:00:05+00:00 OpenBMC.0.1.G,7\n";
+    }
+    index.update({oldest, older, newer});
+    EXPECT_EQ(index.size(), 7);
+    lines = readAll(index, 6, 1);
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_EQ(lines[0], "2019-05-01T10:00:05+00:00 OpenBMC.0.1.G,7");
+
+    // Truncation forces a rebuild
+    {
+        std::ofstream out(newer, std::ios::trunc);
+    }
+    index.update({oldest, older, newer});
+    EXPECT_EQ(index.size(), 6);
+}
+
+TEST_F(EventLogIndexTest, RebuildsRewrittenFile)
+{
+    std::filesystem::path log = dir / "redfish";
+    {
+        std::ofstream out(log);
+        out << "2019-05-01T10:00:00+00:00 OpenBMC.0.1.A,1\n";
+    }
+    EventLogIndex &index = EventLogIndex::getInstance();
+    index.update({log});
+    EXPECT_EQ(index.size(), 1);
+
+    // Rewritten in place, keeping the inode and growing the file
+    {
+        std::ofstream out(log, std::ios::in | std::ios::out);
+        out << "2019-05-01T11:00:00+00:00 OpenBMC.0.1.B,2\n"
+               "2019-05-01T11:00:01+00:00 OpenBMC.0.1.C,3\n";
+    }
+    index.update({log});
+    EXPECT_EQ(index.size(), 2);
+    std::vector<std::string> ids;
+    std::vector<std::string> lines = readAll(index, 0, 10, &ids);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0], "2019-05-01T11:00:00+00:00 OpenBMC.0.1.B,2");
+    EXPECT_EQ(ids[0], makeEntryID(getEntryTimestamp(lines[0]), 0));
+}
+
+TEST_F(EventLogIndexTest, FindsEntriesByID)
+{
+    std::filesystem::path older = dir / "redfish.1";
+    std::filesystem::path newer = dir / "redfish";
+    {
+        std::ofstream out(older);
+        out << "2019-05-01T10:00:00+00:00 OpenBMC.0.1.A,1\n"
+               "2019-05-01T10:00:00+00:00 OpenBMC.0.1.B,2\n"
+               "2019-05-01T10:00:01+00:00 OpenBMC.0.1.C,3\n";
+    }
+    {
+        // Clock stepped back, and a timestamp shared with the older file
+        std::ofstream out(newer);
+        out << "2019-05-01T10:00:05+00:00 OpenBMC.0.1.D,4\n"
+               "2019-05-01T10:00:00+00:00 OpenBMC.0.1.E,5\n"
+               "2019-05-01T10:00:00+00:00 OpenBMC.0.1.F,6\n";
+    }
+    EventLogIndex &index = EventLogIndex::getInstance();
+    index.update({older, newer});
+
+    std::vector<std::string> ids;
+    std::vector<std::string> lines = readAll(index, 0, 10, &ids);
+    ASSERT_EQ(lines.size(), 6);
+    std::string entry;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        // The oldest entry wins when IDs collide across files
+        size_t expected = i == 4 ? 0 : i == 5 ? 1 : i;
+        ASSERT_TRUE(index.findEntry(ids[i], entry)) << ids[i];
+        EXPECT_EQ(entry, lines[expected]) << ids[i];
+    }
+    uint64_t timestamp = 0;
+    uint32_t entryIndex = 0;
+    ASSERT_TRUE(parseEntryID(ids[0], timestamp, entryIndex));
+    EXPECT_FALSE(index.findEntry(makeEntryID(timestamp, 2), entry));
+    EXPECT_FALSE(index.findEntry(makeEntryID(timestamp + 2, 0), entry));
+}
+
+TEST_F(EventLogIndexTest, FindsEntriesAppendedAfterClockChange)
+{
+    std::filesystem::path logFile = dir / "redfish";
+    auto append = [&logFile](const std::string &lines) {
+        std::ofstream out(logFile, std::ios::app);
+        out << lines;
+    };
+    EventLogIndex &index = EventLogIndex::getInstance();
+    append("2019-05-01T10:00:05+00:00 OpenBMC.0.1.A,1\n");
+    index.update({logFile});
+    append("2019-05-01T10:00:00+00:00 OpenBMC.0.1.B,2\n"
+           "2019-05-01T10:00:05+00:00 OpenBMC.0.1.C,3\n");
+    index.update({logFile});
+    append("2019-05-01T10:00:02+00:00 OpenBMC.0.1.D,4\n");
+    index.update({logFile});
+
+    std::vector<std::string> ids;
+    std::vector<std::string> lines = readAll(index, 0, 10, &ids);
+    ASSERT_EQ(lines.size(), 4);
+    std::string entry;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        // C has the same ID as A, which is found first
+        size_t expected = i == 2 ? 0 : i;
+        ASSERT_TRUE(index.findEntry(ids[i], entry)) << ids[i];
+        EXPECT_EQ(entry, lines[expected]) << ids[i];
+    }
+}
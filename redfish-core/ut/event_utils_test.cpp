@@ -0,0 +1,77 @@
+#include "utils/event_utils.hpp"
+
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::event_util;
+
+TEST(EventQueue, CoalescesQueuedRecords)
+{
+    EventQueue queue(8);
+    EXPECT_TRUE(queue.push("sensor/Value", {{"Value", 1}}));
+    EXPECT_TRUE(queue.push("", {{"Alert", 1}}));
+    EXPECT_TRUE(queue.push("sensor/Value", {{"Value", 2}}));
+    EXPECT_EQ(queue.size(), 2);
+    EXPECT_EQ(queue.coalesced(), 1);
+
+    // The replaced record keeps its place
+    std::vector<nlohmann::json> records = queue.take(8);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0]["Value"], 2);
+    EXPECT_EQ(records[1]["Alert"], 1);
+    EXPECT_TRUE(queue.empty());
+
+    // Once taken, the key no longer coalesces
+    EXPECT_TRUE(queue.push("sensor/Value", {{"Value", 3}}));
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(EventQueue, DropsOldestWhenFull)
+{
+    EventQueue queue(2);
+    EXPECT_TRUE(queue.push("a", {{"Id", 1}}));
+    EXPECT_TRUE(queue.push("", {{"Id", 2}}));
+    EXPECT_FALSE(queue.push("", {{"Id", 3}}));
+    EXPECT_EQ(queue.dropped(), 1);
+
+    // The dropped record's key is forgotten
+    EXPECT_FALSE(queue.push("a", {{"Id", 4}}));
+    EXPECT_EQ(queue.coalesced(), 0);
+
+    std::vector<nlohmann::json> records = queue.take(1);
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0]["Id"], 3);
+    records = queue.take(10);
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0]["Id"], 4);
+}
+
+TEST(EventUtils, ParseDestination)
+{
+    std::string host;
+    std::string port;
+    std::string target;
+    EXPECT_TRUE(parseDestination("http://collector:8080/events?bmc=1", host,
+                                 port, target));
+    EXPECT_EQ(host, "collector");
+    EXPECT_EQ(port, "8080");
+    EXPECT_EQ(target, "/events?bmc=1");
+
+    EXPECT_TRUE(parseDestination("http://10.0.0.1", host, port, target));
+    EXPECT_EQ(host, "10.0.0.1");
+    EXPECT_EQ(port, "80");
+    EXPECT_EQ(target, "/");
+
+    EXPECT_TRUE(parseDestination("http://[fe80::1]:81/x", host, port, target));
+    EXPECT_EQ(host, "fe80::1");
+    EXPECT_EQ(port, "81");
+    EXPECT_EQ(target, "/x");
+
+    EXPECT_FALSE(parseDestination("https://collector/", host, port, target));
+    EXPECT_FALSE(parseDestination("http://", host, port, target));
+    EXPECT_FALSE(parseDestination("http://host:/", host, port, target));
+    EXPECT_FALSE(parseDestination("http://host:99999/", host, port, target));
+    EXPECT_FALSE(parseDestination("http://user@host/", host, port, target));
+    EXPECT_FALSE(parseDestination("http://[fe80::1/", host, port, target));
+}
@@ -0,0 +1,141 @@
+#include "utils/health_utils.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::health_util;
+
+namespace
+{
+
+const std::string inventoryRoot = "/xyz/openbmc_project/inventory/system";
+
+// A chassis with boards, each with a few items, and sensors whose status
+// associations point at the items
+StatusAssociations makeStatuses(std::mt19937 &gen, int boards, int items)
+{
+    StatusAssociations statuses;
+    std::uniform_int_distribution<int> pick(0, 9);
+    for (int board = 0; board < boards; board++)
+    {
+        std::string boardPath =
+            inventoryRoot + "/chassis/board" + std::to_string(board);
+        for (int item = 0; item < items; item++)
+        {
+            std::string itemPath = boardPath + "/item" + std::to_string(item);
+            int roll = pick(gen);
+            if (roll == 0)
+            {
+                statuses.push_back({itemPath + "/critical", {}});
+            }
+            else if (roll == 1)
+            {
+                statuses.push_back({itemPath + "/warning", {}});
+            }
+            else if (roll == 2)
+            {
+                statuses.push_back(
+                    {"/xyz/openbmc_project/sensors/temperature/t" +
+                         std::to_string(board) + "_" + std::to_string(item) +
+                         "/warning",
+                     {itemPath}});
+            }
+            else if (roll == 3)
+            {
+                statuses.push_back(
+                    {"/xyz/openbmc_project/sensors/voltage/v" +
+                         std::to_string(board) + "_" + std::to_string(item) +
+                         "/critical",
+                     {itemPath, boardPath}});
+            }
+        }
+    }
+    return statuses;
+}
+
+HealthIndex makeIndex(const StatusAssociations &statuses,
+                      const std::string &globalPath)
+{
+    HealthIndex index;
+    for (const auto &status : statuses)
+    {
+        index.set(status.first, std::vector<std::string>(status.second));
+    }
+    index.setGlobalInventoryPath(std::string(globalPath));
+    return index;
+}
+
+} // namespace
+
+TEST(HealthIndex, MatchesScan)
+{
+    std::mt19937 gen(42);
+    for (int round = 0; round < 50; round++)
+    {
+        StatusAssociations statuses = makeStatuses(gen, 4, 8);
+        std::string globalPath =
+            round % 2 == 0 ? inventoryRoot + "/chassis/board1" : "-";
+        HealthIndex index = makeIndex(statuses, globalPath);
+
+        std::uniform_int_distribution<int> pick(0, 7);
+        std::vector<std::vector<std::string>> inventories = {
+            {},
+            {inventoryRoot + "/chassis/board" + std::to_string(pick(gen) % 4)},
+            {inventoryRoot + "/chassis/board0/item" + std::to_string(pick(gen)),
+             inventoryRoot + "/chassis/board2/item" +
+                 std::to_string(pick(gen))}};
+        for (const auto &inventory : inventories)
+        {
+            for (bool all : {false, true})
+            {
+                Health scanHealth;
+                Health scanRollup;
+                getHealthByScan(statuses, inventory, all, globalPath,
+                                scanHealth, scanRollup);
+                Health health;
+                Health rollup;
+                index.getHealth(inventory, all, health, rollup);
+                EXPECT_EQ(health, scanHealth);
+                EXPECT_EQ(rollup, scanRollup);
+            }
+        }
+    }
+}
+
+TEST(HealthIndex, FollowsUpdates)
+{
+    std::string item = inventoryRoot + "/chassis/cpu0";
+    std::string sensorStatus =
+        "/xyz/openbmc_project/sensors/temperature/cpu0/critical";
+    HealthIndex index;
+    index.setGlobalInventoryPath(std::string(item));
+
+    Health health;
+    Health rollup;
+    index.getHealth({item}, false, health, rollup);
+    EXPECT_EQ(health, Health::ok);
+    EXPECT_EQ(rollup, Health::ok);
+
+    index.set(item + "/warning", {});
+    index.set(sensorStatus, {item});
+    // Only status associations are kept
+    index.set(item + "/chassis", {inventoryRoot});
+    EXPECT_EQ(index.size(), 2);
+    index.getHealth({item}, false, health, rollup);
+    EXPECT_EQ(health, Health::warning);
+    EXPECT_EQ(rollup, Health::critical);
+
+    // The sensor no longer points at the item
+    index.set(sensorStatus, {inventoryRoot + "/chassis/cpu1"});
+    index.getHealth({item}, false, health, rollup);
+    EXPECT_EQ(rollup, Health::warning);
+
+    index.remove(item + "/warning");
+    index.getHealth({item}, false, health, rollup);
+    EXPECT_EQ(health, Health::ok);
+    EXPECT_EQ(rollup, Health::ok);
+    EXPECT_STREQ(toString(Health::critical), "Critical");
+}
@@ -125,3 +125,29 @@ TEST(PrivilegeTest, GetActivePrivilegeNames)
                     ::testing::Pointee(expectedPrivileges[3]),
                     ::testing::Pointee(expectedPrivileges[4])));
 }
+
+TEST(PrivilegeTest, GetRoleId)
+{
+    EXPECT_EQ(getRoleId("priv-admin"), RoleId::admin);
+    EXPECT_EQ(getRoleId("priv-operator"), RoleId::op);
+    EXPECT_EQ(getRoleId("priv-user"), RoleId::readOnly);
+    EXPECT_EQ(getRoleId(""), RoleId::readOnly);
+}
+
+TEST(PrivilegeTest, GetAllowedRoles)
+{
+    std::bitset<roleIdCount> anyone = getAllowedRoles({});
+    EXPECT_TRUE(anyone.all());
+
+    std::bitset<roleIdCount> login = getAllowedRoles({{"Login"}});
+    EXPECT_FALSE(login.test(static_cast<size_t>(RoleId::none)));
+    EXPECT_TRUE(login.test(static_cast<size_t>(RoleId::readOnly)));
+    EXPECT_TRUE(login.test(static_cast<size_t>(RoleId::op)));
+    EXPECT_TRUE(login.test(static_cast<size_t>(RoleId::admin)));
+
+    std::bitset<roleIdCount> manager =
+        getAllowedRoles({{"ConfigureManager"}, {"ConfigureUsers"}});
+    EXPECT_FALSE(manager.test(static_cast<size_t>(RoleId::readOnly)));
+    EXPECT_FALSE(manager.test(static_cast<size_t>(RoleId::op)));
+    EXPECT_TRUE(manager.test(static_cast<size_t>(RoleId::admin)));
+}
@@ -0,0 +1,79 @@
+#include "registries.hpp"
+#include "registries/openbmc_message_registry.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::message_registries;
+
+// Compares rendering a synthetic 100k entry SEL against the previous search
+// and replace per MessageArg
+TEST(RegistriesTest, Benchmark)
+{
+    constexpr size_t entryCount = 100000;
+    std::vector<std::pair<const MessageEntry*, std::vector<std::string>>>
+        entries;
+    entries.reserve(entryCount);
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        const MessageEntry& entry =
+            openbmc::registry[i % openbmc::registry.size()];
+        std::vector<std::string> args;
+        for (int arg = 0; arg < entry.second.numberOfArgs; arg++)
+        {
+            args.emplace_back("Arg" + std::to_string(i));
+        }
+        entries.emplace_back(&entry, std::move(args));
+    }
+
+    auto timeIt = [](const char* name, auto&& func) {
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = func();
+        std::cout << name << ": "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count()
+                  << "us (" << bytes << " bytes)\n";
+        return bytes;
+    };
+
+    size_t replaced = timeIt("find and replace", [&]() {
+        size_t bytes = 0;
+        for (const auto& [entry, args] : entries)
+        {
+            std::string msg = entry->second.message;
+            int i = 0;
+            for (const std::string& messageArg : args)
+            {
+                std::string argStr = "%" + std::to_string(++i);
+                size_t argPos = msg.find(argStr);
+                if (argPos != std::string::npos)
+                {
+                    msg.replace(argPos, argStr.length(), messageArg);
+                }
+            }
+            bytes += msg.size();
+        }
+        return bytes;
+    });
+
+    size_t rendered = timeIt("message templates", [&]() {
+        size_t bytes = 0;
+        for (const auto& [entry, args] : entries)
+        {
+            const MessageTemplate* messageTemplate =
+                getMessageTemplateFromRegistry(entry->first, openbmc::registry,
+                                               openbmc::registryIndex);
+            std::string msg;
+            appendMessage(msg, *messageTemplate, args);
+            bytes += msg.size();
+        }
+        return bytes;
+    });
+    EXPECT_EQ(rendered, replaced);
+}
@@ -0,0 +1,91 @@
+#include "registries.hpp"
+#include "registries/base_message_registry.hpp"
+#include "registries/openbmc_message_registry.hpp"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::message_registries;
+
+static_assert(getMessageFromRegistry("Success", base::registry,
+                                     base::registryIndex) != nullptr,
+              "Registry index must be usable at compile time");
+
+TEST(RegistriesTest, IndexFindsEveryMessage)
+{
+    for (const MessageEntry& entry : base::registry)
+    {
+        EXPECT_EQ(getMessageFromRegistry(entry.first, base::registry,
+                                         base::registryIndex),
+                  &entry.second)
+            << entry.first;
+    }
+    for (const MessageEntry& entry : openbmc::registry)
+    {
+        EXPECT_EQ(getMessageFromRegistry(entry.first, openbmc::registry,
+                                         openbmc::registryIndex),
+                  &entry.second)
+            << entry.first;
+    }
+}
+
+TEST(RegistriesTest, IndexRejectsUnknownMessages)
+{
+    EXPECT_EQ(getMessageFromRegistry("", base::registry, base::registryIndex),
+              nullptr);
+    EXPECT_EQ(getMessageFromRegistry("NotAMessage", openbmc::registry,
+                                     openbmc::registryIndex),
+              nullptr);
+    // Prefix of a real key
+    EXPECT_EQ(getMessageFromRegistry("Succes", base::registry,
+                                     base::registryIndex),
+              nullptr);
+}
+
+TEST(RegistriesTest, MessageTemplateFillsArgs)
+{
+    const MessageTemplate* messageTemplate = getMessageTemplateFromRegistry(
+        "PropertyValueTypeError", base::registry, base::registryIndex);
+    ASSERT_NE(messageTemplate, nullptr);
+
+    std::string msg;
+    appendMessage(msg, *messageTemplate,
+                  std::vector<std::string>{"\"abc\"", "Speed"});
+    EXPECT_EQ(msg, "The value \"abc\" for the property Speed is of a "
+                   "different type than the property can accept.");
+
+    // Missing args leave their placeholder in place
+    msg.clear();
+    appendMessage(msg, *messageTemplate, std::vector<std::string>{"1"});
+    EXPECT_EQ(msg, "The value 1 for the property %2 is of a different type "
+                   "than the property can accept.");
+}
+
+TEST(RegistriesTest, MessageTemplateMatchesSubstitution)
+{
+    const std::vector<std::string> args = {"arg1", "arg2", "arg3", "arg4",
+                                           "arg5"};
+    for (const MessageEntry& entry : openbmc::registry)
+    {
+        std::string expected = entry.second.message;
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            std::string argStr = "%" + std::to_string(i + 1);
+            size_t argPos = expected.find(argStr);
+            if (argPos != std::string::npos)
+            {
+                expected.replace(argPos, argStr.length(), args[i]);
+            }
+        }
+
+        std::string msg;
+        appendMessage(msg,
+                      *getMessageTemplateFromRegistry(
+                          entry.first, openbmc::registry,
+                          openbmc::registryIndex),
+                      args);
+        EXPECT_EQ(msg, expected) << entry.first;
+    }
+}
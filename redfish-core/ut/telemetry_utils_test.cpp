@@ -0,0 +1,124 @@
+#include "utils/telemetry_utils.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace redfish::telemetry_util;
+
+namespace
+{
+constexpr std::array<TierConfig, 3> testTiers = {{{1, 4}, {2, 2}, {4, 2}}};
+} // namespace
+
+TEST(MetricStore, EnforcesMemoryBudget)
+{
+    MetricStore unlimited(1024 * 1024, testTiers);
+    size_t bytes = unlimited.bytesPerMetric();
+
+    MetricStore store(bytes * 2 + 1, testTiers);
+    EXPECT_EQ(store.addMetric(), 0);
+    EXPECT_EQ(store.addMetric(), 1);
+    EXPECT_EQ(store.addMetric(), std::nullopt);
+    EXPECT_EQ(store.size(), 2);
+    EXPECT_LE(store.memoryUsed(), bytes * 2 + 1);
+}
+
+TEST(MetricStore, KeepsNewestRawSamples)
+{
+    MetricStore store(1024 * 1024, testTiers);
+    ASSERT_EQ(store.addMetric(), 0);
+    for (uint64_t t = 100; t < 106; t++)
+    {
+        store.sample(t, {static_cast<float>(t)});
+    }
+    ASSERT_EQ(store.sampleCount(0), 4);
+    for (size_t n = 0; n < 4; n++)
+    {
+        EXPECT_EQ(store.timestamp(0, n), 102 + n);
+        EXPECT_EQ(store.get(0, 0, n).avg, 102 + n);
+    }
+}
+
+TEST(MetricStore, DownsamplesMinMaxAvg)
+{
+    MetricStore store(1024 * 1024, testTiers);
+    ASSERT_EQ(store.addMetric(), 0);
+    ASSERT_EQ(store.addMetric(), 1);
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    store.sample(100, {1.0f, nan});
+    store.sample(101, {3.0f, nan});
+    store.sample(102, {5.0f, 7.0f});
+    store.sample(103, {2.0f});
+    // Closes the buckets starting at 102 and 100
+    store.sample(104, {0.0f, 0.0f});
+
+    ASSERT_EQ(store.sampleCount(1), 2);
+    EXPECT_EQ(store.timestamp(1, 0), 100);
+    MetricSample sample = store.get(0, 1, 0);
+    EXPECT_EQ(sample.min, 1.0f);
+    EXPECT_EQ(sample.max, 3.0f);
+    EXPECT_EQ(sample.avg, 2.0f);
+    // Nothing was read in that interval
+    EXPECT_TRUE(std::isnan(store.get(1, 1, 0).avg));
+    // Missing readings don't count towards the average
+    EXPECT_EQ(store.get(1, 1, 1).avg, 7.0f);
+
+    ASSERT_EQ(store.sampleCount(2), 1);
+    sample = store.get(0, 2, 0);
+    EXPECT_EQ(sample.min, 1.0f);
+    EXPECT_EQ(sample.max, 5.0f);
+    EXPECT_EQ(sample.avg, 2.75f);
+
+    // A metric added later starts out empty
+    ASSERT_EQ(store.addMetric(), 2);
+    EXPECT_TRUE(std::isnan(store.get(2, 0, 3).avg));
+}
+
+TEST(SensorTable, ReportsChangesSinceSequence)
+{
+    SensorTable table(1000);
+    EXPECT_EQ(table.set("temperature/a", 20.0f), 0);
+    EXPECT_EQ(table.set("temperature/b", 30.0f), 1);
+    EXPECT_EQ(table.sequence(), 1002);
+
+    auto changesSince = [&table](uint64_t since) {
+        std::vector<std::pair<std::string, float>> changes;
+        table.forEachChangeSince(since, [&](const std::string& path,
+                                            float value) {
+            changes.emplace_back(path, value);
+        });
+        return changes;
+    };
+    EXPECT_EQ(changesSince(0).size(), 2);
+
+    uint64_t seen = table.sequence();
+    // Unchanged readings don't count
+    EXPECT_EQ(table.set("temperature/a", 20.0f), 0);
+    EXPECT_EQ(table.sequence(), seen);
+    EXPECT_TRUE(changesSince(seen).empty());
+
+    table.set("temperature/a", 21.0f);
+    table.set("temperature/b", 31.0f);
+    table.set("temperature/a", 22.0f);
+    auto changes = changesSince(seen);
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].first, "temperature/b");
+    EXPECT_EQ(changes[1].first, "temperature/a");
+    EXPECT_EQ(changes[1].second, 22.0f);
+
+    EXPECT_EQ(table.find("temperature/b"), 1);
+    EXPECT_EQ(table.find("temperature/c"), std::nullopt);
+    EXPECT_EQ(table.getValues()[0], 22.0f);
+}
+
+TEST(SensorTable, KnowsOnlyItsOwnSequences)
+{
+    SensorTable table(1000);
+    table.set("temperature/a", 20.0f);
+    EXPECT_TRUE(table.isKnownSequence(1000));
+    EXPECT_TRUE(table.isKnownSequence(1001));
+    EXPECT_FALSE(table.isKnownSequence(999));
+    EXPECT_FALSE(table.isKnownSequence(1002));
+}
@@ -77,7 +77,7 @@ for file, json, namespace in files:
         registry.write("};")
 
         # Parse each Message entry
-        registry.write("const std::array registry = {")
+        registry.write("constexpr std::array registry = {")
         for messageId, message in sorted(json["Messages"].items()):
             registry.write("MessageEntry{")
             registry.write("\"{}\",".format(messageId))
@@ -94,5 +94,9 @@ for file, json, namespace in files:
             registry.write("},")
             registry.write(".resolution = \"{}\",".format(message["Resolution"]))
             registry.write("}},")
-        registry.write("};}\n")
+        registry.write("};")
+
+        # Compile time hash index over the MessageKeys
+        registry.write("constexpr RegistryIndex<registry.size()> registryIndex = makeRegistryIndex(registry);")
+        registry.write("}\n")
     subprocess.check_call(["clang-format", "-i", file])
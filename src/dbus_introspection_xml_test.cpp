@@ -0,0 +1,109 @@
+#include "dbus_introspection_xml.hpp"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace dbus::introspection;
+
+namespace
+{
+
+const std::string sensorXml = R"(<!DOCTYPE node PUBLIC
+"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN"
+"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd">
+<node>
+  <interface name="org.freedesktop.DBus.Properties">
+    <method name="Get">
+      <arg name="interface" direction="in" type="s"/>
+      <arg name="property" direction="in" type="s"/>
+      <arg name="value" direction="out" type="v"/>
+    </method>
+    <method name="GetAll">
+      <arg name="interface" direction="in" type="s"/>
+      <arg name="properties" direction="out" type="a{sv}"/>
+      <arg name="extra" direction="out" type="u"/>
+    </method>
+    <method name="">
+      <arg name="ignored" direction="in" type="s"/>
+    </method>
+    <signal name="PropertiesChanged">
+      <arg name="interface" type="s"/>
+      <arg name="changed_properties" type="a{sv}"/>
+      <arg type="as"/>
+    </signal>
+  </interface>
+  <interface name="xyz.openbmc_project.Sensor.Value">
+    <property name="Value" type="d" access="read"/>
+    <property name="Unit" type="s" access="read"/>
+    <property name="Untyped" access="read"/>
+  </interface>
+  <interface>
+    <method name="Nameless"/>
+  </interface>
+  <node name="cpu0"/>
+  <node name="cpu1"/>
+  <node/>
+</node>
+)";
+
+} // namespace
+
+TEST(DbusIntrospectionXml, ParsesInterfaces)
+{
+    std::shared_ptr<Node> node = parse(sensorXml);
+    ASSERT_NE(node, nullptr);
+    ASSERT_EQ(node->interfaces.size(), 2);
+    EXPECT_THAT(node->children, ::testing::ElementsAre("cpu0", "cpu1"));
+
+    const Interface *properties =
+        node->findInterface("org.freedesktop.DBus.Properties");
+    ASSERT_NE(properties, nullptr);
+    ASSERT_EQ(properties->methods.size(), 2);
+
+    const Method &get = properties->methods[0];
+    EXPECT_EQ(get.name, "Get");
+    ASSERT_EQ(get.args.size(), 3);
+    EXPECT_EQ(get.args[2].name, "value");
+    EXPECT_EQ(get.args[2].direction, "out");
+    EXPECT_THAT(get.inTypes, ::testing::ElementsAre("s", "s"));
+    EXPECT_EQ(get.returnType, "v");
+
+    // Only the first out argument is the return type
+    EXPECT_EQ(properties->methods[1].returnType, "a{sv}");
+
+    ASSERT_EQ(properties->signals.size(), 1);
+    const Signal &changed = properties->signals[0];
+    EXPECT_EQ(changed.name, "PropertiesChanged");
+    ASSERT_EQ(changed.args.size(), 2);
+    EXPECT_EQ(changed.args[1].name, "changed_properties");
+    EXPECT_EQ(changed.args[1].type, "a{sv}");
+    EXPECT_TRUE(changed.args[1].direction.empty());
+
+    const Interface *value =
+        node->findInterface("xyz.openbmc_project.Sensor.Value");
+    ASSERT_NE(value, nullptr);
+    EXPECT_TRUE(value->methods.empty());
+    ASSERT_EQ(value->properties.size(), 2);
+    EXPECT_EQ(value->properties[0].name, "Value");
+    EXPECT_EQ(value->properties[0].type, "d");
+    EXPECT_EQ(value->properties[1].name, "Unit");
+
+    EXPECT_EQ(node->findInterface("xyz.openbmc_project.Missing"), nullptr);
+}
+
+TEST(DbusIntrospectionXml, ParsesEmptyNode)
+{
+    std::shared_ptr<Node> node = parse("<node></node>");
+    ASSERT_NE(node, nullptr);
+    EXPECT_TRUE(node->interfaces.empty());
+    EXPECT_TRUE(node->children.empty());
+}
+
+TEST(DbusIntrospectionXml, RejectsDocumentsWithoutNode)
+{
+    EXPECT_EQ(parse(""), nullptr);
+    EXPECT_EQ(parse("not xml"), nullptr);
+    EXPECT_EQ(parse("<interface name=\"a.b\"/>"), nullptr);
+}
@@ -0,0 +1,231 @@
+#include "dbus_monitor_batch.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace crow::dbus_monitor;
+
+namespace
+{
+
+class FakeConnection : public crow::websocket::Connection
+{
+  public:
+    FakeConnection(const crow::Request& req, boost::asio::io_context& ioc) :
+        Connection(req), ioc(ioc)
+    {
+    }
+
+    void sendBinary(const std::string_view msg) override
+    {
+        sent.emplace_back(msg);
+    }
+    void sendBinary(std::string&& msg) override
+    {
+        sent.emplace_back(std::move(msg));
+    }
+    void sendText(const std::string_view msg) override
+    {
+        sent.emplace_back(msg);
+    }
+    void sendText(std::string&& msg) override
+    {
+        sent.emplace_back(std::move(msg));
+    }
+    void close(const std::string_view msg) override
+    {
+    }
+    boost::asio::io_context& get_io_context() override
+    {
+        return ioc;
+    }
+    size_t bufferedAmount() const override
+    {
+        return buffered;
+    }
+    crow::websocket::TrafficStats trafficStats() const override
+    {
+        return {};
+    }
+
+    void drain()
+    {
+        buffered = 0;
+        if (drainHandler)
+        {
+            drainHandler(*this);
+        }
+    }
+
+    boost::asio::io_context& ioc;
+    std::vector<std::string> sent;
+    size_t buffered = 0;
+};
+
+class UpdateBatchTest : public ::testing::Test
+{
+  protected:
+    UpdateBatchTest() : req(beastReq), conn(req, ioc)
+    {
+    }
+
+    // Runs the batch timer
+    void runFor(std::chrono::milliseconds duration)
+    {
+        ioc.restart();
+        ioc.run_for(duration);
+    }
+
+    nlohmann::json sentBatch(size_t index)
+    {
+        EXPECT_LT(index, conn.sent.size());
+        if (index >= conn.sent.size())
+        {
+            return nullptr;
+        }
+        return nlohmann::json::parse(conn.sent[index]);
+    }
+
+    boost::asio::io_context ioc;
+    boost::beast::http::request<boost::beast::http::string_body> beastReq;
+    crow::Request req;
+    FakeConnection conn;
+    boost::container::flat_set<std::string> interfaces{"xyz.Sensor"};
+};
+
+DecodedSignal propertiesChanged(const std::string& path,
+                                const nlohmann::json& properties)
+{
+    DecodedSignal decoded;
+    decoded.message = {{"event", "PropertiesChanged"},
+                       {"path", path},
+                       {"interface", "xyz.Sensor"},
+                       {"properties", properties}};
+    return decoded;
+}
+
+DecodedSignal interfacesAdded(const std::string& path)
+{
+    DecodedSignal decoded;
+    decoded.message = {{"event", "InterfacesAdded"}, {"path", path}};
+    decoded.interfaces = {{"xyz.Sensor", {{"Value", 1}}},
+                          {"xyz.Other", {{"Name", "a"}}}};
+    decoded.interfacesAdded = true;
+    return decoded;
+}
+
+} // namespace
+
+TEST_F(UpdateBatchTest, MergesPropertyChanges)
+{
+    auto batch =
+        std::make_shared<UpdateBatch>(conn, std::chrono::milliseconds(5));
+    batch->add(propertiesChanged("/a", {{"Value", 1}}), interfaces);
+    batch->add(interfacesAdded("/c"), interfaces);
+    batch->add(propertiesChanged("/b", {{"Value", 7}}), interfaces);
+    batch->add(propertiesChanged("/a", {{"Value", 2}, {"Unit", "C"}}),
+               interfaces);
+    EXPECT_TRUE(conn.sent.empty());
+
+    runFor(std::chrono::milliseconds(100));
+    ASSERT_EQ(conn.sent.size(), 1);
+    nlohmann::json sent = sentBatch(0);
+    ASSERT_EQ(sent.size(), 3);
+    EXPECT_EQ(sent[0]["path"], "/a");
+    EXPECT_EQ(sent[0]["properties"],
+              nlohmann::json({{"Value", 2}, {"Unit", "C"}}));
+    // Only the watched interfaces
+    EXPECT_EQ(sent[1]["interfaces"],
+              nlohmann::json({{"xyz.Sensor", {{"Value", 1}}}}));
+    EXPECT_EQ(sent[2]["path"], "/b");
+
+    // The next update starts a new window
+    batch->add(propertiesChanged("/a", {{"Value", 3}}), interfaces);
+    runFor(std::chrono::milliseconds(100));
+    ASSERT_EQ(conn.sent.size(), 2);
+    EXPECT_EQ(sentBatch(1)[0]["properties"]["Value"], 3);
+}
+
+TEST_F(UpdateBatchTest, SendsFullBatchEarly)
+{
+    auto batch =
+        std::make_shared<UpdateBatch>(conn, std::chrono::milliseconds(5000));
+    for (size_t i = 0; i < maxBatchEvents; i++)
+    {
+        batch->add(propertiesChanged("/s" + std::to_string(i), {{"Value", 1}}),
+                   interfaces);
+    }
+    ASSERT_EQ(conn.sent.size(), 1);
+    EXPECT_EQ(sentBatch(0).size(), maxBatchEvents);
+}
+
+TEST_F(UpdateBatchTest, HoldsBatchWhileClientIsBehind)
+{
+    std::shared_ptr<UpdateBatch> session;
+    ASSERT_TRUE(setBatchInterval(conn, session, 5u));
+    conn.buffered = maxBatchBacklog + 1;
+
+    session->add(propertiesChanged("/a", {{"Value", 1}}), interfaces);
+    runFor(std::chrono::milliseconds(100));
+    EXPECT_TRUE(conn.sent.empty());
+
+    // Keeps merging, and drops what doesn't fit once it's full
+    for (size_t i = 1; i < maxBatchEvents + 2; i++)
+    {
+        session->add(
+            propertiesChanged("/s" + std::to_string(i), {{"Value", 1}}),
+            interfaces);
+    }
+    session->add(interfacesAdded("/c"), interfaces);
+    session->add(propertiesChanged("/a", {{"Value", 2}}), interfaces);
+    runFor(std::chrono::milliseconds(100));
+    EXPECT_TRUE(conn.sent.empty());
+    EXPECT_EQ(session->droppedCount(), 3);
+
+    conn.drain();
+    ASSERT_EQ(conn.sent.size(), 1);
+    nlohmann::json sent = sentBatch(0);
+    ASSERT_EQ(sent.size(), maxBatchEvents);
+    EXPECT_EQ(sent[0]["properties"]["Value"], 2);
+
+    // Nothing more to send
+    conn.drain();
+    EXPECT_EQ(conn.sent.size(), 1);
+}
+
+TEST_F(UpdateBatchTest, SetsBatchInterval)
+{
+    std::shared_ptr<UpdateBatch> batch;
+    for (const nlohmann::json& invalid :
+         {nlohmann::json("100"), nlohmann::json(-1), nlohmann::json(1.5),
+          nlohmann::json(maxBatchMs + 1), nlohmann::json(nullptr)})
+    {
+        EXPECT_FALSE(setBatchInterval(conn, batch, invalid)) << invalid;
+        EXPECT_EQ(batch, nullptr);
+    }
+
+    EXPECT_TRUE(setBatchInterval(conn, batch, 0u));
+    EXPECT_EQ(batch, nullptr);
+
+    ASSERT_TRUE(setBatchInterval(conn, batch, maxBatchMs));
+    ASSERT_NE(batch, nullptr);
+    UpdateBatch* first = batch.get();
+    ASSERT_TRUE(setBatchInterval(conn, batch, 5u));
+    EXPECT_EQ(batch.get(), first);
+    batch->add(propertiesChanged("/a", {{"Value", 1}}), interfaces);
+    runFor(std::chrono::milliseconds(100));
+    EXPECT_EQ(conn.sent.size(), 1);
+
+    // Turning batching off sends what's held, even to a slow client
+    conn.buffered = maxBatchBacklog + 1;
+    batch->add(propertiesChanged("/a", {{"Value", 2}}), interfaces);
+    EXPECT_TRUE(setBatchInterval(conn, batch, 0u));
+    EXPECT_EQ(batch, nullptr);
+    ASSERT_EQ(conn.sent.size(), 2);
+    EXPECT_EQ(sentBatch(1)[0]["properties"]["Value"], 2);
+}
@@ -0,0 +1,42 @@
+#include "dbus_names.hpp"
+
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace dbus::names;
+
+TEST(DbusNames, ValidatesPaths)
+{
+    for (const char *path :
+         {"/", "/xyz", "/xyz/openbmc_project/sensors", "/xyz/openbmc_project/",
+          "/a_b/C9/0"})
+    {
+        EXPECT_TRUE(isValidPath(path)) << path;
+    }
+    for (const char *path : {"", "xyz", "//", "/xyz//sensors", "/xyz.sensors",
+                             "/xyz/sens-ors", "/xyz'", "/x y", "/\xc3\xa9"})
+    {
+        EXPECT_FALSE(isValidPath(path)) << path;
+    }
+}
+
+TEST(DbusNames, ValidatesInterfaces)
+{
+    for (const char *interface :
+         {"org.freedesktop.DBus", "xyz.openbmc_project.Sensor.Value", "a.b",
+          "_a._9", "A1.b2"})
+    {
+        EXPECT_TRUE(isValidInterface(interface)) << interface;
+    }
+    for (const char *interface :
+         {"", "org", ".org.freedesktop", "org.freedesktop.", "org..freedesktop",
+          "org.9freedesktop", "1org.freedesktop", "org.free-desktop",
+          "org.freedesktop'", "org/freedesktop"})
+    {
+        EXPECT_FALSE(isValidInterface(interface)) << interface;
+    }
+    EXPECT_TRUE(isValidInterface("a." + std::string(maxNameLength - 2, 'b')));
+    EXPECT_FALSE(
+        isValidInterface("a." + std::string(maxNameLength - 1, 'b')));
+}
@@ -0,0 +1,114 @@
+#include "dbus_rest_batch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace crow::openbmc_mapper;
+
+TEST(DbusRestBatch, ParsesOperations)
+{
+    std::vector<BatchItem> items;
+    EXPECT_EQ(parseBatchRequest(R"({"data": [
+        {"method": "GET", "path": "/xyz/a"},
+        {"method": "GET", "path": "/xyz/a", "property": "Value"},
+        {"method": "PUT", "path": "/xyz/b", "property": "Target",
+         "data": {"x": 1}}]})",
+                                items),
+              "");
+    ASSERT_EQ(items.size(), 3);
+    EXPECT_FALSE(items[0].isSet);
+    EXPECT_EQ(items[0].objectPath, "/xyz/a");
+    EXPECT_TRUE(items[0].propertyName.empty());
+    EXPECT_EQ(items[1].propertyName, "Value");
+    EXPECT_TRUE(items[2].isSet);
+    EXPECT_EQ(items[2].propertyValue, nlohmann::json({{"x", 1}}));
+
+    EXPECT_EQ(parseBatchRequest(R"({"data": []})", items), "");
+    EXPECT_TRUE(items.empty());
+}
+
+TEST(DbusRestBatch, RejectsBadRequests)
+{
+    std::vector<BatchItem> items;
+    EXPECT_EQ(parseBatchRequest("{", items), noJsonDesc);
+    std::string notAList =
+        "Expected a list of at most 256 operations in data";
+    EXPECT_EQ(parseBatchRequest("{}", items), notAList);
+    EXPECT_EQ(parseBatchRequest(R"({"data": {}})", items), notAList);
+
+    std::string operation = R"({"method": "GET", "path": "/xyz/a"})";
+    std::string body = R"({"data": [)" + operation;
+    for (size_t i = 1; i < batchMaxOperations; i++)
+    {
+        body += "," + operation;
+    }
+    EXPECT_EQ(parseBatchRequest(body + "]}", items), "");
+    EXPECT_EQ(items.size(), batchMaxOperations);
+    EXPECT_EQ(parseBatchRequest(body + "," + operation + "]}", items),
+              notAList);
+
+    // The first invalid operation is reported by position
+    for (const char *invalid :
+         {R"("GET")", R"({"path": "/xyz/a"})", R"({"method": "GET"})",
+          R"({"method": "GET", "path": 1})",
+          R"({"method": "GET", "path": "/xyz/a", "property": 1})",
+          R"({"method": "PUT", "path": "/xyz/a", "data": 1})",
+          R"({"method": "PUT", "path": "/xyz/a", "property": "p"})",
+          R"({"method": "DELETE", "path": "/xyz/a"})"})
+    {
+        EXPECT_EQ(parseBatchRequest(R"({"data": [)" + operation + "," +
+                                        invalid + "]}",
+                                    items),
+                  "Invalid operation 1")
+            << invalid;
+        EXPECT_TRUE(items.empty());
+    }
+}
+
+TEST(DbusRestBatch, SetsNeedWritePrivileges)
+{
+    std::vector<BatchItem> items(2);
+    EXPECT_TRUE(isBatchAllowed(items, redfish::RoleId::readOnly));
+    EXPECT_TRUE(isBatchAllowed(items, redfish::RoleId::admin));
+
+    items[1].isSet = true;
+    EXPECT_FALSE(isBatchAllowed(items, redfish::RoleId::readOnly));
+    EXPECT_FALSE(isBatchAllowed(items, redfish::RoleId::op));
+    EXPECT_TRUE(isBatchAllowed(items, redfish::RoleId::admin));
+}
+
+TEST(DbusRestBatch, ReportsEachOperation)
+{
+    BatchItem getAll;
+    BatchItem get;
+    get.propertyName = "Value";
+    BatchItem set;
+    set.propertyName = "Value";
+    set.isSet = true;
+
+    EXPECT_EQ(makeBatchResult(getAll, nullptr, false, {{"Value", 1}}),
+              nlohmann::json({{"status", "ok"},
+                              {"message", "200 OK"},
+                              {"data", {{"Value", 1}}}}));
+    EXPECT_EQ(makeBatchResult(get, nullptr, true, 5)["data"], 5);
+
+    nlohmann::json missing = makeBatchResult(get, nullptr, false, nullptr);
+    EXPECT_EQ(missing["status"], "error");
+    EXPECT_EQ(missing["message"], notFoundMsg);
+    EXPECT_EQ(missing["data"]["description"], propNotFoundDesc);
+
+    EXPECT_EQ(makeBatchResult(set, nullptr, false, nullptr)["status"],
+              "error");
+
+    // An error or a completed set is kept as it is
+    nlohmann::json failed = makeBatchError(notFoundDesc, notFoundMsg);
+    EXPECT_EQ(makeBatchResult(getAll, nlohmann::json(failed), false,
+                              {{"Value", 1}}),
+              failed);
+    nlohmann::json done = {
+        {"status", "ok"}, {"message", "200 OK"}, {"data", nullptr}};
+    EXPECT_EQ(makeBatchResult(set, nlohmann::json(done), false, nullptr),
+              done);
+}
@@ -0,0 +1,130 @@
+#include "openbmc_dbus_rest.hpp"
+
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace crow::openbmc_mapper;
+
+// Compares compiling a signature with a cache hit
+TEST(DbusSignature, Benchmark)
+{
+    constexpr int iterations = 100000;
+    const std::string signature = "a{oa{sa{sv}}}";
+
+    auto start = std::chrono::steady_clock::now();
+    size_t count = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        count += dbus::signature::compile(signature)->size();
+    }
+    auto compiled = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        count += dbus::signature::getPlan(signature)->size();
+    }
+    auto cached = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(count, 2 * iterations);
+    std::cout << "compile: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     compiled - start)
+                         .count() /
+                     iterations
+              << "ns, cached: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     cached - compiled)
+                         .count() /
+                     iterations
+              << "ns\n";
+}
+
+// Writes and reads a GetManagedObjects style reply of 200 objects, each with
+// 4 interfaces of 8 properties
+TEST(DbusMarshal, Benchmark)
+{
+    constexpr int iterations = 50;
+    const std::string signature = "a{oa{sa{sv}}}";
+
+    nlohmann::json objects = nlohmann::json::object();
+    for (int object = 0; object < 200; object++)
+    {
+        nlohmann::json &interfaces =
+            objects["/xyz/openbmc_project/sensors/temperature/sensor" +
+                    std::to_string(object)];
+        for (int interface = 0; interface < 4; interface++)
+        {
+            nlohmann::json &properties =
+                interfaces["xyz.openbmc_project.Interface" +
+                           std::to_string(interface)];
+            for (int property = 0; property < 8; property++)
+            {
+                std::string name = "Property" + std::to_string(property);
+                if (property % 2 == 0)
+                {
+                    properties[name] = property * 1.5;
+                }
+                else
+                {
+                    properties[name] = "value";
+                }
+            }
+        }
+    }
+
+    // Messages can only be created on a bus that has been started, which
+    // doesn't need anything on the other end
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    sd_bus *bus = nullptr;
+    ASSERT_GE(sd_bus_new(&bus), 0);
+    ASSERT_GE(sd_bus_set_fd(bus, fds[0], fds[0]), 0);
+    ASSERT_GE(sd_bus_start(bus), 0);
+
+    sd_bus_message *m = nullptr;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        sd_bus_message_unref(m);
+        m = nullptr;
+        ASSERT_GE(sd_bus_message_new_method_call(bus, &m, "xyz.openbmc_project",
+                                                 "/", "xyz.openbmc_project",
+                                                 "Bench"),
+                  0);
+        ASSERT_GE(convertJsonToDbus(m, signature, objects), 0);
+    }
+    auto written = std::chrono::steady_clock::now();
+
+    ASSERT_GE(sd_bus_message_seal(m, 1, 0), 0);
+    sdbusplus::message::message msg(m);
+    nlohmann::json read;
+    auto readStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        ASSERT_GE(sd_bus_message_rewind(m, 1), 0);
+        read = nullptr;
+        ASSERT_GE(convertDBusToJSON(signature, msg, read), 0);
+    }
+    auto readEnd = std::chrono::steady_clock::now();
+    EXPECT_EQ(read, objects);
+
+    std::cout << "write: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     written - start)
+                         .count() /
+                     iterations
+              << "us, read: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     readEnd - readStart)
+                         .count() /
+                     iterations
+              << "us per message\n";
+
+    sd_bus_message_unref(m);
+    sd_bus_unref(bus);
+}
@@ -0,0 +1,77 @@
+#include "dbus_signature.hpp"
+
+#include "gmock/gmock.h"
+
+using namespace dbus::signature;
+
+TEST(DbusSignature, CompilesBasicTypes)
+{
+    std::shared_ptr<const Plan> plan = compile("sbiu");
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->size(), 4);
+    EXPECT_EQ((*plan)[0].code, 's');
+    EXPECT_EQ((*plan)[1].code, 'b');
+    EXPECT_EQ((*plan)[2].code, 'i');
+    EXPECT_EQ((*plan)[3].code, 'u');
+    EXPECT_TRUE((*plan)[0].contents.empty());
+
+    plan = compile("");
+    ASSERT_NE(plan, nullptr);
+    EXPECT_TRUE(plan->empty());
+}
+
+TEST(DbusSignature, CompilesContainers)
+{
+    std::shared_ptr<const Plan> plan = compile("a{oa{sa{sv}}}");
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->size(), 1);
+
+    const Type &objects = plan->front();
+    EXPECT_EQ(objects.code, arrayCode);
+    EXPECT_EQ(objects.contents, "{oa{sa{sv}}}");
+    ASSERT_TRUE(objects.isDict());
+    const Type &object = objects.children.front();
+    EXPECT_EQ(object.code, dictEntryCode);
+    EXPECT_EQ(object.contents, "oa{sa{sv}}");
+    ASSERT_EQ(object.children.size(), 2);
+    EXPECT_EQ(object.children[0].code, 'o');
+
+    const Type &interfaces = object.children[1];
+    EXPECT_EQ(interfaces.contents, "{sa{sv}}");
+    const Type &properties = interfaces.children.front().children[1];
+    EXPECT_EQ(properties.contents, "{sv}");
+    EXPECT_EQ(properties.children.front().children[1].code, variantCode);
+
+    plan = compile("a(sa(ii))s");
+    ASSERT_NE(plan, nullptr);
+    ASSERT_EQ(plan->size(), 2);
+    const Type &array = plan->front();
+    EXPECT_FALSE(array.isDict());
+    EXPECT_EQ(array.contents, "(sa(ii))");
+    const Type &member = array.children.front();
+    EXPECT_EQ(member.code, structCode);
+    EXPECT_EQ(member.contents, "sa(ii)");
+    ASSERT_EQ(member.children.size(), 2);
+    EXPECT_EQ(member.children[1].contents, "(ii)");
+    EXPECT_EQ(member.children[1].children.front().contents, "ii");
+    EXPECT_EQ((*plan)[1].code, 's');
+}
+
+TEST(DbusSignature, RejectsInvalidSignatures)
+{
+    for (const char *signature :
+         {"a", "(", "()", "(i", "i)", "{sv}", "a{s}", "a{sss}", "a{vs}",
+          "a{(i)s}", "a{sv", "z", "aaz"})
+    {
+        EXPECT_EQ(compile(signature), nullptr) << signature;
+    }
+    EXPECT_EQ(compile(std::string(maxDepth + 2, 'a') + "i"), nullptr);
+}
+
+TEST(DbusSignature, CachesPlans)
+{
+    std::shared_ptr<const Plan> plan = getPlan("a{sv}");
+    ASSERT_NE(plan, nullptr);
+    EXPECT_EQ(plan, getPlan("a{sv}"));
+    EXPECT_EQ(getPlan("a{"), nullptr);
+}
@@ -0,0 +1,85 @@
+#include "http_utility.hpp"
+
+#include "gmock/gmock.h"
+
+using namespace http_helpers;
+
+TEST(HttpUtility, ETagFollowsBody)
+{
+    std::string etag = makeETag("{\"Name\": \"Root Service\"}");
+    EXPECT_EQ(etag.size(), 18);
+    EXPECT_EQ(etag.front(), '"');
+    EXPECT_EQ(etag.back(), '"');
+    EXPECT_EQ(etag, makeETag("{\"Name\": \"Root Service\"}"));
+    EXPECT_NE(etag, makeETag("{\"Name\": \"Root Service \"}"));
+}
+
+TEST(HttpUtility, ETagMatches)
+{
+    std::string etag = makeETag("body");
+    EXPECT_TRUE(etagMatches(etag, etag));
+    EXPECT_TRUE(etagMatches("W/" + etag, etag));
+    EXPECT_TRUE(etagMatches("\"other\", " + etag + " ", etag));
+    EXPECT_TRUE(etagMatches("*", etag));
+
+    EXPECT_FALSE(etagMatches("", etag));
+    EXPECT_FALSE(etagMatches("\"other\"", etag));
+    EXPECT_FALSE(etagMatches(" , ,", etag));
+}
+
+TEST(HttpUtility, ETagMatchesStrongly)
+{
+    std::string etag = makeETag("body");
+    EXPECT_TRUE(etagMatches(etag, etag, ETagComparison::strong));
+    EXPECT_TRUE(etagMatches("W/\"other\", " + etag, etag,
+                            ETagComparison::strong));
+    EXPECT_TRUE(etagMatches("*", etag, ETagComparison::strong));
+
+    // A weak tag on either side never satisfies If-Match
+    EXPECT_FALSE(etagMatches("W/" + etag, etag, ETagComparison::strong));
+    EXPECT_FALSE(etagMatches(etag, "W/" + etag, ETagComparison::strong));
+    EXPECT_TRUE(etagMatches("*", "W/" + etag, ETagComparison::strong));
+}
+
+TEST(HttpUtility, ParsesRanges)
+{
+    ByteRange range;
+    ASSERT_EQ(parseRange("bytes=0-99", 1000, range), RangeResult::satisfiable);
+    EXPECT_EQ(range.first, 0);
+    EXPECT_EQ(range.last, 99);
+    EXPECT_EQ(range.size(), 100);
+
+    ASSERT_EQ(parseRange("bytes=900-", 1000, range), RangeResult::satisfiable);
+    EXPECT_EQ(range.first, 900);
+    EXPECT_EQ(range.last, 999);
+
+    ASSERT_EQ(parseRange("bytes=990-2000", 1000, range),
+              RangeResult::satisfiable);
+    EXPECT_EQ(range.last, 999);
+
+    ASSERT_EQ(parseRange("bytes=-10", 1000, range), RangeResult::satisfiable);
+    EXPECT_EQ(range.first, 990);
+    EXPECT_EQ(range.last, 999);
+
+    ASSERT_EQ(parseRange("bytes=-5000", 1000, range),
+              RangeResult::satisfiable);
+    EXPECT_EQ(range.first, 0);
+}
+
+TEST(HttpUtility, RejectsRanges)
+{
+    ByteRange range;
+    EXPECT_EQ(parseRange("bytes=1000-", 1000, range),
+              RangeResult::unsatisfiable);
+    EXPECT_EQ(parseRange("bytes=-0", 1000, range), RangeResult::unsatisfiable);
+    EXPECT_EQ(parseRange("bytes=0-", 0, range), RangeResult::unsatisfiable);
+
+    for (const char* header :
+         {"", "bytes", "items=0-1", "bytes=", "bytes=-", "bytes=a-1",
+          "bytes=1-a", "bytes=5-1", "bytes=0-1,5-6", "bytes= 0-1",
+          "bytes=99999999999999999999-"})
+    {
+        EXPECT_EQ(parseRange(header, 1000, range), RangeResult::none)
+            << header;
+    }
+}
@@ -0,0 +1,56 @@
+#include "random.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace crow::random;
+
+// Compares against the previous per character std::random_device approach
+TEST(TokenGenerator, Benchmark)
+{
+    constexpr int iterations = 10000;
+    // Session token, CSRF token and unique id, as generated per login
+    constexpr size_t charsPerLogin = 20 + 20 + 10;
+
+    auto start = std::chrono::steady_clock::now();
+    std::random_device rd;
+    std::uniform_int_distribution<size_t> dist(
+        0, TokenGenerator::alphanum.size() - 1);
+    size_t sink = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        std::string token;
+        token.resize(charsPerLogin, '0');
+        for (char& c : token)
+        {
+            c = TokenGenerator::alphanum[dist(rd)];
+        }
+        sink += static_cast<size_t>(token[0]);
+    }
+    auto randomDeviceTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        std::string token =
+            TokenGenerator::getInstance().generate(charsPerLogin);
+        sink += static_cast<size_t>(token[0]);
+    }
+    auto generatorTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "random_device: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     randomDeviceTime)
+                         .count() /
+                     iterations
+              << "us/login, TokenGenerator: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     generatorTime)
+                         .count() /
+                     iterations
+              << "ns/login (" << sink << ")\n";
+}
@@ -0,0 +1,85 @@
+#include "random.hpp"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+
+#include "gmock/gmock.h"
+
+using namespace crow::random;
+
+TEST(TokenGenerator, TokenIsAlphanumeric)
+{
+    std::string token = TokenGenerator::getInstance().generate(1000);
+    ASSERT_EQ(token.size(), 1000);
+    for (char c : token)
+    {
+        EXPECT_TRUE(std::isalnum(static_cast<unsigned char>(c)));
+    }
+}
+
+TEST(TokenGenerator, RejectsBiasedBytes)
+{
+    char c = 'X';
+    EXPECT_TRUE(TokenGenerator::byteToChar(0, c));
+    EXPECT_EQ(c, '0');
+    EXPECT_TRUE(TokenGenerator::byteToChar(61, c));
+    EXPECT_EQ(c, 'z');
+    EXPECT_TRUE(TokenGenerator::byteToChar(62, c));
+    EXPECT_EQ(c, '0');
+    EXPECT_TRUE(TokenGenerator::byteToChar(247, c));
+    EXPECT_EQ(c, 'z');
+
+    for (unsigned int byte = 248; byte < 256; byte++)
+    {
+        EXPECT_FALSE(
+            TokenGenerator::byteToChar(static_cast<uint8_t>(byte), c));
+    }
+}
+
+TEST(TokenGenerator, AcceptedBytesAreUniform)
+{
+    // Every character must be reachable from exactly the same number of byte
+    // values, or the distribution is biased regardless of the entropy source
+    std::array<int, TokenGenerator::alphanum.size()> counts{};
+    for (unsigned int byte = 0; byte < 256; byte++)
+    {
+        char c;
+        if (TokenGenerator::byteToChar(static_cast<uint8_t>(byte), c))
+        {
+            const char* pos = std::find(TokenGenerator::alphanum.begin(),
+                                        TokenGenerator::alphanum.end(), c);
+            ASSERT_NE(pos, TokenGenerator::alphanum.end());
+            counts[pos - TokenGenerator::alphanum.begin()]++;
+        }
+    }
+    EXPECT_THAT(counts, ::testing::Each(counts[0]));
+}
+
+TEST(TokenGenerator, ChiSquaredUniformity)
+{
+    constexpr size_t expectedPerBucket = 1000;
+    constexpr size_t bucketCount = TokenGenerator::alphanum.size();
+    std::string token = TokenGenerator::getInstance().generate(
+        expectedPerBucket * bucketCount);
+
+    std::array<size_t, 256> counts{};
+    for (char c : token)
+    {
+        counts[static_cast<unsigned char>(c)]++;
+    }
+
+    double chiSquared = 0.0;
+    for (char c : TokenGenerator::alphanum)
+    {
+        double diff =
+            static_cast<double>(counts[static_cast<unsigned char>(c)]) -
+            static_cast<double>(expectedPerBucket);
+        chiSquared += diff * diff / static_cast<double>(expectedPerBucket);
+    }
+
+    // 61 degrees of freedom.  The critical value for p = 1e-6 is about 128, so
+    // a uniform source fails this check roughly once in a million runs
+    EXPECT_LT(chiSquared, 128.0);
+}
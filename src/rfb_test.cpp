@@ -0,0 +1,264 @@
+#include "rfb.hpp"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using namespace rfb;
+
+namespace
+{
+
+std::string rect(uint16_t width, uint16_t height, int32_t type)
+{
+    std::string out;
+    appendU32(out, 0);
+    appendU16(out, width);
+    appendU16(out, height);
+    appendU32(out, static_cast<uint32_t>(type));
+    return out;
+}
+
+std::string update(uint16_t rects)
+{
+    std::string out("\0\0", 2);
+    appendU16(out, rects);
+    return out;
+}
+
+std::string pixelFormat(uint8_t bits, uint8_t depth)
+{
+    std::string out;
+    out += static_cast<char>(bits);
+    out += static_cast<char>(depth);
+    out += '\0';
+    // True colour, with 8 bits for each of red, green and blue
+    out += '\x01';
+    for (int i = 0; i < 3; i++)
+    {
+        appendU16(out, 255);
+    }
+    out += std::string("\x10\x08\0\0\0\0", 6);
+    return out;
+}
+
+// Feeds data in pieces of step bytes, returning the length of each message
+std::vector<size_t> frame(ServerFramer& framer, std::string_view data,
+                          size_t step)
+{
+    std::vector<size_t> lengths;
+    size_t length = 0;
+    while (!data.empty())
+    {
+        std::string_view piece = data.substr(0, step);
+        size_t n = framer.advance(piece);
+        EXPECT_FALSE(framer.failed());
+        if (framer.failed())
+        {
+            break;
+        }
+        length += n;
+        data.remove_prefix(n);
+        if (framer.atBoundary())
+        {
+            lengths.push_back(length);
+            length = 0;
+        }
+    }
+    return lengths;
+}
+
+} // namespace
+
+TEST(Rfb, FramesClientMessages)
+{
+    EXPECT_EQ(clientMessageLength(""), needMore);
+    EXPECT_EQ(clientMessageLength(std::string(1, client::setPixelFormat)),
+              20);
+    EXPECT_EQ(clientMessageLength(std::string(1, client::setEncodings)),
+              needMore);
+    EXPECT_EQ(clientMessageLength(std::string("\x02\0\0\x03", 4)), 16);
+    EXPECT_EQ(clientMessageLength(std::string(1, client::keyEvent)), 8);
+    EXPECT_EQ(clientMessageLength(std::string(1, client::pointerEvent)), 6);
+    EXPECT_EQ(clientMessageLength(std::string("\x06\0\0\0\0\0\x01\x00", 8)),
+              264);
+    EXPECT_EQ(clientMessageLength("\xfa"), invalidMessage);
+}
+
+TEST(Rfb, FiltersEncodings)
+{
+    std::string message("\x02\0", 2);
+    appendU16(message, 5);
+    for (int32_t type : {encoding::tight, encoding::hextile, 16,
+                         encoding::raw, encoding::desktopSize})
+    {
+        appendU32(message, static_cast<uint32_t>(type));
+    }
+    std::string expected("\x02\0", 2);
+    appendU16(expected, 4);
+    for (int32_t type : {encoding::tight, encoding::hextile, encoding::raw,
+                         encoding::desktopSize})
+    {
+        appendU32(expected, static_cast<uint32_t>(type));
+    }
+    EXPECT_EQ(filterEncodings(message), expected);
+}
+
+TEST(Rfb, FramesServerMessages)
+{
+    std::string stream;
+    std::vector<size_t> expected;
+
+    // Raw and CopyRect at 32 bits per pixel
+    std::string message =
+        update(2) + rect(3, 2, encoding::raw) + std::string(3 * 2 * 4, 'p') +
+        rect(4, 4, encoding::copyRect) + std::string(4, '\0');
+    expected.push_back(message.size());
+    stream += message;
+
+    stream += "\x02";
+    expected.push_back(1);
+
+    // RRE with two subrectangles
+    message = update(1) + rect(8, 8, encoding::rre);
+    appendU32(message, 2);
+    message += std::string(4 + 2 * (4 + 8), 'r');
+    expected.push_back(message.size());
+    stream += message;
+
+    // Hextile, 20x17 is four tiles: raw, a background only, two coloured
+    // subrectangles and a tile with nothing new
+    message = update(1) + rect(20, 17, encoding::hextile);
+    message += "\x01" + std::string(16 * 16 * 4, 't');
+    message += "\x02" + std::string(4, 'b');
+    message += "\x18\x02" + std::string(2 * (4 + 2), 's');
+    message += std::string(1, '\0');
+    expected.push_back(message.size());
+    stream += message;
+
+    // ServerCutText and SetColourMapEntries
+    message = std::string("\x03\0\0\0", 4);
+    appendU32(message, 5);
+    message += "hello";
+    expected.push_back(message.size());
+    stream += message;
+    message = std::string("\x01\0\0\0\0\x02", 6) + std::string(12, 'c');
+    expected.push_back(message.size());
+    stream += message;
+
+    // An update ended by LastRect, resizing the framebuffer on the way
+    message = update(0xffff) + rect(800, 600, encoding::desktopSize) +
+              rect(0, 0, encoding::lastRect);
+    expected.push_back(message.size());
+    stream += message;
+
+    for (size_t step : {size_t(1), size_t(7), size_t(64), stream.size()})
+    {
+        ServerFramer framer(1024, 768);
+        EXPECT_EQ(frame(framer, stream, step), expected) << step;
+        EXPECT_EQ(framer.width(), 800);
+        EXPECT_EQ(framer.height(), 600);
+    }
+}
+
+TEST(Rfb, FramesSmallPixels)
+{
+    ServerFramer framer(640, 480);
+    ASSERT_TRUE(framer.setPixelFormat(pixelFormat(16, 16)));
+    EXPECT_FALSE(framer.setPixelFormat(pixelFormat(24, 24)));
+    std::string message =
+        update(1) + rect(2, 2, encoding::raw) + std::string(8, 'p');
+    EXPECT_EQ(frame(framer, message + "\x02", 3),
+              (std::vector<size_t>{message.size(), 1}));
+}
+
+TEST(Rfb, FramesTight)
+{
+    std::string stream;
+    std::vector<size_t> expected;
+
+    // A fill and a JPEG with a two byte length, which keep no state.  The
+    // 24 bit pixels take 3 bytes
+    std::string message = update(2) + rect(64, 64, encoding::tight) +
+                          "\x80" + std::string(3, 'f') +
+                          rect(64, 64, encoding::tight) + "\x90\xc8\x01" +
+                          std::string(200, 'j');
+    expected.push_back(message.size());
+    stream += message;
+
+    // Basic compression of a 2x1 rectangle, too small to be compressed
+    message = update(1) + rect(2, 1, encoding::tight) + std::string(1, '\0') +
+              std::string(6, 'p');
+    expected.push_back(message.size());
+    stream += message;
+
+    // A two colour palette, leaving 2 bytes for each of 40 rows, compressed
+    // on stream 1
+    message = update(1) + rect(10, 40, encoding::tight) + "\x50\x01\x01" +
+              std::string(2 * 3, 'c') + "\x05" + std::string(5, 'z');
+    expected.push_back(message.size());
+    stream += message;
+
+    for (size_t step : {size_t(1), size_t(5), stream.size()})
+    {
+        ServerFramer framer(1024, 768);
+        ASSERT_TRUE(framer.setPixelFormat(pixelFormat(32, 24)));
+        EXPECT_EQ(frame(framer, stream, step), expected) << step;
+    }
+
+    ServerFramer framer(1024, 768);
+    ASSERT_TRUE(framer.setPixelFormat(pixelFormat(32, 24)));
+    size_t pos = framer.advance(stream);
+    EXPECT_FALSE(framer.keepsState());
+    pos += framer.advance(std::string_view(stream).substr(pos));
+    EXPECT_FALSE(framer.keepsState());
+    framer.advance(std::string_view(stream).substr(pos));
+    EXPECT_TRUE(framer.keepsState());
+
+    // Resetting the zlib streams keeps state too, and 32 bit pixels that
+    // aren't 24 bit true colour are sent whole
+    ServerFramer other(1024, 768);
+    ASSERT_TRUE(other.setPixelFormat(pixelFormat(32, 32)));
+    message = update(1) + rect(8, 8, encoding::tight) + "\x81" +
+              std::string(4, 'f');
+    EXPECT_EQ(other.advance(message), message.size());
+    EXPECT_TRUE(other.atBoundary());
+    EXPECT_TRUE(other.keepsState());
+}
+
+TEST(Rfb, RejectsUnframedData)
+{
+    ServerFramer framer(640, 480);
+    std::string message = update(1) + rect(2, 2, 16);
+    framer.advance(message);
+    EXPECT_TRUE(framer.failed());
+
+    ServerFramer other(640, 480);
+    other.advance("\x7f");
+    EXPECT_TRUE(other.failed());
+
+    // Tight PNG, which only some servers send
+    ServerFramer png(640, 480);
+    png.advance(update(1) + rect(2, 2, encoding::tight) + "\xa0");
+    EXPECT_TRUE(png.failed());
+}
+
+TEST(Rfb, BuildsMessages)
+{
+    std::string init = makeServerInit(1024, 768, std::string(16, 'f'), "bmc");
+    ASSERT_EQ(init.size(), serverInitLength + 3);
+    EXPECT_EQ(readU16(init, 0), 1024);
+    EXPECT_EQ(readU16(init, 2), 768);
+    EXPECT_EQ(readU32(init, 20), 3);
+    EXPECT_EQ(init.substr(serverInitLength), "bmc");
+
+    EXPECT_EQ(makeUpdateRequest(false, 800, 600),
+              std::string("\x03\0\0\0\0\0\x03\x20\x02\x58", 10));
+
+    std::string resize = makeDesktopSize(800, 600);
+    ServerFramer framer(1024, 768);
+    EXPECT_EQ(framer.advance(resize), resize.size());
+    EXPECT_TRUE(framer.atBoundary());
+    EXPECT_EQ(framer.width(), 800);
+}
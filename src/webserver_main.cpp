@@ -99,6 +99,15 @@ int main(int argc, char** argv)
         std::make_shared<sdbusplus::asio::connection>(*io);
     redfish::RedfishService redfish(app);
 
+    // Debug view of the Redfish response caches.  ConfigureManager is only
+    // held by administrators
+    BMCWEB_ROUTE(app, "/bmcweb/response_cache/")
+        .requires({"ConfigureManager"})
+        .methods("GET"_method)(
+            [&redfish](const crow::Request& req, crow::Response& res) {
+                redfish.getResponseCacheStats(res);
+            });
+
     // Keep the user role map hot in memory and
     // track the changes using match object
     crow::persistent_data::UserRoleMap::getInstance();